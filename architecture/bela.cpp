@@ -221,6 +221,7 @@ public:
             case kANALOG_6:
             case kANALOG_7:
                 *fZone = fMin + fRange * analogReadNI(context, 0, (int)fBelaPin);
+                GUI::markAllGuis(fZone);
                 break;
                 
             case kDIGITAL_0:
@@ -240,6 +241,7 @@ public:
             case kDIGITAL_14:
             case kDIGITAL_15:
                 *fZone = digitalRead(context, 0, ((int)fBelaPin - kDIGITAL_0)) == 0 ? fMin : fMin+fRange;
+                GUI::markAllGuis(fZone);
                 break;
                 
             case kANALOG_OUT_0:
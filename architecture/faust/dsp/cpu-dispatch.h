@@ -0,0 +1,43 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __cpu_dispatch__
+#define __cpu_dispatch__
+
+/*
+ Macros used by the code generated with the '-mt <isa list>' option: each ISA specific version
+ of 'compute' is compiled with a 'target' function attribute, and the 'compute' method checks
+ the running CPU features (CPUID) to call the most specific supported version.
+
+ With other compilers or architectures, only the default version is used.
+*/
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define FAUST_TARGET(isa) __attribute__((target(isa)))
+#define FAUST_CPU_SUPPORTS(isa) __builtin_cpu_supports(isa)
+#else
+#define FAUST_TARGET(isa)
+#define FAUST_CPU_SUPPORTS(isa) 0
+#endif
+
+#endif
@@ -25,15 +25,21 @@
 #define __dsp_bench__
 
 #include <limits.h>
+#include <math.h>
 #include <sys/time.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <string>
 #include <vector>
 #include <algorithm>
 #include <assert.h>
 #include <string.h>
 #include <pwd.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
 
 #include "faust/dsp/dsp.h"
 
@@ -57,6 +63,12 @@
 #define BENCH_SAMPLE_RATE 44100.0
 #define NV 4096     // number of vectors in BIG buffer (should exceed cache)
 
+#define BENCH_WARMUP_WINDOW     16      // warm-up is over when the median of two consecutive windows of
+#define BENCH_WARMUP_TOLERANCE  0.02    // BENCH_WARMUP_WINDOW measures differ by less than BENCH_WARMUP_TOLERANCE,
+#define BENCH_MAX_WARMUP        2048    // or after BENCH_MAX_WARMUP measures
+#define BENCH_HISTOGRAM_BUCKETS 10      // buckets of the buffer duration histogram, as a fraction of the real-time deadline
+#define BENCH_NOISY_MAD         5.0     // a measure is considered noisy above this MAD (in % of the median)
+
 template <typename VAL_TYPE>
 void FAUSTBENCH_LOG(VAL_TYPE val)
 {
@@ -68,6 +80,47 @@ void FAUSTBENCH_LOG(VAL_TYPE val)
     }
 }
 
+/*
+    If the FAUSTBENCH_JSON environment variable is set to "on", append one JSON object per line in Faustbench.json
+*/
+inline void FAUSTBENCH_JSON_LOG(const std::string& json)
+{
+    const char* log = getenv("FAUSTBENCH_JSON");
+    if (log && (strcasecmp(log, "on") == 0)) {
+        std::ofstream gFaustbenchLog;
+        gFaustbenchLog.open("Faustbench.json", std::ofstream::app);
+        gFaustbenchLog << json << std::endl;
+    }
+}
+
+/*
+    Statistics of a measure: throughputs are in Megabytes/seconds, durations in microseconds.
+*/
+struct bench_stats {
+    
+    int fCount;                 // number of measured buffers
+    int fWarmup;                // number of warm-up buffers (not measured)
+    
+    double fBest;               // mean of the 10 best values (as returned by 'getStats')
+    double fMedian;
+    double fP5;                 // 5th percentile: 95% of the buffers are faster
+    double fP95;
+    double fMAD;                // median absolute deviation of durations, in % of the median duration
+    double fCILow;              // 95% confidence interval of the median
+    double fCIHigh;
+    
+    double fMedianUsec;         // buffer durations
+    double fP99Usec;
+    double fP999Usec;
+    double fMaxUsec;
+    double fDeadlineUsec;       // real-time duration of a buffer
+    std::vector<int> fHistogram;// buffers per 1/BENCH_HISTOGRAM_BUCKETS of the deadline, the last bucket counts overruns
+    
+    bool fPinned;               // whether the thread could only run on a single core
+    std::vector<std::string> fWarnings;
+    
+};
+
 /*
     A class to do do timing measurements
 */
@@ -84,6 +137,17 @@ class time_bench {
         int fCount;
         int fSkip;
     
+        // Warm-up detection
+        bool fWarmingUp;
+        int fWarmup;
+        uint64 fWindowMedian;
+        std::vector<uint64> fWindow;
+    
+        // Machine sanity checks
+        int fCPU;
+        bool fPinned;
+        std::vector<std::string> fWarnings;
+    
         // These values are used to determine the number of clocks in a second
         uint64 fFirstRDTSC;
         uint64 fLastRDTSC;
@@ -166,6 +230,100 @@ class time_bench {
             while (a != b) { r += *a++; n++; }
             return (n > 0) ? r/n : 0;
         }
+    
+        /**
+         * The fCount last durations, sorted
+         */
+        std::vector<uint64> sortedDurations()
+        {
+            std::vector<uint64> V(fCount);
+            for (int i = 0; i < fCount; i++) {
+                V[i] = fStops[i] - fStarts[i];
+            }
+            sort(V.begin(), V.end());
+            return V;
+        }
+    
+        /**
+         * Value at a given rank (between 0 and 1) in sorted values
+         */
+        uint64 percentile(const std::vector<uint64>& V, double rank)
+        {
+            size_t index = size_t(rank * (V.size() - 1) + 0.5);
+            return V[std::min<size_t>(index, V.size() - 1)];
+        }
+    
+        /**
+         * Warm-up measures are not kept: they are compared by windows, until two consecutive medians are close enough
+         */
+        void warmupMeasure(uint64 duration)
+        {
+            fWarmup++;
+            fWindow.push_back(duration);
+            if (fWindow.size() == BENCH_WARMUP_WINDOW) {
+                sort(fWindow.begin(), fWindow.end());
+                uint64 median = fWindow[BENCH_WARMUP_WINDOW / 2];
+                bool stable = (fWindowMedian > 0)
+                    && (fabs(double(median) - double(fWindowMedian)) <= BENCH_WARMUP_TOLERANCE * double(fWindowMedian));
+                fWindowMedian = median;
+                fWindow.clear();
+                if ((stable && fWarmup >= fSkip) || fWarmup >= BENCH_MAX_WARMUP) {
+                    // The measure really starts now
+                    fWarmingUp = false;
+                    fMeasure = 0;
+                    struct timezone tz;
+                    gettimeofday(&fTv1, &tz);
+                    fFirstRDTSC = rdtsc();
+                }
+            }
+        }
+    
+    #ifdef __linux__
+        static std::string readLine(const char* filename)
+        {
+            std::ifstream file(filename);
+            std::string line;
+            std::getline(file, line);
+            return line;
+        }
+    #endif
+    
+        /**
+         * Check the machine settings that make measures unstable
+         */
+        void checkMachine()
+        {
+            fWarnings.clear();
+            fCPU = -1;
+            fPinned = false;
+        #ifdef __linux__
+            std::string governor = readLine("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+            if (governor != "" && governor != "performance") {
+                fWarnings.push_back("CPU frequency governor is '" + governor + "', 'performance' gives more stable results");
+            }
+            if (readLine("/sys/devices/system/cpu/intel_pstate/no_turbo") == "0" || readLine("/sys/devices/system/cpu/cpufreq/boost") == "1") {
+                fWarnings.push_back("CPU turbo boost is enabled, frequency may change during the measure");
+            }
+        #if defined(__x86_64__) || defined(__i386__)
+            std::ifstream cpuinfo("/proc/cpuinfo");
+            std::string line;
+            while (std::getline(cpuinfo, line)) {
+                if (line.compare(0, 5, "flags") == 0) {
+                    if (line.find(" constant_tsc") == std::string::npos) {
+                        fWarnings.push_back("TSC is not constant, RDTSC clocks depend on the CPU frequency");
+                    }
+                    break;
+                }
+            }
+        #endif
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(cpu_set_t), &set) == 0) {
+                fPinned = (CPU_COUNT(&set) == 1);
+            }
+            fCPU = sched_getcpu();
+        #endif
+        }
   
     public:
     
@@ -178,6 +336,12 @@ class time_bench {
             fLastRDTSC = 0;
             fStarts = new uint64[fCount];
             fStops = new uint64[fCount];
+            fWarmingUp = false;
+            fWarmup = 0;
+            fWindowMedian = 0;
+            fWindow.reserve(BENCH_WARMUP_WINDOW);
+            fCPU = -1;
+            fPinned = false;
         #ifdef TARGET_OS_IPHONE
             mach_timebase_info(&fTimeInfo);
         #endif
@@ -191,14 +355,28 @@ class time_bench {
     
         void startMeasure() { fStarts[fMeasure % fCount] = rdtsc(); }
     
-        void stopMeasure() { fStops[fMeasure % fCount] = rdtsc(); fMeasure++; }
+        void stopMeasure()
+        {
+            uint64 stop = rdtsc();
+            if (fWarmingUp) {
+                warmupMeasure(stop - fStarts[fMeasure % fCount]);
+            } else {
+                fStops[fMeasure % fCount] = stop;
+                fMeasure++;
+            }
+        }
         
         void openMeasure()
         {
+            checkMachine();
             struct timezone tz;
             gettimeofday(&fTv1, &tz);
             fFirstRDTSC = rdtsc();
             fMeasure = 0;
+            fWarmingUp = true;
+            fWarmup = 0;
+            fWindowMedian = 0;
+            fWindow.clear();
         }
         
         void closeMeasure()
@@ -206,6 +384,12 @@ class time_bench {
             struct timezone tz;
             gettimeofday(&fTv2, &tz);
             fLastRDTSC = rdtsc();
+        #ifdef __linux__
+            // Only detected when the thread runs on another core at the end of the measure
+            if (fCPU >= 0 && sched_getcpu() != fCPU) {
+                fWarnings.push_back("thread migrated to another core during the measure");
+            }
+        #endif
         }
     
         double measureDurationUsec()
@@ -218,18 +402,76 @@ class time_bench {
          */
         double getStats(int bsize, int ichans, int ochans)
         {
-            assert(fMeasure > fCount);
-            std::vector<uint64> V(fCount);
+            assert(fMeasure >= fCount);
+            std::vector<uint64> V = sortedDurations();
             
+            // Mean of 10 best values (gives relatively stable results)
+            uint64 meavalx = meanValue(V.begin(), V.begin() + std::min<int>(10, fCount));
+            return megapersec(bsize, ichans + ochans, meavalx);
+        }
+    
+        /**
+         * Returns the complete statistics of the last measure.
+         */
+        bench_stats getAllStats(int bsize, int ichans, int ochans, double sample_rate)
+        {
+            assert(fMeasure >= fCount);
+            std::vector<uint64> V = sortedDurations();
+            int chans = ichans + ochans;
+            bench_stats stats;
+            
+            stats.fCount = fCount;
+            stats.fWarmup = fWarmup;
+            stats.fBest = getStats(bsize, ichans, ochans);
+            
+            // Throughput percentiles come from the opposite durations percentiles
+            uint64 median = percentile(V, 0.5);
+            stats.fMedian = megapersec(bsize, chans, median);
+            stats.fP5 = megapersec(bsize, chans, percentile(V, 0.95));
+            stats.fP95 = megapersec(bsize, chans, percentile(V, 0.05));
+            
+            std::vector<uint64> deviations(fCount);
             for (int i = 0; i < fCount; i++) {
-                V[i] = fStops[i] - fStarts[i];
+                deviations[i] = (V[i] > median) ? (V[i] - median) : (median - V[i]);
             }
+            sort(deviations.begin(), deviations.end());
+            stats.fMAD = 100. * double(percentile(deviations, 0.5)) / double(median);
             
-            sort(V.begin(), V.end());
+            // Distribution free confidence interval of the median, using the ranks n/2 -+ 1.96 * sqrt(n)/2
+            double delta = 1.96 * sqrt(double(fCount)) / 2.;
+            int low = std::max<int>(0, int(floor(fCount / 2. - delta)));
+            int high = std::min<int>(fCount - 1, int(ceil(fCount / 2. + delta)));
+            stats.fCILow = megapersec(bsize, chans, V[high]);
+            stats.fCIHigh = megapersec(bsize, chans, V[low]);
             
-            // Mean of 10 best values (gives relatively stable results)
-            uint64 meavalx = meanValue(V.begin(), V.begin() + 10);
-            return megapersec(bsize, ichans + ochans, meavalx);
+            stats.fMedianUsec = rdtsc2sec(median) * 1e6;
+            stats.fP99Usec = rdtsc2sec(percentile(V, 0.99)) * 1e6;
+            stats.fP999Usec = rdtsc2sec(percentile(V, 0.999)) * 1e6;
+            stats.fMaxUsec = rdtsc2sec(V.back()) * 1e6;
+            stats.fDeadlineUsec = double(bsize) * 1e6 / sample_rate;
+            
+            stats.fHistogram.assign(BENCH_HISTOGRAM_BUCKETS + 1, 0);
+            int overruns = 0;
+            for (int i = 0; i < fCount; i++) {
+                double ratio = rdtsc2sec(V[i]) * 1e6 / stats.fDeadlineUsec;
+                int bucket = std::min<int>(int(ratio * BENCH_HISTOGRAM_BUCKETS), BENCH_HISTOGRAM_BUCKETS);
+                stats.fHistogram[bucket]++;
+                if (ratio > 1.) overruns++;
+            }
+            
+            stats.fPinned = fPinned;
+            stats.fWarnings = fWarnings;
+            if (stats.fMAD > BENCH_NOISY_MAD) {
+                std::stringstream warning;
+                warning << "noisy measure, MAD is " << stats.fMAD << "% of the median";
+                stats.fWarnings.push_back(warning.str());
+            }
+            if (overruns > 0) {
+                std::stringstream warning;
+                warning << overruns << " buffer(s) exceeded the real-time deadline";
+                stats.fWarnings.push_back(warning.str());
+            }
+            return stats;
         }
 
         /**
@@ -237,14 +479,8 @@ class time_bench {
          */
         void printStats(const char* applname, int bsize, int ichans, int ochans)
         {
-            assert(fMeasure > fCount);
-            std::vector<uint64> V(fCount);
-            
-            for (int i = 0; i < fCount; i++) {
-                V[i] = fStops[i] - fStarts[i];
-            }
-            
-            sort(V.begin(), V.end());
+            assert(fMeasure >= fCount);
+            std::vector<uint64> V = sortedDurations();
             
             // Mean of 10 best values (gives relatively stable results)
             uint64 meaval00 = meanValue(V.begin(), V.begin()+ 5);
@@ -263,7 +499,9 @@ class time_bench {
             << std::endl;
         }
     
-        bool isRunning() { return (fMeasure <= (fCount + fSkip)); }
+        bool isRunning() { return fWarmingUp || (fMeasure < fCount); }
+    
+        int getWarmup() { return fWarmup; }
     
         int getCount()
         {
@@ -484,6 +722,61 @@ class measure_dsp : public decorator_dsp {
     
         bool isRunning() { return fBench->isRunning(); }
     
+        /**
+         *  Returns the complete statistics of the last measure (median, percentiles, MAD, confidence interval,
+         *  buffer durations histogram and machine warnings)
+         */
+        bench_stats getAllStats()
+        {
+            return fBench->getAllStats(fBufferSize, fDSP->getNumInputs(), fDSP->getNumOutputs(), BENCH_SAMPLE_RATE);
+        }
+    
+        /**
+         *  Returns the statistics of the last measure as a JSON object
+         */
+        std::string getJSON(const std::string& name = "")
+        {
+            bench_stats stats = getAllStats();
+            std::stringstream json;
+            json << "{ \"name\": \"" << escapeJSON(name) << "\""
+                 << ", \"buffer_size\": " << fBufferSize
+                 << ", \"count\": " << stats.fCount
+                 << ", \"warmup\": " << stats.fWarmup
+                 << ", \"mbytes_per_sec\": { \"best\": " << stats.fBest
+                 << ", \"median\": " << stats.fMedian
+                 << ", \"p5\": " << stats.fP5
+                 << ", \"p95\": " << stats.fP95
+                 << ", \"ci95\": [" << stats.fCILow << ", " << stats.fCIHigh << "] }"
+                 << ", \"mad_percent\": " << stats.fMAD
+                 << ", \"buffer_usec\": { \"median\": " << stats.fMedianUsec
+                 << ", \"p99\": " << stats.fP99Usec
+                 << ", \"p999\": " << stats.fP999Usec
+                 << ", \"max\": " << stats.fMaxUsec
+                 << ", \"deadline\": " << stats.fDeadlineUsec << " }"
+                 << ", \"histogram\": [";
+            for (size_t i = 0; i < stats.fHistogram.size(); i++) {
+                json << ((i > 0) ? ", " : "") << stats.fHistogram[i];
+            }
+            json << "], \"cpu_load\": " << getCPULoad()
+                 << ", \"pinned\": " << (stats.fPinned ? "true" : "false")
+                 << ", \"warnings\": [";
+            for (size_t i = 0; i < stats.fWarnings.size(); i++) {
+                json << ((i > 0) ? ", " : "") << "\"" << escapeJSON(stats.fWarnings[i]) << "\"";
+            }
+            json << "] }";
+            return json.str();
+        }
+    
+        static std::string escapeJSON(const std::string& str)
+        {
+            std::string res;
+            for (size_t i = 0; i < str.size(); i++) {
+                if (str[i] == '"' || str[i] == '\\') res += '\\';
+                res += str[i];
+            }
+            return res;
+        }
+    
         float getCPULoad()
         {
             return (fBench->measureDurationUsec() / 1000.0 * BENCH_SAMPLE_RATE) / (fBench->getCount() * fBufferSize * 1000.0);
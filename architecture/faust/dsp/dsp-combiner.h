@@ -28,10 +28,58 @@
 #include <string>
 #include <assert.h>
 #include <sstream>
+#include <algorithm>
+#include <vector>
 
 #include "faust/dsp/dsp.h"
 #include "faust/gui/UI.h"
 
+#define COMBINER_BUFFER_SIZE 4096
+
+/*
+ Intermediate buffers of a combiner tree.
+
+ Combiners are computed depth first, so the intermediate channels of a node are only live while
+ the node is computed, and the subtrees of a node are never computed at the same time: buffers are
+ allocated like a stack, a node using the channels following the ones of its parent, and its two subtrees
+ sharing the same channels. Channels are also reused in place: when the inputs and outputs of a sequencer
+ (or splitter, or merger) are intermediate channels, its outputs are not written yet while its first DSP is
+ computed, and its inputs are not used anymore once read by its first DSP, so that its subtrees take their
+ channels there first (a chain of sequencers alternating between two sets of channels). The pool is allocated
+ once for the whole tree by its root combiner, and blocks larger than the buffer size are computed by chunks.
+ */
+
+class dsp_buffer_pool {
+    
+    private:
+    
+        std::vector<FAUSTFLOAT*> fChannels;
+        int fBufferSize;
+    
+    public:
+    
+        dsp_buffer_pool(int channels, int buffer_size):fBufferSize(buffer_size)
+        {
+            for (int chan = 0; chan < channels; chan++) {
+                FAUSTFLOAT* channel = new FAUSTFLOAT[buffer_size];
+                memset(channel, 0, sizeof(FAUSTFLOAT) * buffer_size);
+                fChannels.push_back(channel);
+            }
+        }
+    
+        virtual ~dsp_buffer_pool()
+        {
+            for (size_t chan = 0; chan < fChannels.size(); chan++) {
+                delete [] fChannels[chan];
+            }
+        }
+    
+        FAUSTFLOAT* getChannel(int chan) { return fChannels[chan]; }
+        int getChannels() { return int(fChannels.size()); }
+        int getBufferSize() { return fBufferSize; }
+    
+};
+
 // Base class and common code for binary combiners
 
 class dsp_binary_combiner : public dsp {
@@ -41,6 +89,105 @@ class dsp_binary_combiner : public dsp {
         dsp* fDSP1;
         dsp* fDSP2;
     
+        int fBufferSize;            // Maximum number of frames given to the subtrees 'compute'
+        dsp_buffer_pool* fPool;     // Only allocated by the root combiner of a tree
+        FAUSTFLOAT** fBuffers;      // Intermediate channels of this combiner, located in the pool
+        FAUSTFLOAT** fInputsChunk;
+        FAUSTFLOAT** fOutputsChunk;
+    
+        // Number of intermediate channels used by this combiner
+        virtual int getBufferChannels() { return 0; }
+    
+        // Pool channels of a subtree
+        struct buffers_plan {
+            std::vector<int> fInputs;      // Read by the subtree (empty when given by the caller)
+            std::vector<int> fOutputs;     // Written by the subtree (empty when given by the caller)
+            std::vector<int> fReleased;    // Not used by the rest of the tree while the subtree is computed
+        };
+    
+        /*
+         Pool channels of the subtrees, 'plan' being the one of the combiner and 'buffers' its intermediate channels.
+         The subtrees plans are only given the channels released by the combiner ancestors by default.
+         */
+        virtual void getSubtreesPlans(const buffers_plan& plan, const std::vector<int>& buffers, buffers_plan& plan1, buffers_plan& plan2)
+        {}
+    
+        // Compute at most fBufferSize frames (subclasses which directly implement 'compute' do not need it)
+        virtual void computeBlock(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            for (int chan = 0; chan < getNumOutputs(); chan++) {
+                memset(outputs[chan], 0, sizeof(FAUSTFLOAT) * count);
+            }
+        }
+    
+        static dsp_binary_combiner* getCombiner(dsp* dsp)
+        {
+            return dynamic_cast<dsp_binary_combiner*>(dsp);
+        }
+    
+        /*
+         Locate the intermediate channels of the tree in 'pool' (or only count them if 'pool' is null), and return
+         the number of pool channels needed by the tree: the released channels of 'plan' are used first,
+         other channels being taken on the stack, starting at 'base'.
+         */
+        int planBuffers(dsp_buffer_pool* pool, const buffers_plan& plan, int base)
+        {
+            std::vector<int> buffers;
+            std::vector<int> free = plan.fReleased;
+            int top = base;
+            for (int chan = 0; chan < getBufferChannels(); chan++) {
+                if (free.size() > 0) {
+                    buffers.push_back(free.back());
+                    free.pop_back();
+                } else {
+                    buffers.push_back(top++);
+                }
+                if (pool) fBuffers[chan] = pool->getChannel(buffers[chan]);
+            }
+            
+            buffers_plan plan1, plan2;
+            plan1.fReleased = plan2.fReleased = free;
+            getSubtreesPlans(plan, buffers, plan1, plan2);
+            
+            int needed = top;
+            dsp_binary_combiner* combiner1 = getCombiner(fDSP1);
+            dsp_binary_combiner* combiner2 = getCombiner(fDSP2);
+            if (pool) {
+                // The subtrees are not roots anymore
+                if (combiner1) { delete combiner1->fPool; combiner1->fPool = 0; }
+                if (combiner2) { delete combiner2->fPool; combiner2->fPool = 0; }
+            }
+            if (combiner1) needed = std::max(needed, combiner1->planBuffers(pool, plan1, top));
+            if (combiner2) needed = std::max(needed, combiner2->planBuffers(pool, plan2, top));
+            return needed;
+        }
+    
+        // To be called at the end of the subclasses constructor, when the combiner is the root of its tree
+        void initBuffers()
+        {
+            buffers_plan root;
+            fBuffers = new FAUSTFLOAT*[getBufferChannels()];
+            fInputsChunk = new FAUSTFLOAT*[getNumInputs()];
+            fOutputsChunk = new FAUSTFLOAT*[getNumOutputs()];
+            fPool = new dsp_buffer_pool(planBuffers(0, root, 0), fBufferSize);
+            planBuffers(fPool, root, 0);
+        }
+    
+        /*
+         Sequencer, splitter and merger: fDSP1 reads the combiner inputs and writes its buffers, then fDSP2
+         reads the buffers and writes the combiner outputs. So the outputs are released while fDSP1 is computed,
+         and the inputs while fDSP2 is computed.
+         */
+        void getSerialPlans(const buffers_plan& plan, const std::vector<int>& buffers, buffers_plan& plan1, buffers_plan& plan2)
+        {
+            plan1.fInputs = plan.fInputs;
+            plan1.fOutputs = buffers;
+            plan1.fReleased.insert(plan1.fReleased.end(), plan.fOutputs.begin(), plan.fOutputs.end());
+            plan2.fInputs = buffers;
+            plan2.fOutputs = plan.fOutputs;
+            plan2.fReleased.insert(plan2.fReleased.end(), plan.fInputs.begin(), plan.fInputs.end());
+        }
+    
         void buildUserInterfaceAux(UI* ui_interface, const char* name)
         {
             ui_interface->openTabBox(name);
@@ -73,15 +220,43 @@ class dsp_binary_combiner : public dsp {
     
      public:
     
-        dsp_binary_combiner(dsp* dsp1, dsp* dsp2):fDSP1(dsp1), fDSP2(dsp2)
+        dsp_binary_combiner(dsp* dsp1, dsp* dsp2, int buffer_size = COMBINER_BUFFER_SIZE)
+        :fDSP1(dsp1), fDSP2(dsp2), fBufferSize(buffer_size), fPool(0), fBuffers(0), fInputsChunk(0), fOutputsChunk(0)
         {}
         
         virtual ~dsp_binary_combiner()
         {
             delete fDSP1;
             delete fDSP2;
+            delete fPool;
+            delete [] fBuffers;
+            delete [] fInputsChunk;
+            delete [] fOutputsChunk;
         }
     
+        // Number of intermediate channels allocated for the whole tree (when the combiner is the root)
+        int getAllocatedChannels() { return (fPool) ? fPool->getChannels() : 0; }
+    
+        // Any block size is accepted, larger blocks being computed by chunks of fBufferSize frames
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            if (count <= fBufferSize) {
+                computeBlock(count, inputs, outputs);
+            } else {
+                for (int offset = 0; offset < count; offset += fBufferSize) {
+                    for (int chan = 0; chan < getNumInputs(); chan++) {
+                        fInputsChunk[chan] = &inputs[chan][offset];
+                    }
+                    for (int chan = 0; chan < getNumOutputs(); chan++) {
+                        fOutputsChunk[chan] = &outputs[chan][offset];
+                    }
+                    computeBlock(std::min<int>(fBufferSize, count - offset), fInputsChunk, fOutputsChunk);
+                }
+            }
+        }
+    
+        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) { compute(count, inputs, outputs); }
+    
         virtual int getSampleRate()
         {
             return fDSP1->getSampleRate();
@@ -129,20 +304,27 @@ class dsp_binary_combiner : public dsp {
 
 class dsp_sequencer : public dsp_binary_combiner {
     
-    private:
+    protected:
     
-        FAUSTFLOAT** fDSP1Outputs;
-         
-    public:
-        
-        dsp_sequencer(dsp* dsp1, dsp* dsp2, int buffer_size = 4096):dsp_binary_combiner(dsp1, dsp2)
+        // fDSP1 outputs
+        virtual int getBufferChannels() { return fDSP1->getNumOutputs(); }
+    
+        virtual void getSubtreesPlans(const buffers_plan& plan, const std::vector<int>& buffers, buffers_plan& plan1, buffers_plan& plan2)
         {
-            fDSP1Outputs = allocateChannels(fDSP1->getNumOutputs(), buffer_size);
+            getSerialPlans(plan, buffers, plan1, plan2);
         }
+    
+        virtual void computeBlock(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            fDSP1->compute(count, inputs, fBuffers);
+            fDSP2->compute(count, fBuffers, outputs);
+        }
+         
+    public:
         
-        virtual ~dsp_sequencer()
+        dsp_sequencer(dsp* dsp1, dsp* dsp2, int buffer_size = COMBINER_BUFFER_SIZE):dsp_binary_combiner(dsp1, dsp2, buffer_size)
         {
-            deleteChannels(fDSP1Outputs, fDSP1->getNumOutputs());
+            initBuffers();
         }
                
         virtual int getNumInputs() { return fDSP1->getNumInputs(); }
@@ -155,17 +337,9 @@ class dsp_sequencer : public dsp_binary_combiner {
     
         virtual dsp* clone()
         {
-            return new dsp_sequencer(fDSP1->clone(), fDSP2->clone());
-        }
-    
-        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
-        {
-            fDSP1->compute(count, inputs, fDSP1Outputs);
-            fDSP2->compute(count, fDSP1Outputs, outputs);
+            return new dsp_sequencer(fDSP1->clone(), fDSP2->clone(), fBufferSize);
         }
     
-        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) { compute(count, inputs, outputs); }
-    
 };
 
 // Combine two DSP in parallel
@@ -177,12 +351,30 @@ class dsp_parallelizer : public dsp_binary_combiner {
         FAUSTFLOAT** fDSP2Inputs;
         FAUSTFLOAT** fDSP2Outputs;
     
+    protected:
+    
+        virtual void computeBlock(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            fDSP1->compute(count, inputs, outputs);
+            
+            // Shift inputs/outputs channels for fDSP2
+            for (int chan = 0; chan < fDSP2->getNumInputs(); chan++) {
+                fDSP2Inputs[chan] = inputs[fDSP1->getNumInputs() + chan];
+            }
+            for (int chan = 0; chan < fDSP2->getNumOutputs(); chan++) {
+                fDSP2Outputs[chan] = outputs[fDSP1->getNumOutputs() + chan];
+            }
+            
+            fDSP2->compute(count, fDSP2Inputs, fDSP2Outputs);
+        }
+    
     public:
         
-        dsp_parallelizer(dsp* dsp1, dsp* dsp2, int buffer_size = 4096):dsp_binary_combiner(dsp1, dsp2)
+        dsp_parallelizer(dsp* dsp1, dsp* dsp2, int buffer_size = COMBINER_BUFFER_SIZE):dsp_binary_combiner(dsp1, dsp2, buffer_size)
         {
             fDSP2Inputs = new FAUSTFLOAT*[fDSP2->getNumInputs()];
             fDSP2Outputs = new FAUSTFLOAT*[fDSP2->getNumOutputs()];
+            initBuffers();
         }
         
         virtual ~dsp_parallelizer()
@@ -201,26 +393,9 @@ class dsp_parallelizer : public dsp_binary_combiner {
     
         virtual dsp* clone()
         {
-            return new dsp_parallelizer(fDSP1->clone(), fDSP2->clone());
-        }
-
-        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
-        {
-            fDSP1->compute(count, inputs, outputs);
-            
-            // Shift inputs/outputs channels for fDSP2
-            for (int chan = 0; chan < fDSP2->getNumInputs(); chan++) {
-                fDSP2Inputs[chan] = inputs[fDSP1->getNumInputs() + chan];
-            }
-            for (int chan = 0; chan < fDSP2->getNumOutputs(); chan++) {
-                fDSP2Outputs[chan] = outputs[fDSP1->getNumOutputs() + chan];
-            }
-            
-            fDSP2->compute(count, fDSP2Inputs, fDSP2Outputs);
+            return new dsp_parallelizer(fDSP1->clone(), fDSP2->clone(), fBufferSize);
         }
     
-        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) { compute(count, inputs, outputs); }
-    
 };
 
 // Combine two 'compatible' DSP in splitter
@@ -229,20 +404,40 @@ class dsp_splitter : public dsp_binary_combiner {
     
     private:
     
-        FAUSTFLOAT** fDSP1Outputs;
         FAUSTFLOAT** fDSP2Inputs;
     
+    protected:
+    
+        // fDSP1 outputs
+        virtual int getBufferChannels() { return fDSP1->getNumOutputs(); }
+    
+        virtual void getSubtreesPlans(const buffers_plan& plan, const std::vector<int>& buffers, buffers_plan& plan1, buffers_plan& plan2)
+        {
+            getSerialPlans(plan, buffers, plan1, plan2);
+        }
+    
+        virtual void computeBlock(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            fDSP1->compute(count, inputs, fBuffers);
+            
+            // fDSP1 outputs are shared (not copied) by the fDSP2 inputs
+            for (int chan = 0; chan < fDSP2->getNumInputs(); chan++) {
+                 fDSP2Inputs[chan] = fBuffers[chan % fDSP1->getNumOutputs()];
+            }
+            
+            fDSP2->compute(count, fDSP2Inputs, outputs);
+        }
+    
     public:
     
-        dsp_splitter(dsp* dsp1, dsp* dsp2, int buffer_size = 4096):dsp_binary_combiner(dsp1, dsp2)
+        dsp_splitter(dsp* dsp1, dsp* dsp2, int buffer_size = COMBINER_BUFFER_SIZE):dsp_binary_combiner(dsp1, dsp2, buffer_size)
         {
-            fDSP1Outputs = allocateChannels(fDSP1->getNumOutputs(), buffer_size);
             fDSP2Inputs = new FAUSTFLOAT*[fDSP2->getNumInputs()];
+            initBuffers();
         }
     
         virtual ~dsp_splitter()
         {
-            deleteChannels(fDSP1Outputs, fDSP1->getNumOutputs());
             delete [] fDSP2Inputs;
         }
     
@@ -256,19 +451,9 @@ class dsp_splitter : public dsp_binary_combiner {
         
         virtual dsp* clone()
         {
-            return new dsp_splitter(fDSP1->clone(), fDSP2->clone());
+            return new dsp_splitter(fDSP1->clone(), fDSP2->clone(), fBufferSize);
         }
     
-        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
-        {
-            fDSP1->compute(count, inputs, fDSP1Outputs);
-            
-            for (int chan = 0; chan < fDSP2->getNumInputs(); chan++) {
-                 fDSP2Inputs[chan] = fDSP1Outputs[chan % fDSP1->getNumOutputs()];
-            }
-            
-            fDSP2->compute(count, fDSP2Inputs, outputs);
-        }
 };
 
 // Combine two 'compatible' DSP in merger
@@ -277,8 +462,6 @@ class dsp_merger : public dsp_binary_combiner {
     
     private:
     
-        FAUSTFLOAT** fDSP1Inputs;
-        FAUSTFLOAT** fDSP1Outputs;
         FAUSTFLOAT** fDSP2Inputs;
     
         void mix(int count, FAUSTFLOAT* dst, FAUSTFLOAT* src)
@@ -288,19 +471,45 @@ class dsp_merger : public dsp_binary_combiner {
             }
         }
     
+    protected:
+    
+        // fDSP1 outputs
+        virtual int getBufferChannels() { return fDSP1->getNumOutputs(); }
+    
+        virtual void getSubtreesPlans(const buffers_plan& plan, const std::vector<int>& buffers, buffers_plan& plan1, buffers_plan& plan2)
+        {
+            getSerialPlans(plan, buffers, plan1, plan2);
+        }
+    
+        virtual void computeBlock(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            fDSP1->compute(count, inputs, fBuffers);
+            
+            memset(fDSP2Inputs, 0, sizeof(FAUSTFLOAT*) * fDSP2->getNumInputs());
+            
+            // fDSP1 outputs are mixed in place in the first one of each group
+            for (int chan = 0; chan < fDSP1->getNumOutputs(); chan++) {
+                int mchan = chan % fDSP2->getNumInputs();
+                if (fDSP2Inputs[mchan]) {
+                    mix(count, fDSP2Inputs[mchan], fBuffers[chan]);
+                } else {
+                    fDSP2Inputs[mchan] = fBuffers[chan];
+                }
+            }
+            
+            fDSP2->compute(count, fDSP2Inputs, outputs);
+        }
+    
     public:
         
-        dsp_merger(dsp* dsp1, dsp* dsp2, int buffer_size = 4096):dsp_binary_combiner(dsp1, dsp2)
+        dsp_merger(dsp* dsp1, dsp* dsp2, int buffer_size = COMBINER_BUFFER_SIZE):dsp_binary_combiner(dsp1, dsp2, buffer_size)
         {
-            fDSP1Inputs = allocateChannels(fDSP1->getNumInputs(), buffer_size);
-            fDSP1Outputs = allocateChannels(fDSP1->getNumOutputs(), buffer_size);
             fDSP2Inputs = new FAUSTFLOAT*[fDSP2->getNumInputs()];
+            initBuffers();
         }
     
         virtual ~dsp_merger()
         {
-            deleteChannels(fDSP1Inputs, fDSP1->getNumInputs());
-            deleteChannels(fDSP1Outputs, fDSP1->getNumOutputs());
             delete [] fDSP2Inputs;
         }
     
@@ -314,26 +523,9 @@ class dsp_merger : public dsp_binary_combiner {
         
         virtual dsp* clone()
         {
-            return new dsp_merger(fDSP1->clone(), fDSP2->clone());
-        }
-        
-        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
-        {
-            fDSP1->compute(count, fDSP1Inputs, fDSP1Outputs);
-            
-            memset(fDSP2Inputs, 0, sizeof(FAUSTFLOAT*) * fDSP2->getNumInputs());
-            
-            for (int chan = 0; chan < fDSP1->getNumOutputs(); chan++) {
-                int mchan = chan % fDSP2->getNumInputs();
-                if (fDSP2Inputs[mchan]) {
-                    mix(count, fDSP2Inputs[mchan], fDSP1Outputs[chan]);
-                } else {
-                    fDSP2Inputs[mchan] = fDSP1Outputs[chan];
-                }
-            }
-            
-            fDSP2->compute(count, fDSP2Inputs, outputs);
+            return new dsp_merger(fDSP1->clone(), fDSP2->clone(), fBufferSize);
         }
+    
 };
 
 // Combine two 'compatible' DSP in a recursive way
@@ -350,12 +542,14 @@ class dsp_recursiver : public dsp_binary_combiner {
     
     public:
         
-        dsp_recursiver(dsp* dsp1, dsp* dsp2):dsp_binary_combiner(dsp1, dsp2)
+        dsp_recursiver(dsp* dsp1, dsp* dsp2, int buffer_size = COMBINER_BUFFER_SIZE):dsp_binary_combiner(dsp1, dsp2, buffer_size)
         {
+            // One frame channels, since the subtrees are computed frame by frame
             fDSP1Inputs = allocateChannels(fDSP1->getNumInputs(), 1);
             fDSP1Outputs = allocateChannels(fDSP1->getNumOutputs(), 1);
             fDSP2Inputs = allocateChannels(fDSP2->getNumInputs(), 1);
             fDSP2Outputs = allocateChannels(fDSP2->getNumOutputs(), 1);
+            initBuffers();
         }
         
         virtual ~dsp_recursiver()
@@ -376,10 +570,12 @@ class dsp_recursiver : public dsp_binary_combiner {
         
         virtual dsp* clone()
         {
-            return new dsp_recursiver(fDSP1->clone(), fDSP2->clone());
+            return new dsp_recursiver(fDSP1->clone(), fDSP2->clone(), fBufferSize);
         }
+    
+    protected:
         
-        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        virtual void computeBlock(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
         {
             for (int frame = 0; (frame < count); frame++) {
                 
@@ -404,8 +600,6 @@ class dsp_recursiver : public dsp_binary_combiner {
                 fDSP2->compute(1, fDSP2Inputs, fDSP2Outputs);
             }
         }
-        
-        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) { compute(count, inputs, outputs); }
     
 };
 
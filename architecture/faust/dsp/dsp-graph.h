@@ -0,0 +1,178 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __dsp_graph__
+#define __dsp_graph__
+
+#include <string>
+#include <sstream>
+#include <map>
+#include <mutex>
+
+#include "faust/dsp/llvm-dsp.h"
+#include "faust/dsp/libfaust.h"
+
+/**
+ * Graph of Faust DSP sources, composed with the Faust block diagram operators.
+ *
+ * Unlike the dsp-combiner.h classes, which connect already compiled DSPs through their 'compute' methods
+ * and intermediate buffers, the graph is compiled as a single Faust program, so that the compiler
+ * can inline and optimize across modules boundaries, without any intermediate buffer.
+ *
+ * Each module is kept in its own environment (so that definitions of different modules cannot collide)
+ * and is shared if used several times in the graph.
+ */
+
+class dsp_graph {
+
+    private:
+
+        std::string fExpression;                        // Faust expression of the graph
+        std::map<std::string, std::string> fModules;    // Module name => Faust source
+
+    public:
+
+        /**
+         * Create a graph with a single module.
+         *
+         * @param dsp_content - the Faust program of the module, defining 'process'
+         * @param group - if not empty, the module controls are put in a group with this label. Since controls
+         *                with the same path are shared in a Faust program, this allows several instances
+         *                of a module to be independently controlled.
+         */
+        dsp_graph(const std::string& dsp_content, const std::string& group = "")
+        {
+            std::string name = "module_" + generateSHA1(dsp_content).substr(0, 16);
+            fModules[name] = dsp_content;
+            fExpression = (group == "") ? name : "hgroup(\"" + group + "\", " + name + ")";
+        }
+
+        // Compose two graphs with a Faust block diagram operator (':', ',', '<:', ':>' or '~')
+        dsp_graph(const dsp_graph& graph1, const dsp_graph& graph2, const std::string& op)
+        {
+            fModules = graph1.fModules;
+            fModules.insert(graph2.fModules.begin(), graph2.fModules.end());
+            fExpression = "(" + graph1.fExpression + " " + op + " " + graph2.fExpression + ")";
+        }
+
+        std::string getExpression() const { return fExpression; }
+
+        // The complete Faust program of the graph
+        std::string getDSPCode() const
+        {
+            std::stringstream code;
+            std::map<std::string, std::string>::const_iterator it;
+            for (it = fModules.begin(); it != fModules.end(); it++) {
+                code << (*it).first << " = environment {\n" << (*it).second << "\n}.process;\n";
+            }
+            code << "process = " << fExpression << ";\n";
+            return code.str();
+        }
+
+};
+
+// Graph algebra API, with the same semantic as the dsp-combiner.h one
+
+static dsp_graph createGraphSequencer(const dsp_graph& graph1, const dsp_graph& graph2)
+{
+    return dsp_graph(graph1, graph2, ":");
+}
+
+static dsp_graph createGraphParallelizer(const dsp_graph& graph1, const dsp_graph& graph2)
+{
+    return dsp_graph(graph1, graph2, ",");
+}
+
+static dsp_graph createGraphSplitter(const dsp_graph& graph1, const dsp_graph& graph2)
+{
+    return dsp_graph(graph1, graph2, "<:");
+}
+
+static dsp_graph createGraphMerger(const dsp_graph& graph1, const dsp_graph& graph2)
+{
+    return dsp_graph(graph1, graph2, ":>");
+}
+
+static dsp_graph createGraphRecursiver(const dsp_graph& graph1, const dsp_graph& graph2)
+{
+    return dsp_graph(graph1, graph2, "~");
+}
+
+/**
+ * Create a Faust DSP factory from a graph, compiled as a single program.
+ *
+ * Factories are cached by graph SHA key (computed on the graph program, compilation parameters and target),
+ * so that creating the factory of an already compiled graph neither parses nor compiles the program again,
+ * as long as the factory is still alive in the libfaust cache. As with createDSPFactoryFromString,
+ * the returned factory is reference counted and has to be deleted with deleteDSPFactory.
+ * The cache is protected by a mutex, so the function can be called from several threads.
+ *
+ * @param graph - the graph
+ * @param argc - the number of parameters in argv array
+ * @param argv - the array of parameters
+ * @param target - the LLVM machine target (using empty string will take current machine settings)
+ * @param error_msg - the error string to be filled (connection errors are reported by the Faust compiler)
+ * @param opt_level - LLVM IR to IR optimization level (from -1 to 4, -1 means 'maximum possible value'
+ * since the maximum value may change with new LLVM versions)
+ *
+ * @return a DSP factory on success, otherwise a null pointer.
+ */
+static llvm_dsp_factory* createDSPFactoryFromGraph(const dsp_graph& graph,
+                                                   int argc, const char* argv[],
+                                                   const std::string& target,
+                                                   std::string& error_msg,
+                                                   int opt_level = -1)
+{
+    // Graph SHA key => factory SHA key
+    static std::map<std::string, std::string> gGraphFactoryTable;
+    static std::mutex gGraphFactoryMutex;
+
+    std::string dsp_content = graph.getDSPCode();
+    std::stringstream key;
+    key << dsp_content << target << " " << opt_level;
+    for (int i = 0; i < argc; i++) {
+        key << " " << argv[i];
+    }
+    std::string graph_key = generateSHA1(key.str());
+
+    {
+        std::lock_guard<std::mutex> lock(gGraphFactoryMutex);
+        std::map<std::string, std::string>::iterator it = gGraphFactoryTable.find(graph_key);
+        if (it != gGraphFactoryTable.end()) {
+            llvm_dsp_factory* factory = getDSPFactoryFromSHAKey((*it).second);
+            if (factory) return factory;
+            // The factory has been deleted in the meantime
+            gGraphFactoryTable.erase(it);
+        }
+    }
+
+    // Compiled without holding the lock (libfaust protects its own factory table)
+    llvm_dsp_factory* factory = createDSPFactoryFromString("FaustGraph", dsp_content, argc, argv, target, error_msg, opt_level);
+    if (factory) {
+        std::lock_guard<std::mutex> lock(gGraphFactoryMutex);
+        gGraphFactoryTable[graph_key] = factory->getSHAKey();
+    }
+    return factory;
+}
+
+#endif
@@ -1,4 +1,3 @@
-
 /************************************************************************
     FAUST Architecture File
     Copyright (C) 2016 GRAME, Centre National de Creation Musicale
@@ -28,62 +27,79 @@
 
 #include <iostream>
 #include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <sys/types.h>
 #include <pwd.h>
 #include <unistd.h>
 #include <typeinfo>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "faust/dsp/llvm-dsp.h"
 #include "faust/dsp/dsp-bench.h"
 
 /*
     A class to find optimal Faust compiler parameters for a given DSP.
+ 
+    - all candidate options are compiled first, on a pool of threads
+    - candidates are then compared by successive halving: all of them are measured with a short
+      benchmark, the best half is kept and measured again with a twice longer one, and so on,
+      until a single one remains (so that most of the time is spent on the promising candidates)
+    - benchmarks are run one at a time, on a single core (the last one available by default, on Linux)
+    - the result is kept in a database file, keyed by the DSP SHA key, the CPU, the sample type
+      and the buffer size, so that the same DSP is optimized only once on a given machine
 */
+
+#define OPTIMIZER_MIN_COUNT   20    // Minimum number of measured buffers in a round
+#define OPTIMIZER_FIRST_ROUND 16    // The first round uses fCount/OPTIMIZER_FIRST_ROUND buffers
+
 template <typename SAMPLE_TYPE>
 class dsp_optimizer {
 
     private:
     
+        struct candidate {
+            
+            std::vector<std::string> fOptions;
+            llvm_dsp_factory* fFactory;
+            std::string fError;
+            double fScore;
+            
+            candidate(const std::vector<std::string>& options):fOptions(options), fFactory(0), fScore(0.) {}
+            
+            static bool compare(const candidate* c1, const candidate* c2) { return c1->fScore > c2->fScore; }
+            
+        };
+    
         int fBufferSize;     // size of a vector in samples
     
         int fArgc;
         const char** fArgv;
     
-        int fOptLevel;      
-        llvm_dsp_factory* fFactory;
-        llvm_dsp* fDSP;
+        int fOptLevel;
     
         int fRun;
         int fCount;
         bool fTrace;
         bool fNeedExp10;
     
+        int fThreads;        // number of compilation threads
+        int fBenchCore;      // core used for benchmarks, or -1
+    
         std::string fFilename;
         std::string fInput;
         std::string fTarget;
         std::string fError;
     
-        std::vector<std::vector <std::string> > fOptionsTable;
+        std::string fDatabase;  // database filename, or empty
+        std::string fKey;       // database key of the DSP
     
-        double bench(int run)
-        {
-            // First call with fCount = -1 will be used to estimate fCount by giving the wanted measure duration
-            if (fCount == -1) {
-                measure_dsp mes(fDSP, fBufferSize, 5., fTrace);
-                mes.measure();
-                // fCount is kept from the first duration measure
-                fCount = mes.getCount();
-                return mes.getStats();
-            } else {
-                measure_dsp mes(fDSP, fBufferSize, fCount, fTrace);
-                for (int i = 0; i < run; i++) {
-                    mes.measure();
-                    if (fTrace) std::cout << mes.getStats() << " " << "(DSP CPU % : " << (mes.getCPULoad() * 100) << ")" << std::endl;
-                    FAUSTBENCH_LOG<double>(mes.getStats());
-                }
-                return mes.getStats();
-            }
-        }
+        std::vector<std::vector <std::string> > fOptionsTable;
     
         void init()
         {
@@ -221,7 +237,7 @@ class dsp_optimizer {
     
         void printItem(const std::vector <std::string>& item)
         {
-            for (int i = 0; i < item.size(); i++) {
+            for (size_t i = 0; i < item.size(); i++) {
                 std::cout << " " << item[i];
             }
             std::cout << " : ";
@@ -235,63 +251,234 @@ class dsp_optimizer {
             }
             return res_item;
         }
-        
-        bool computeOne(const std::vector<std::string>& item, int run, double& res)
+    
+        bool compileOne(candidate& cand)
         {
+            std::vector<std::string> item = addArgvItems(cand.fOptions, fArgc, fArgv);
             int argc = 0;
             const char* argv[64];
-            for (int i = 0; i < item.size(); i++) {
+            for (size_t i = 0; i < item.size() && argc < 63; i++) {
                 argv[argc++] = item[i].c_str();
             }
             argv[argc] = 0;  // NULL terminated argv
             
             if (fInput == "") {
-                fFactory = createDSPFactoryFromFile(fFilename.c_str(), argc, argv, fTarget, fError, fOptLevel);
+                cand.fFactory = createDSPFactoryFromFile(fFilename.c_str(), argc, argv, fTarget, cand.fError, fOptLevel);
             } else {
-                fFactory = createDSPFactoryFromString("FaustDSP", fInput, argc, argv, fTarget, fError, fOptLevel);
+                cand.fFactory = createDSPFactoryFromString("FaustDSP", fInput, argc, argv, fTarget, cand.fError, fOptLevel);
             }
+            return cand.fFactory != 0;
+        }
+    
+        // Compile all candidates using fThreads threads (the calling one included)
+        void compileAll(std::vector<candidate>& candidates)
+        {
+            std::atomic<size_t> next(0);
+            auto worker = [this, &candidates, &next]() {
+                size_t i;
+                while ((i = next++) < candidates.size()) {
+                    compileOne(candidates[i]);
+                }
+            };
             
-            if (!fFactory) {
-                std::cerr << "Cannot create factory : " << fError;
-                return false;
+            std::vector<std::thread> threads;
+            size_t nthreads = std::min<size_t>(std::max<int>(fThreads, 1), candidates.size());
+            // The factories API has to be explicitly made thread safe
+            if (nthreads > 1) startMTDSPFactories();
+            for (size_t i = 1; i < nthreads; i++) {
+                threads.push_back(std::thread(worker));
             }
+            worker();
+            for (size_t i = 0; i < threads.size(); i++) {
+                threads[i].join();
+            }
+            if (nthreads > 1) stopMTDSPFactories();
             
-            fDSP = fFactory->createDSPInstance();
-            if (!fDSP) {
+            for (size_t i = 0; i < candidates.size(); i++) {
+                if (!candidates[i].fFactory) {
+                    std::cerr << "Cannot create factory : " << candidates[i].fError;
+                }
+            }
+        }
+    
+        void deleteAll(std::vector<candidate>& candidates)
+        {
+            for (size_t i = 0; i < candidates.size(); i++) {
+                if (candidates[i].fFactory) {
+                    deleteDSPFactory(candidates[i].fFactory);
+                    candidates[i].fFactory = 0;
+                }
+            }
+        }
+    
+        // Pin the calling thread on fBenchCore, keeping its previous affinity in 'saved'
+    #ifdef __linux__
+        void pinBenchThread(cpu_set_t& saved)
+        {
+            if (fBenchCore < 0) return;
+            pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &saved);
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(fBenchCore, &set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) != 0) {
+                std::cerr << "Cannot run benchmarks on core " << fBenchCore << std::endl;
+            }
+        }
+    
+        void unpinBenchThread(cpu_set_t& saved)
+        {
+            if (fBenchCore < 0) return;
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &saved);
+        }
+    
+        static int defaultBenchCore()
+        {
+            // The last core of the current affinity mask, if there are several ones
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) != 0 || CPU_COUNT(&set) < 2) return -1;
+            for (int core = CPU_SETSIZE - 1; core >= 0; core--) {
+                if (CPU_ISSET(core, &set)) return core;
+            }
+            return -1;
+        }
+    #else
+        static int defaultBenchCore() { return -1; }
+    #endif
+    
+        // Measure 'count' buffers 'run' times, fCount = -1 is used to estimate fCount for a 5 seconds measure
+        bool benchOne(candidate& cand, int count, int run)
+        {
+            llvm_dsp* dsp = cand.fFactory->createDSPInstance();
+            if (!dsp) {
                 std::cerr << "Cannot create instance..." << std::endl;
                 return false;
             }
             
-            if (fTrace) printItem(item);
-            
-            res = bench(run);
-            // fDSP is deallocated by bench calling measure_dsp
-            
-            deleteDSPFactory(fFactory);
-            fFactory = 0;
-            fDSP = 0;
+            if (fTrace) printItem(cand.fOptions);
             
+            // dsp is deallocated by measure_dsp
+            if (count == -1) {
+                measure_dsp mes(dsp, fBufferSize, 5., fTrace);
+                mes.measure();
+                // fCount is kept from the first duration measure
+                fCount = std::max<int>(mes.getCount(), OPTIMIZER_MIN_COUNT);
+                cand.fScore = mes.getStats();
+            } else {
+                measure_dsp mes(dsp, fBufferSize, count, fTrace);
+                for (int i = 0; i < run; i++) {
+                    mes.measure();
+                    if (fTrace) std::cout << mes.getStats() << " " << "(DSP CPU % : " << (mes.getCPULoad() * 100) << ")" << std::endl;
+                    FAUSTBENCH_LOG<double>(mes.getStats());
+                }
+                cand.fScore = mes.getStats();
+            }
             return true;
         }
     
-        std::pair<double, std::vector<std::string> > findOptimizedParametersAux(const std::vector<std::vector <std::string> >& options)
+        // Successive halving on the compiled candidates, returns the best one (or null)
+        candidate* findBest(std::vector<candidate>& candidates)
         {
-            std::vector<std::pair<int, double > > table_res;
-            double res = 0.;
+            std::vector<candidate*> alive;
+            for (size_t i = 0; i < candidates.size(); i++) {
+                if (candidates[i].fFactory) alive.push_back(&candidates[i]);
+            }
+            if (alive.size() == 0) return 0;
+            
+        #ifdef __linux__
+            cpu_set_t saved;
+            pinBenchThread(saved);
+        #endif
             
-            for (int i = 0; i < options.size(); i++) {
-                if (computeOne(addArgvItems(options[i], fArgc, fArgv), fRun, res)) {
-                    table_res.push_back(std::make_pair(i, res));
-                } else {
-                    std::cerr << "computeOne error..." << std::endl;
+            int count = std::max<int>(fCount / OPTIMIZER_FIRST_ROUND, OPTIMIZER_MIN_COUNT);
+            bool full = false;
+            for (int round = 0; alive.size() > 1 || !full; round++) {
+                full = (count >= fCount);
+                if (fTrace) std::cout << "Round " << round << " : " << alive.size() << " candidate(s), " << std::min<int>(count, fCount) << " buffers" << std::endl;
+                std::vector<candidate*> measured;
+                for (size_t i = 0; i < alive.size(); i++) {
+                    if (benchOne(*alive[i], std::min<int>(count, fCount), (full) ? fRun : 1)) {
+                        measured.push_back(alive[i]);
+                    } else {
+                        std::cerr << "benchOne error..." << std::endl;
+                    }
                 }
+                std::sort(measured.begin(), measured.end(), candidate::compare);
+                // Keep the best half
+                measured.resize((measured.size() + 1) / 2);
+                alive = measured;
+                if (alive.size() == 0) break;
+                count *= 2;
             }
             
-            sort(table_res.begin(), table_res.end(), compareFun);
-            return std::make_pair(table_res[0].second, options[table_res[0].first]);
+        #ifdef __linux__
+            unpinBenchThread(saved);
+        #endif
+            
+            return (alive.size() > 0) ? alive[0] : 0;
+        }
+    
+        // Database lines are: key score option1 option2...
+        bool readDatabase(std::pair<double, std::vector<std::string> >& res)
+        {
+            std::ifstream file(fDatabase.c_str());
+            std::string line;
+            bool found = false;
+            while (std::getline(file, line)) {
+                std::stringstream reader(line);
+                std::string key, option;
+                double score;
+                if ((reader >> key >> score) && key == fKey) {
+                    // The last entry for a given key is the most recent one
+                    res.first = score;
+                    res.second.clear();
+                    while (reader >> option) res.second.push_back(option);
+                    found = true;
+                }
+            }
+            return found;
+        }
+    
+        void writeDatabase(const std::pair<double, std::vector<std::string> >& res)
+        {
+            std::ofstream file(fDatabase.c_str(), std::ios::app);
+            if (!file.is_open()) {
+                std::cerr << "Cannot write optimizer database " << fDatabase << std::endl;
+                return;
+            }
+            std::stringstream line;
+            line << fKey << " " << res.first;
+            for (size_t i = 0; i < res.second.size(); i++) {
+                line << " " << res.second[i];
+            }
+            line << "\n";
+            file << line.str();
+        }
+    
+        static std::string defaultDatabase()
+        {
+            struct passwd* pw = getpwuid(getuid());
+            return (pw && pw->pw_dir) ? std::string(pw->pw_dir) + "/.faust-optimizer.db" : "";
+        }
+    
+        // The key is the DSP SHA key, the CPU, the sample type and the buffer size
+        bool makeKey()
+        {
+            candidate ref(fOptionsTable[0]);
+            if (!compileOne(ref)) {
+                fError = ref.fError;
+                std::cerr << "Cannot create factory : " << fError;
+                return false;
+            }
+            std::string cpu = (fTarget == "") ? getDSPMachineTarget() : fTarget;
+            std::stringstream key;
+            key << ref.fFactory->getSHAKey() << ":" << cpu << ":" << typeid(SAMPLE_TYPE).name() << ":" << fBufferSize;
+            fKey = key.str();
+            // Spaces would break the database format
+            std::replace(fKey.begin(), fKey.end(), ' ', '_');
+            deleteDSPFactory(ref.fFactory);
+            return true;
         }
-
-        static bool compareFun(std::pair<int, double> i, std::pair<int, double> j) { return (i.second > j.second); }
     
         bool init(const std::string& filename, const std::string input,
                   int argc, const char* argv[],
@@ -311,23 +498,34 @@ class dsp_optimizer {
             fCount = -1;
             fTrace = trace;
             fNeedExp10 = false;
+            fThreads = std::max<int>(std::thread::hardware_concurrency(), 1);
+            fBenchCore = defaultBenchCore();
+            fDatabase = defaultDatabase();
             
             init();
+            return makeKey();
+        }
+    
+        // Estimate timing parameters and test -exp10 need, on the two scalar candidates
+        bool estimate(std::vector<candidate>& candidates)
+        {
+            if (!candidates[0].fFactory || !candidates[1].fFactory) return false;
+            
+        #ifdef __linux__
+            cpu_set_t saved;
+            pinBenchThread(saved);
+        #endif
             
             if (fTrace) std::cout << "Estimate timing parameters" << std::endl;
-            double res1 = 0.;
-            if (!computeOne(addArgvItems(fOptionsTable[0], fArgc, fArgv), 1, res1)) {
-                std::cerr << "computeOne error..." << std::endl;
-                return false;
-            }
+            bool res = benchOne(candidates[0], -1, 1) && benchOne(candidates[0], fCount, 1);
             if (fTrace) std::cout << "Testing -exp10 need" << std::endl;
-            double res2 = 0.;
-            if (!computeOne(addArgvItems(fOptionsTable[1], fArgc, fArgv), 1, res2)) {
-                std::cerr << "computeOne error..." << std::endl;
-                return false;
-            }
-            fNeedExp10 = (res2 > (res1 * 1.05)); // If more than 5% faster
-            return true;
+            res = res && benchOne(candidates[1], fCount, 1);
+            fNeedExp10 = res && (candidates[1].fScore > (candidates[0].fScore * 1.05)); // If more than 5% faster
+            
+        #ifdef __linux__
+            unpinBenchThread(saved);
+        #endif
+            return res;
         }
     
     public:
@@ -376,7 +574,7 @@ class dsp_optimizer {
                       int buffer_size,
                       int opt_level = -1)
         {
-            if (!init("", input, argc, argv, target, buffer_size, opt_level)) {
+            if (!init("", input, argc, argv, target, buffer_size, 1, opt_level, true)) {
                 throw std::bad_alloc();
             }
         }
@@ -384,6 +582,23 @@ class dsp_optimizer {
         virtual ~dsp_optimizer()
         {}
     
+        /**
+         * Set the database file used to keep results (an empty string disables it).
+         * By default '.faust-optimizer.db' in the user home directory is used.
+         */
+        void setDatabase(const std::string& database) { fDatabase = database; }
+    
+        /**
+         * Set the number of threads used to compile candidates (the number of cores by default).
+         */
+        void setThreads(int threads) { fThreads = threads; }
+    
+        /**
+         * Set the core benchmarks are run on (Linux only), -1 to let the system choose.
+         * By default the last available core is used, when there are several ones.
+         */
+        void setBenchCore(int core) { fBenchCore = core; }
+    
         /**
          * Returns the best compilations parameters.
          *
@@ -391,13 +606,34 @@ class dsp_optimizer {
          */
         std::pair<double, std::vector<std::string> > findOptimizedParameters()
         {
+            std::pair<double, std::vector<std::string> > best;
+            if (fDatabase != "" && readDatabase(best)) {
+                if (fTrace) std::cout << "Found best parameters option in " << fDatabase << std::endl;
+                return best;
+            }
+            
+            if (fTrace) std::cout << "Compile " << fOptionsTable.size() << " candidates with " << fThreads << " thread(s)" << std::endl;
+            std::vector<candidate> candidates(fOptionsTable.begin(), fOptionsTable.end());
+            compileAll(candidates);
+            if (!estimate(candidates)) {
+                deleteAll(candidates);
+                throw std::bad_alloc();
+            }
+            
             if (fTrace) std::cout << "Discover best parameters option" << std::endl;
-            std::pair<double, std::vector<std::string> > best1 = findOptimizedParametersAux(fOptionsTable);
+            candidate* best1 = findBest(candidates);
+            if (!best1) {
+                deleteAll(candidates);
+                throw std::bad_alloc();
+            }
+            std::vector<std::string> best_options = best1->fOptions;
+            deleteAll(candidates);
             
             if (fTrace) std::cout << "Refined with -mcd" << std::endl;
             std::vector<std::vector <std::string> > options_table;
+            options_table.push_back(best_options);
             for (int size = 2; size <= 256; size *= 2) {
-                std::vector<std::string> best2 = best1.second;
+                std::vector<std::string> best2 = best_options;
                 std::stringstream num;
                 num << size;
                 best2.push_back("-mcd");
@@ -407,12 +643,27 @@ class dsp_optimizer {
             
             if (fNeedExp10) {
                 if (fTrace) std::cout << "Use -exp10" << std::endl;
-                std::vector <std::string> t0_exp10;
-                t0_exp10.push_back("-exp10");
-                options_table.push_back(t0_exp10);
+                size_t size = options_table.size();
+                for (size_t i = 0; i < size; i++) {
+                    std::vector <std::string> t0_exp10 = options_table[i];
+                    if (std::find(t0_exp10.begin(), t0_exp10.end(), "-exp10") != t0_exp10.end()) continue;
+                    t0_exp10.push_back("-exp10");
+                    options_table.push_back(t0_exp10);
+                }
+            }
+            
+            std::vector<candidate> refined(options_table.begin(), options_table.end());
+            compileAll(refined);
+            candidate* best2 = findBest(refined);
+            if (!best2) {
+                deleteAll(refined);
+                throw std::bad_alloc();
             }
+            best = std::make_pair(best2->fScore, best2->fOptions);
+            deleteAll(refined);
             
-            return findOptimizedParametersAux(options_table);
+            if (fDatabase != "") writeDatabase(best);
+            return best;
         }
     
         /**
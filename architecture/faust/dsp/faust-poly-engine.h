@@ -339,6 +339,7 @@ class FaustPolyEngine {
             int id = (address) ? fAPIUI.getParamIndex(address) : -1;
             if (id >= 0) {
                 fAPIUI.setParamValue(id, value);
+                GUI::markAllGuis(fAPIUI.getParamZone(id));
                 // In POLY mode, update all voices
                 GUI::updateAllGuis();
             }
@@ -362,6 +363,7 @@ class FaustPolyEngine {
         void setParamValue(int id, float value)
         {
             fAPIUI.setParamValue(id, value);
+            GUI::markAllGuis(fAPIUI.getParamZone(id));
             // In POLY mode, update all voices
             GUI::updateAllGuis();
         }
@@ -522,6 +524,9 @@ class FaustPolyEngine {
         void propagateAcc(int acc, float v)
         {
             fAPIUI.propagateAcc(acc, v);
+            for (int i = 0; i < fAPIUI.getAccZonesCount(acc); i++) {
+                GUI::markAllGuis(fAPIUI.getAccZone(acc, i));
+            }
             GUI::updateAllGuis();
         }
 
@@ -541,6 +546,9 @@ class FaustPolyEngine {
         void propagateGyr(int gyr, float v)
         {
             fAPIUI.propagateGyr(gyr, v);
+            for (int i = 0; i < fAPIUI.getGyrZonesCount(gyr); i++) {
+                GUI::markAllGuis(fAPIUI.getGyrZone(gyr, i));
+            }
             GUI::updateAllGuis();
         }
 
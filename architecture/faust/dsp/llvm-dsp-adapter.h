@@ -22,7 +22,7 @@
 #ifndef LLVM_DSP_ADAPTER_H
 #define LLVM_DSP_ADAPTER_H
 
-#include "faust/gui/JSONUIDecoder.h"
+#include "faust/gui/JSONUIStreamDecoder.h"
 
 /*
  Wraps a LLVM module compiled as object code in a 'dsp' class.
@@ -75,7 +75,7 @@ class mydsp : public dsp {
         mydsp()
         {
             std::string json = removeChar(getJSONmydsp(), '\\');
-            fDecoder = createJSONUIDecoder(json);
+            fDecoder = createJSONUIStreamDecoder(json);
             fDSP = static_cast<comp_llvm_dsp*>(calloc(1, fDecoder->getDSPSize()));
             allocatemydsp(fDSP);
         }
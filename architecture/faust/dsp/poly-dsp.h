@@ -34,19 +34,43 @@
 #include <limits.h>
 #include <float.h>
 #include <assert.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 #include "faust/midi/midi.h"
 #include "faust/dsp/dsp-combiner.h"
 #include "faust/gui/GUI.h"
 #include "faust/gui/MapUI.h"
 #include "faust/dsp/proxy-dsp.h"
+#include "faust/dsp/timed-dsp.h"
+#include "faust/gui/mpmc-ring-buffer.h"
 
 #define kActiveVoice      0
 #define kFreeVoice        -1
 #define kReleaseVoice     -2
 #define kNoVoice          -3
 
+#define kFreeList         0
+#define kPlayingList      1
+#define kSleepingList     2
+#define kReleaseList      3
+#define kNoList           -1
+
+#define kStateLink        0
+#define kPitchLink        1
+
+#define MIDI_PITCHES      128
+
+#define kKeyOnEvent       0
+#define kKeyOffEvent      1
+#define kAllNotesOffEvent 2
+#define kNewVoiceEvent    3
+
+#define MAX_BLOCK_EVENTS  256       // Maximum number of note events handled in a block
+
 #define VOICE_STOP_LEVEL  0.0005    // -70 db
+#define VOICE_SCAN_CHUNK  64        // Samples tested at once by 'isSilent'
 #define MIX_BUFFER_SIZE   4096
 
 // endsWith(<str>,<end>) : returns true if <str> ends with <end>
@@ -56,6 +80,26 @@ static double midiToFreq(double note)
     return 440.0 * std::pow(2.0, (note-69.0)/12.0);
 }
 
+// isSilent(<count>,<buffers>,<channels>,<level>) : returns true if all samples are below <level> in absolute value.
+// Each chunk is tested with a branchless (vectorizable) loop and the scan stops at the first non silent chunk,
+// so that audible blocks are usually rejected after the first chunk.
+
+static bool isSilent(int count, FAUSTFLOAT** buffers, int channels, FAUSTFLOAT level)
+{
+    for (int chan = 0; chan < channels; chan++) {
+        FAUSTFLOAT* buffer = buffers[chan];
+        for (int i = 0; i < count; i += VOICE_SCAN_CHUNK) {
+            int end = std::min<int>(count, i + VOICE_SCAN_CHUNK);
+            int above = 0;
+            for (int j = i; j < end; j++) {
+                above |= (buffer[j] > level) | (buffer[j] < -level);
+            }
+            if (above) return false;
+        }
+    }
+    return true;
+}
+
 /**
  * Allows to control zones in a grouped manner.
  */
@@ -148,6 +192,15 @@ class GroupUI : public GUI, public PathBuilder
 
 };
 
+struct dsp_voice;
+
+// Links of a voice in an intrusive list
+struct voice_link {
+    dsp_voice* fPrev;
+    dsp_voice* fNext;
+    voice_link():fPrev(0), fNext(0) {}
+};
+
 /**
  * One voice of polyphony.
  */
@@ -156,21 +209,67 @@ struct dsp_voice : public MapUI, public decorator_dsp {
 
     int fNote;                          // Playing note actual pitch
     int fDate;                          // KeyOn date
-    FAUSTFLOAT fLevel;                  // Last audio block level
+    bool fSleeping;                     // Playing but silent voice, not rendered anymore
+    int fSilentBlocks;                  // Number of consecutive silent blocks
+    long fRenderedBlocks;               // Statistics: rendered blocks
+    long fSilentRenders;                // Statistics: rendered but silent blocks
+    long fSkippedBlocks;                // Statistics: blocks skipped while sleeping
+    FAUSTFLOAT fLevel;                  // Last audio block level (only tracked when needed by the stealing policy)
+    int fPriority;                      // Stealing priority (MIDI velocity by default)
+    voice_link fLinks[2];               // Links in the state list and in the pitch list (owned by mydsp_poly)
+    int fList;                          // Current state list
+    int fPitch;                         // Current pitch list, or kNoVoice
+    int fEvents;                        // Number of note events in the current block
+    bool fReserved;                     // Free voice handed to the control threads (see mydsp_poly::reserveVoices)
+    FAUSTFLOAT** fInputsSlice;
+    FAUSTFLOAT** fOutputsSlice;
     std::vector<std::string> fGatePath; // Paths of 'gate' control
     std::vector<std::string> fGainPath; // Paths of 'gain' control
     std::vector<std::string> fFreqPath; // Paths of 'freq' control
+    std::vector<FAUSTFLOAT*> fGateZones; // Resolved zones of 'gate' control
+    std::vector<FAUSTFLOAT*> fGainZones; // Resolved zones of 'gain' control
+    std::vector<FAUSTFLOAT*> fFreqZones; // Resolved zones of 'freq' control
  
     dsp_voice(dsp* dsp):decorator_dsp(dsp)
     {
         dsp->buildUserInterface(this);
         fNote = kFreeVoice;
-        fLevel = FAUSTFLOAT(0);
         fDate = 0;
+        fLevel = FAUSTFLOAT(0);
+        fPriority = 0;
+        fList = kNoList;
+        fPitch = kNoVoice;
+        fEvents = 0;
+        fReserved = false;
+        fInputsSlice = new FAUSTFLOAT*[dsp->getNumInputs()];
+        fOutputsSlice = new FAUSTFLOAT*[dsp->getNumOutputs()];
+        wakeUp();
+        resetStats();
         extractPaths(fGatePath, fFreqPath, fGainPath);
+        resolvePaths(fGatePath, fGateZones);
+        resolvePaths(fFreqPath, fFreqZones);
+        resolvePaths(fGainPath, fGainZones);
     }
     virtual ~dsp_voice()
-    {}
+    {
+        delete [] fInputsSlice;
+        delete [] fOutputsSlice;
+    }
+
+    // Compute (or clear if 'silent') a slice of the output buffers
+    void computeSlice(int offset, int slice, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs, bool silent)
+    {
+        if (slice > 0) {
+            for (int chan = 0; chan < fDSP->getNumInputs(); chan++) {
+                fInputsSlice[chan] = &(inputs[chan][offset]);
+            }
+            for (int chan = 0; chan < fDSP->getNumOutputs(); chan++) {
+                fOutputsSlice[chan] = &(outputs[chan][offset]);
+                if (silent) memset(fOutputsSlice[chan], 0, slice * sizeof(FAUSTFLOAT));
+            }
+            if (!silent) fDSP->compute(slice, fInputsSlice, fOutputsSlice);
+        }
+    }
 
     void extractPaths(std::vector<std::string>& gate, std::vector<std::string>& freq, std::vector<std::string>& gain)
     {
@@ -188,6 +287,31 @@ struct dsp_voice : public MapUI, public decorator_dsp {
         }
     }
 
+    void resolvePaths(const std::vector<std::string>& paths, std::vector<FAUSTFLOAT*>& zones)
+    {
+        for (size_t i = 0; i < paths.size(); i++) {
+            zones.push_back(getParamHandle(paths[i]));
+        }
+    }
+
+    static void setZones(const std::vector<FAUSTFLOAT*>& zones, FAUSTFLOAT value)
+    {
+        for (size_t i = 0; i < zones.size(); i++) {
+            *zones[i] = value;
+        }
+    }
+
+    void wakeUp()
+    {
+        fSleeping = false;
+        fSilentBlocks = 0;
+    }
+
+    void resetStats()
+    {
+        fRenderedBlocks = fSilentRenders = fSkippedBlocks = 0;
+    }
+
     // MIDI velocity [0..127]
     void keyOn(int pitch, int velocity, bool trigger)
     {
@@ -197,25 +321,19 @@ struct dsp_voice : public MapUI, public decorator_dsp {
     // Normalized MIDI velocity [0..1]
     void keyOn(int pitch, float velocity, bool trigger)
     {
-        for (size_t i = 0; i < fFreqPath.size(); i++) {
-            setParamValue(fFreqPath[i], midiToFreq(pitch));
-        }
-        for (size_t i = 0; i < fGatePath.size(); i++) {
-            setParamValue(fGatePath[i], FAUSTFLOAT(1));
-        }
-        for (size_t i = 0; i < fGainPath.size(); i++) {
-            setParamValue(fGainPath[i], velocity);
-        }
+        setZones(fFreqZones, midiToFreq(pitch));
+        setZones(fGateZones, FAUSTFLOAT(1));
+        setZones(fGainZones, velocity);
         
         fNote = pitch;
+        fPriority = int(velocity * 127.f);
+        wakeUp();
     }
 
     void keyOff(bool hard = false)
     {
         // No use of velocity for now...
-        for (size_t i = 0; i < fGatePath.size(); i++) {
-            setParamValue(fGatePath[i], FAUSTFLOAT(0));
-        }
+        setZones(fGateZones, FAUSTFLOAT(0));
         
         if (hard) {
             // Immediately stop voice
@@ -224,10 +342,150 @@ struct dsp_voice : public MapUI, public decorator_dsp {
             // Release voice
             fNote = kReleaseVoice;
         }
+        wakeUp();
     }
 
 };
 
+// Note event, sent by the control threads to the audio thread
+struct voice_event {
+    double fDate;       // Date in usec, or in frames (see mydsp_poly::compute)
+    bool fTimed;        // If false, the event is applied at the beginning of the next block
+    int fType;          // kKeyOnEvent, kKeyOffEvent, kAllNotesOffEvent or kNewVoiceEvent
+    int fPitch;
+    int fVelocity;      // Or 'hard' for kAllNotesOffEvent
+    int fOffset;        // Offset in frames in the current block
+    dsp_voice* fVoice;  // Voice the event is applied on (0 to be found by the audio thread)
+    bool fSilent;       // Whether the voice was silent before a keyOn event
+};
+
+/**
+ * Intrusive doubly linked list of voices, using the voice 'fLinks[LINK]' field,
+ * so that voices can be added and removed in constant time without any allocation.
+ */
+
+template <int LINK>
+struct voice_list {
+
+    dsp_voice* fHead;
+    dsp_voice* fTail;
+    int fSize;
+
+    voice_list():fHead(0), fTail(0), fSize(0) {}
+
+    static dsp_voice* next(dsp_voice* voice) { return voice->fLinks[LINK].fNext; }
+
+    void push_back(dsp_voice* voice)
+    {
+        voice_link& link = voice->fLinks[LINK];
+        link.fPrev = fTail;
+        link.fNext = 0;
+        if (fTail) {
+            fTail->fLinks[LINK].fNext = voice;
+        } else {
+            fHead = voice;
+        }
+        fTail = voice;
+        fSize++;
+    }
+
+    void remove(dsp_voice* voice)
+    {
+        voice_link& link = voice->fLinks[LINK];
+        if (link.fPrev) {
+            link.fPrev->fLinks[LINK].fNext = link.fNext;
+        } else {
+            fHead = link.fNext;
+        }
+        if (link.fNext) {
+            link.fNext->fLinks[LINK].fPrev = link.fPrev;
+        } else {
+            fTail = link.fPrev;
+        }
+        link.fPrev = link.fNext = 0;
+        fSize--;
+    }
+
+};
+
+typedef voice_list<kStateLink> voice_state_list;
+
+/**
+ * Voice stealing policy, used when a note has to be played and no free or sleeping voice is available.
+ * Released voices are kept in release order, and playing voices in keyOn order (oldest first).
+ * Policies are called on the real-time thread, so they must not allocate memory or do any I/O.
+ */
+
+struct voice_stealing_policy {
+
+    virtual ~voice_stealing_policy() {}
+
+    // Returns the voice to steal, 'released' and 'playing' lists cannot be both empty
+    virtual dsp_voice* stealVoice(const voice_state_list& released, const voice_state_list& playing) = 0;
+
+    // Whether the voices block level has to be computed (see dsp_voice::fLevel)
+    virtual bool needLevel() { return false; }
+
+    virtual voice_stealing_policy* clone() = 0;
+
+};
+
+// Steal the oldest released voice, otherwise the oldest playing voice (in constant time)
+struct oldest_voice_policy : public voice_stealing_policy {
+
+    dsp_voice* stealVoice(const voice_state_list& released, const voice_state_list& playing)
+    {
+        return (released.fHead) ? released.fHead : playing.fHead;
+    }
+
+    voice_stealing_policy* clone() { return new oldest_voice_policy(); }
+
+};
+
+// Steal the voice with the lowest level in the last rendered block, released voices first
+struct quietest_voice_policy : public voice_stealing_policy {
+
+    static dsp_voice* quietest(const voice_state_list& list)
+    {
+        dsp_voice* res = list.fHead;
+        for (dsp_voice* voice = list.fHead; voice; voice = voice_state_list::next(voice)) {
+            if (voice->fLevel < res->fLevel) res = voice;
+        }
+        return res;
+    }
+
+    dsp_voice* stealVoice(const voice_state_list& released, const voice_state_list& playing)
+    {
+        return (released.fHead) ? quietest(released) : quietest(playing);
+    }
+
+    bool needLevel() { return true; }
+
+    voice_stealing_policy* clone() { return new quietest_voice_policy(); }
+
+};
+
+// Steal the voice with the lowest priority (the oldest one for equal priorities), released voices first
+struct priority_voice_policy : public voice_stealing_policy {
+
+    static dsp_voice* lowest(const voice_state_list& list)
+    {
+        dsp_voice* res = list.fHead;
+        for (dsp_voice* voice = list.fHead; voice; voice = voice_state_list::next(voice)) {
+            if (voice->fPriority < res->fPriority) res = voice;
+        }
+        return res;
+    }
+
+    dsp_voice* stealVoice(const voice_state_list& released, const voice_state_list& playing)
+    {
+        return (released.fHead) ? lowest(released) : lowest(playing);
+    }
+
+    voice_stealing_policy* clone() { return new priority_voice_policy(); }
+
+};
+
 /**
  * A group of voices.
  */
@@ -308,6 +566,88 @@ struct dsp_voice_group {
 
 };
 
+/**
+ * A pool of persistent threads used to render voices in parallel.
+ *
+ * The calling (audio) thread is used as worker 0. A job is started by incrementing
+ * a generation counter, and its completion is detected with an atomic counter,
+ * so that no lock is taken and no memory is allocated in the audio thread.
+ * Idle workers spin (yielding the CPU) for a while after each job, then sleep
+ * by small steps until the next one.
+ */
+
+typedef void (*voice_job)(int worker, void* arg);
+
+#define WORKER_SPIN_COUNT   20000
+#define WORKER_SLEEP_USEC   100
+
+class voice_worker_pool {
+
+    private:
+
+        std::vector<std::thread*> fThreads;
+        std::atomic<int> fGeneration;
+        std::atomic<int> fDone;
+        std::atomic<bool> fRunning;
+        voice_job fJob;
+        void* fArg;
+
+        static void runWorker(voice_worker_pool* pool, int worker)
+        {
+            int generation = 0;
+            while (true) {
+                // Wait for the next job
+                int spin = 0;
+                while (pool->fGeneration.load(std::memory_order_acquire) == generation) {
+                    if (!pool->fRunning.load(std::memory_order_relaxed)) return;
+                    if (++spin < WORKER_SPIN_COUNT) {
+                        std::this_thread::yield();
+                    } else {
+                        std::this_thread::sleep_for(std::chrono::microseconds(WORKER_SLEEP_USEC));
+                    }
+                }
+                generation++;
+                pool->fJob(worker, pool->fArg);
+                pool->fDone.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+    public:
+
+        voice_worker_pool(int workers):fGeneration(0), fDone(0), fRunning(true), fJob(0), fArg(0)
+        {
+            for (int i = 1; i < workers; i++) {
+                fThreads.push_back(new std::thread(runWorker, this, i));
+            }
+        }
+
+        virtual ~voice_worker_pool()
+        {
+            fRunning = false;
+            for (size_t i = 0; i < fThreads.size(); i++) {
+                fThreads[i]->join();
+                delete fThreads[i];
+            }
+        }
+
+        // Number of workers, including the calling thread
+        int size() { return int(fThreads.size()) + 1; }
+
+        // Run 'job' on all workers and return when all of them are done
+        void run(voice_job job, void* arg)
+        {
+            fJob = job;
+            fArg = arg;
+            fDone.store(0, std::memory_order_relaxed);
+            fGeneration.fetch_add(1, std::memory_order_release);
+            job(0, arg);
+            while (fDone.load(std::memory_order_acquire) < int(fThreads.size())) {
+                std::this_thread::yield();
+            }
+        }
+
+};
+
 /**
  * Base class for MIDI controllable DSP.
  */
@@ -331,7 +671,34 @@ class dsp_poly : public decorator_dsp, public midi {
  * Polyphonic DSP: groups a set of DSP to be played together or triggered by MIDI.
  *
  * All voices are preallocated by cloning the single DSP voice given at creation time.
- * Dynamic voice allocation is done in 'getFreeVoice'
+ * Dynamic voice allocation is done in 'allocVoice': voices are kept in intrusive free, playing,
+ * sleeping and release lists, and indexed by pitch, so that keyOn/keyOff are done in constant time
+ * without any allocation. When no free voice is available, a voice is stolen using
+ * a pluggable policy (see 'setStealingPolicy').
+ *
+ * The voice lists are only modified by the audio thread. The note methods (keyOn, keyOff, allNotesOff,
+ * newVoice, deleteVoice) called by the control (MIDI, UI...) threads push events in a lock-free queue,
+ * applied by the audio thread at the beginning of the next block (see 'prepareEvents'). So that keyOn
+ * and newVoice always return a voice, the audio thread hands its free voices to the control threads
+ * in a second queue (see 'reserveVoices'), and publishes the voice to steal when none is left
+ * (see 'offerStealVoice'). Both queues accept several producers and consumers without any lock,
+ * so that the note methods can also be called from the audio thread (like JACK MIDI does).
+ * The last cell of the events queue is kept for releases, so that keyOff and allNotesOff events
+ * are never dropped (see 'pushEvent').
+ *
+ * Voices that stay silent while playing can be put to sleep (see 'setVoiceSleep'): they are
+ * not rendered anymore until the next keyOn/keyOff, so that the cost is proportional to the
+ * audible voices only.
+ *
+ * Note events can be timestamped (see 'setTimeStamp'): they are then queued and applied at their
+ * exact offset in the next block. Only the voices receiving an event are rendered by slices
+ * (like timed_dsp::computeSlice), all other voices are still rendered with a single 'compute' call.
+ *
+ * Voices can be rendered in parallel on a pool of worker threads (see 'setParallel').
+ * Active voices are then statically partitioned in contiguous slices, each worker
+ * mixing its slice in its own buffer, and the worker buffers are finally summed in
+ * a fixed order (each worker handling a part of the samples), so that the output
+ * does not depend on threads scheduling.
  */
 
 class mydsp_poly : public dsp_voice_group, public dsp_poly {
@@ -340,19 +707,46 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
 
         FAUSTFLOAT** fMixBuffer;
         int fDate;
-
-        FAUSTFLOAT mixVoice(int count, FAUSTFLOAT** outputBuffer, FAUSTFLOAT** mixBuffer)
+        int fSleepBlocks;   // Number of silent blocks before a playing voice sleeps (0 = never)
+
+        // Voice allocation
+        voice_state_list fVoiceLists[4];                // Free, playing, sleeping and release voices
+        voice_list<kPitchLink> fPitchLists[MIDI_PITCHES];  // Playing and sleeping voices, by pitch
+        voice_stealing_policy* fStealingPolicy;
+        bool fTrackLevel;
+        long fStolenVoices;
+
+        // Note events
+        bool fTimeStamp;
+        mpmc_ring_buffer<voice_event> fEventsQueue;     // Written by the control threads, read by the audio thread
+        mpmc_ring_buffer<dsp_voice*> fFreeVoices;       // Reserved free voices, written by the audio thread
+        std::atomic<dsp_voice*> fStealVoice;            // Voice to steal when no free voice is reserved
+        std::atomic<dsp_voice*> fLastVoice;             // Voice returned by the last keyOn or newVoice
+        std::atomic<bool> fHardNotesOff;                // A hard allNotesOff was coalesced in a queued one
+        voice_event fBlockEvents[MAX_BLOCK_EVENTS];     // Events applied in the current block
+        int fBlockEventsCount;
+        double fDateUsec;                               // Compute call date in usec
+        double fOffsetUsec;                             // Compute call offset in usec
+        bool fFirstCallback;
+
+        // Parallel rendering
+        voice_worker_pool* fWorkers;
+        std::vector<dsp_voice*> fActiveVoices;      // Voices rendered in the current block
+        std::vector<FAUSTFLOAT**> fWorkerVoice;     // Voice output buffers, one per worker
+        std::vector<FAUSTFLOAT**> fWorkerMix;       // Mix buffers, one per worker
+        int fCount;
+        FAUSTFLOAT** fInputs;
+        FAUSTFLOAT** fOutputs;
+
+        void mixVoice(int count, FAUSTFLOAT** outputBuffer, FAUSTFLOAT** mixBuffer)
         {
-            FAUSTFLOAT level = 0;
             for (int i = 0; i < getNumOutputs(); i++) {
                 FAUSTFLOAT* mixChannel = mixBuffer[i];
                 FAUSTFLOAT* outChannel = outputBuffer[i];
                 for (int j = 0; j < count; j++) {
-                    level = std::max<FAUSTFLOAT>(level, (FAUSTFLOAT)fabs(outChannel[j]));
                     mixChannel[j] += outChannel[j];
                 }
             }
-            return level;
         }
 
         void clearOutput(int count, FAUSTFLOAT** mixBuffer)
@@ -361,84 +755,391 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
                 memset(mixBuffer[i], 0, count * sizeof(FAUSTFLOAT));
             }
         }
-    
-        int getPlayingVoice(int pitch)
+
+        FAUSTFLOAT** allocBuffers()
         {
-            int voice_playing = kNoVoice;
-            int oldest_date_playing = INT_MAX;
+            FAUSTFLOAT** buffers = new FAUSTFLOAT*[getNumOutputs()];
+            for (int i = 0; i < getNumOutputs(); i++) {
+                buffers[i] = new FAUSTFLOAT[MIX_BUFFER_SIZE];
+            }
+            return buffers;
+        }
+
+        void deleteBuffers(FAUSTFLOAT** buffers)
+        {
+            for (int i = 0; i < getNumOutputs(); i++) {
+                delete[] buffers[i];
+            }
+            delete[] buffers;
+        }
+
+        FAUSTFLOAT levelVoice(int count, FAUSTFLOAT** outputBuffer)
+        {
+            FAUSTFLOAT level = 0;
+            for (int i = 0; i < getNumOutputs(); i++) {
+                FAUSTFLOAT* outChannel = outputBuffer[i];
+                for (int j = 0; j < count; j++) {
+                    level = std::max<FAUSTFLOAT>(level, (FAUSTFLOAT)fabs(outChannel[j]));
+                }
+            }
+            return level;
+        }
+
+        // Render the voice in 'mixBuffer', its state may change but voices lists are updated later by 'updateVoice'
+        // Compute the voice by slices, applying its timestamped events in between
+        void computeTimedVoice(dsp_voice* voice, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** voiceBuffer)
+        {
+            int offset = 0;
+            bool first = true;
+            for (int i = 0; i < fBlockEventsCount; i++) {
+                voice_event& event = fBlockEvents[i];
+                if (event.fVoice != voice) continue;
+                // A free or sleeping voice is silent until its first keyOn
+                voice->computeSlice(offset, event.fOffset - offset, inputs, voiceBuffer, first && event.fSilent);
+                offset = event.fOffset;
+                first = false;
+                if (event.fType == kKeyOnEvent) {
+                    // So that envelop is always re-initialized
+                    voice->instanceClear();
+                    voice->keyOn(event.fPitch, event.fVelocity, true);
+                } else {
+                    voice->keyOff();
+                }
+            }
+            voice->computeSlice(offset, count - offset, inputs, voiceBuffer, false);
+            voice->fEvents = 0;
+        }
+
+        void renderVoice(dsp_voice* voice, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** voiceBuffer, FAUSTFLOAT** mixBuffer)
+        {
+            if (voice->fEvents > 0) {
+                computeTimedVoice(voice, count, inputs, voiceBuffer);
+            } else {
+                voice->compute(count, inputs, voiceBuffer);
+            }
+            voice->fRenderedBlocks++;
+            // Mix it in result
+            mixVoice(count, voiceBuffer, mixBuffer);
+            if (!fVoiceControl) return;
+            if (fTrackLevel) {
+                voice->fLevel = levelVoice(count, voiceBuffer);
+            }
             
-            for (size_t i = 0; i < fVoiceTable.size(); i++) {
-                if (fVoiceTable[i]->fNote == pitch) {
-                    // Keeps oldest playing voice
-                    if (fVoiceTable[i]->fDate < oldest_date_playing) {
-                        oldest_date_playing = fVoiceTable[i]->fDate;
-                        voice_playing = int(i);
+            // Check the level to possibly set the voice in kFreeVoice again, or put it to sleep
+            if (isSilent(count, voiceBuffer, getNumOutputs(), FAUSTFLOAT(VOICE_STOP_LEVEL))) {
+                voice->fSilentRenders++;
+                if (voice->fNote == kReleaseVoice) {
+                    voice->fNote = kFreeVoice;
+                } else if (fSleepBlocks > 0 && ++voice->fSilentBlocks >= fSleepBlocks) {
+                    voice->fSleeping = true;
+                }
+            } else {
+                voice->fSilentBlocks = 0;
+            }
+        }
+
+        // Render a contiguous slice of the active voices in the worker mix buffer
+        static void renderJob(int worker, void* arg)
+        {
+            mydsp_poly* poly = static_cast<mydsp_poly*>(arg);
+            int voices = int(poly->fActiveVoices.size());
+            int workers = poly->fWorkers->size();
+            poly->clearOutput(poly->fCount, poly->fWorkerMix[worker]);
+            for (int i = worker * voices / workers; i < (worker + 1) * voices / workers; i++) {
+                poly->renderVoice(poly->fActiveVoices[i], poly->fCount, poly->fInputs,
+                                  poly->fWorkerVoice[worker], poly->fWorkerMix[worker]);
+            }
+        }
+
+        // Sum the worker mix buffers (in a fixed order) on a slice of the outputs
+        static void reduceJob(int worker, void* arg)
+        {
+            mydsp_poly* poly = static_cast<mydsp_poly*>(arg);
+            int workers = poly->fWorkers->size();
+            int begin = worker * poly->fCount / workers;
+            int end = (worker + 1) * poly->fCount / workers;
+            for (int chan = 0; chan < poly->getNumOutputs(); chan++) {
+                FAUSTFLOAT* out = poly->fOutputs[chan];
+                for (int j = begin; j < end; j++) {
+                    FAUSTFLOAT sum = poly->fWorkerMix[0][chan][j];
+                    for (int w = 1; w < workers; w++) {
+                        sum += poly->fWorkerMix[w][chan][j];
                     }
+                    out[j] = sum;
                 }
             }
-            
-            return voice_playing;
+        }
+
+        void computeParallel(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            fCount = count;
+            fInputs = inputs;
+            fOutputs = outputs;
+            fWorkers->run(renderJob, this);
+            fWorkers->run(reduceJob, this);
         }
     
-        // Always returns a voice
-        int getFreeVoice()
+        static int stateList(dsp_voice* voice)
         {
-            int voice = kNoVoice;
+            if (voice->fNote == kFreeVoice) {
+                return kFreeList;
+            } else if (voice->fNote == kReleaseVoice) {
+                return kReleaseList;
+            } else if (voice->fSleeping) {
+                return kSleepingList;
+            } else {
+                return kPlayingList;
+            }
+        }
+
+        // Move the voice in the state and pitch lists matching its current state (in constant time)
+        void updateVoice(dsp_voice* voice)
+        {
+            int list = stateList(voice);
+            if (list != voice->fList) {
+                if (voice->fList != kNoList) fVoiceLists[voice->fList].remove(voice);
+                fVoiceLists[list].push_back(voice);
+                voice->fList = list;
+            }
+            int pitch = (voice->fNote >= 0 && voice->fNote < MIDI_PITCHES) ? voice->fNote : kNoVoice;
+            if (pitch != voice->fPitch) {
+                if (voice->fPitch != kNoVoice) fPitchLists[voice->fPitch].remove(voice);
+                if (pitch != kNoVoice) fPitchLists[pitch].push_back(voice);
+                voice->fPitch = pitch;
+            }
+        }
+
+        // Returns the oldest voice playing 'pitch', or 0
+        dsp_voice* getPlayingVoice(int pitch)
+        {
+            if (pitch >= 0 && pitch < MIDI_PITCHES) {
+                return fPitchLists[pitch].fHead;
+            }
             
-            // Looks for the first available voice
+            // Pitches outside of the MIDI range are not indexed
+            dsp_voice* voice_playing = 0;
             for (size_t i = 0; i < fVoiceTable.size(); i++) {
-                if (fVoiceTable[i]->fNote == kFreeVoice) {
-                    voice = int(i);
-                    goto result;
+                if (fVoiceTable[i]->fNote == pitch && (!voice_playing || fVoiceTable[i]->fDate < voice_playing->fDate)) {
+                    voice_playing = fVoiceTable[i];
                 }
             }
+            return voice_playing;
+        }
+    
+        // Always returns a voice: a free one, a sleeping one (which is silent anyway), or a stolen one.
+        // Only voices state is updated, the voice DSP is not cleared.
+        dsp_voice* allocVoice()
+        {
+            dsp_voice* voice = fVoiceLists[kFreeList].fHead;
+            if (!voice) {
+                voice = fVoiceLists[kSleepingList].fHead;
+            }
+            if (!voice) {
+                voice = fStealingPolicy->stealVoice(fVoiceLists[kReleaseList], fVoiceLists[kPlayingList]);
+                fStolenVoices++;
+            }
+            assert(voice);
+            startVoice(voice);
+            return voice;
+        }
 
-            {
-                // Otherwise steal one
-                int voice_release = kNoVoice;
-                int voice_playing = kNoVoice;
-                
-                int oldest_date_release = INT_MAX;
-                int oldest_date_playing = INT_MAX;
+        // Make a free, sleeping, stolen or reserved voice active
+        void startVoice(dsp_voice* voice)
+        {
+            voice->fReserved = false;
+            voice->fDate = fDate++;
+            voice->fNote = kActiveVoice;
+            voice->wakeUp();
+            updateVoice(voice);
+        }
 
-                // Scan all voices
-                for (size_t i = 0; i < fVoiceTable.size(); i++) {
-                    if (fVoiceTable[i]->fNote == kReleaseVoice) {
-                        // Keeps oldest release voice
-                        if (fVoiceTable[i]->fDate < oldest_date_release) {
-                            oldest_date_release = fVoiceTable[i]->fDate;
-                            voice_release = int(i);
-                        }
+        // Hand the free voices to the control threads, so that keyOn and newVoice can return them
+        void reserveVoices()
+        {
+            dsp_voice* voice;
+            while ((voice = fVoiceLists[kFreeList].fHead)) {
+                voice->fReserved = true;
+                if (!fFreeVoices.push(voice)) {
+                    voice->fReserved = false;
+                    break;
+                }
+                fVoiceLists[kFreeList].remove(voice);
+                voice->fList = kNoList;
+            }
+        }
+
+        // When all voices are busy, publish the one 'allocVoice' would take, so that keyOn can return it
+        void offerStealVoice()
+        {
+            dsp_voice* voice = 0;
+            if (!fVoiceLists[kFreeList].fHead) {
+                voice = fVoiceLists[kSleepingList].fHead;
+                if (!voice && (fVoiceLists[kReleaseList].fHead || fVoiceLists[kPlayingList].fHead)) {
+                    voice = fStealingPolicy->stealVoice(fVoiceLists[kReleaseList], fVoiceLists[kPlayingList]);
+                }
+            }
+            fStealVoice.store(voice, std::memory_order_release);
+        }
+
+        double convertUsecToSample(double usec)
+        {
+            return std::max<double>(0., (double(getSampleRate()) * (usec - fDateUsec)) / 1000000.);
+        }
+
+        // Read the queued note events, allocate their voices and compute their offset in the block
+        void prepareEvents(int count, bool convert_ts)
+        {
+            fBlockEventsCount = 0;
+            int offset = 0;
+            voice_event* front;
+            while (fBlockEventsCount < MAX_BLOCK_EVENTS && (front = fEventsQueue.front())) {
+                voice_event event = *front;
+                if (event.fType == kAllNotesOffEvent) {
+                    // Applied at the beginning of a block, so after the events queued before it
+                    if (fBlockEventsCount > 0) break;
+                    fEventsQueue.read_advance();
+                    bool hard = (event.fVelocity != 0) | fHardNotesOff.exchange(false, std::memory_order_acquire);
+                    for (size_t i = 0; i < fVoiceTable.size(); i++) {
+                        dsp_voice* voice = fVoiceTable[i];
+                        if (voice->fReserved) continue;
+                        voice->keyOff(hard);
+                        updateVoice(voice);
+                    }
+                    continue;
+                }
+                fEventsQueue.read_advance();
+                if (event.fType == kNewVoiceEvent) {
+                    // So that envelop is always re-initialized
+                    event.fVoice->instanceClear();
+                    if (!event.fVoice->fReserved && event.fVoice->fList != kFreeList) fStolenVoices++;
+                    startVoice(event.fVoice);
+                    continue;
+                }
+                // Events are kept in order, and late events are applied at the end of the block
+                if (event.fTimed) {
+                    double date = (convert_ts) ? convertUsecToSample(event.fDate) : event.fDate;
+                    event.fOffset = std::max<int>(offset, std::min<int>(count - 1, int(date)));
+                } else {
+                    event.fOffset = offset;
+                }
+                if (event.fType == kKeyOnEvent) {
+                    if (event.fVoice) {
+                        // A reserved free voice, or a voice to steal (see 'takeVoice')
+                        dsp_voice* voice = event.fVoice;
+                        event.fSilent = voice->fReserved || voice->fList == kFreeList || voice->fList == kSleepingList;
+                        if (!event.fSilent) fStolenVoices++;
+                        startVoice(voice);
                     } else {
-                        // Otherwise keeps oldest playing voice
-                        if (fVoiceTable[i]->fDate < oldest_date_playing) {
-                            oldest_date_playing = fVoiceTable[i]->fDate;
-                            voice_playing = int(i);
-                        }
+                        event.fSilent = fVoiceLists[kFreeList].fHead || fVoiceLists[kSleepingList].fHead;
+                        event.fVoice = allocVoice();
                     }
+                    event.fVoice->fNote = event.fPitch;
+                } else {
+                    if (!event.fVoice) event.fVoice = getPlayingVoice(event.fPitch);
+                    if (!event.fVoice || event.fVoice->fReserved) continue;
+                    event.fVoice->fNote = kReleaseVoice;
                 }
+                updateVoice(event.fVoice);
+                event.fVoice->fEvents++;
+                fBlockEvents[fBlockEventsCount++] = event;
+                offset = event.fOffset;
+            }
+            reserveVoices();
+            offerStealVoice();
+        }
+
+        // The voice of a keyOn or newVoice event: a reserved free voice, otherwise the voice to steal,
+        // otherwise (when several notes are started in the same block) the last returned voice is stolen
+        dsp_voice* takeVoice()
+        {
+            dsp_voice* voice = 0;
+            if (!fFreeVoices.pop(voice)) {
+                voice = fStealVoice.exchange(0, std::memory_order_acquire);
+                if (!voice) voice = fLastVoice.load(std::memory_order_relaxed);
+            }
+            fLastVoice.store(voice, std::memory_order_relaxed);
+            return voice;
+        }
+
+        /*
+         Push a note event (called by the control threads, or by the audio thread before 'compute').
+         A keyOn or newVoice event is given its voice by 'takeVoice', which is returned to the caller.
+         The last cell of the queue is kept for an allNotesOff event: when the queue is that full, a keyOff
+         event is coalesced in a (soft) allNotesOff one, and when the queue is completely full, its last event
+         is such an allNotesOff one, which already releases the note. So releases are never dropped, only
+         keyOn and newVoice events are (they then still return the last started voice).
+        */
+        dsp_voice* pushEvent(int type, double date, bool timed, int pitch, int velocity, dsp_voice* voice = 0)
+        {
+            size_t index;
+            voice_event* event = fEventsQueue.write_claim(index, (type == kAllNotesOffEvent) ? 0 : 1);
+            if (!event && type == kKeyOffEvent) {
+                type = kAllNotesOffEvent;
+                velocity = 0;
+                voice = 0;
+                event = fEventsQueue.write_claim(index);
+            }
+            if (!event) {
+                if (type == kAllNotesOffEvent) {
+                    if (velocity != 0) fHardNotesOff.store(true, std::memory_order_release);
+                    return 0;
+                }
+                return fLastVoice.load(std::memory_order_relaxed);
+            }
+            if (type == kKeyOnEvent || type == kNewVoiceEvent) {
+                voice = takeVoice();
+            }
+            event->fDate = date;
+            event->fTimed = timed;
+            event->fType = type;
+            event->fPitch = pitch;
+            event->fVelocity = velocity;
+            event->fOffset = 0;
+            event->fVoice = voice;
+            event->fSilent = false;
+            fEventsQueue.write_commit(index);
+            return voice;
+        }
+
+        void computeVoices(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            assert(count <= MIX_BUFFER_SIZE);
+
+            // Collect voices to be rendered (all playing and awake voices, or all voices)
+            fActiveVoices.clear();
+            if (fVoiceControl) {
+                for (dsp_voice* voice = fVoiceLists[kPlayingList].fHead; voice; voice = voice_state_list::next(voice)) {
+                    fActiveVoices.push_back(voice);
+                }
+                for (dsp_voice* voice = fVoiceLists[kReleaseList].fHead; voice; voice = voice_state_list::next(voice)) {
+                    fActiveVoices.push_back(voice);
+                }
+                for (dsp_voice* voice = fVoiceLists[kSleepingList].fHead; voice; voice = voice_state_list::next(voice)) {
+                    voice->fSkippedBlocks++;
+                }
+            } else {
+                fActiveVoices = fVoiceTable;
+            }
             
-                // Then decide which one to steal
-                if (oldest_date_release != INT_MAX) {
-                    std::cout << "Steal release voice : voice_date " << fVoiceTable[voice_release]->fDate << " cur_date = " << fDate << " voice = " << voice_release << std::endl;
-                    voice = voice_release;
-                    goto result;
-                } else if (oldest_date_playing != INT_MAX) {
-                    std::cout << "Steal playing voice : voice_date " << fVoiceTable[voice_playing]->fDate << " cur_date = " << fDate << " voice = " << voice_playing << std::endl;
-                    voice = voice_playing;
-                    goto result;
-                } else {
-                    assert(false);
-                    return kNoVoice;
+            if (fWorkers && fActiveVoices.size() > 1) {
+                computeParallel(count, inputs, outputs);
+            } else {
+                // First clear the outputs
+                clearOutput(count, outputs);
+                
+                // Mix all collected voices
+                for (size_t i = 0; i < fActiveVoices.size(); i++) {
+                    renderVoice(fActiveVoices[i], count, inputs, fMixBuffer, outputs);
                 }
             }
             
-        result:
-            // So that envelop is always re-initialized
-            fVoiceTable[voice]->instanceClear();
-            fVoiceTable[voice]->fDate = fDate++;
-            fVoiceTable[voice]->fNote = kActiveVoice;
-            return voice;
+            // Voices may have been released or put to sleep
+            if (fVoiceControl) {
+                for (size_t i = 0; i < fActiveVoices.size(); i++) {
+                    updateVoice(fActiveVoices[i]);
+                }
+            }
+            fBlockEventsCount = 0;
         }
 
         static void panic(FAUSTFLOAT val, void* arg)
@@ -477,31 +1178,150 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
                    int nvoices,
                    bool control = false,
                    bool group = true)
-        : dsp_voice_group(panic, this, control, group), dsp_poly(dsp) // dsp parameter is deallocated by ~dsp_poly
+        : dsp_voice_group(panic, this, control, group), dsp_poly(dsp), // dsp parameter is deallocated by ~dsp_poly
+        fEventsQueue(MAX_BLOCK_EVENTS), fFreeVoices(nvoices), fStealVoice(0), fLastVoice(0), fHardNotesOff(false)
         {
             fDate = 0;
+            fSleepBlocks = 0;
+            fWorkers = 0;
+            fStealingPolicy = new oldest_voice_policy();
+            fTrackLevel = false;
+            fStolenVoices = 0;
+            fTimeStamp = false;
+            fBlockEventsCount = 0;
+            fDateUsec = 0;
+            fOffsetUsec = 0;
+            fFirstCallback = true;
 
             // Create voices
             assert(nvoices > 0);
             for (int i = 0; i < nvoices; i++) {
-                addVoice(new dsp_voice(dsp->clone()));
+                dsp_voice* voice = new dsp_voice(dsp->clone());
+                addVoice(voice);
+                updateVoice(voice);
             }
 
+            reserveVoices();
+            fLastVoice = fVoiceTable[0];
+
             // Init audio output buffers
-            fMixBuffer = new FAUSTFLOAT*[getNumOutputs()];
-            for (int i = 0; i < getNumOutputs(); i++) {
-                fMixBuffer[i] = new FAUSTFLOAT[MIX_BUFFER_SIZE];
-            }
+            fMixBuffer = allocBuffers();
+            fActiveVoices.reserve(nvoices);
 
             dsp_voice_group::init();
         }
 
         virtual ~mydsp_poly()
         {
-            for (int i = 0; i < getNumOutputs(); i++) {
-                delete[] fMixBuffer[i];
+            setParallel(1);
+            deleteBuffers(fMixBuffer);
+            delete fStealingPolicy;
+        }
+
+        /**
+         * Render voices in parallel on a pool of worker threads.
+         *
+         * @param workers - the number of threads (including the audio thread) used to render the voices,
+         *                  0 to use all available cores, 1 to go back to sequential rendering.
+         *
+         * Threads and buffers are allocated here, so this method must not be called while the DSP is running.
+         */
+        void setParallel(int workers)
+        {
+            if (workers == 0) {
+                workers = std::max<int>(1, std::thread::hardware_concurrency());
+            }
+            delete fWorkers;
+            fWorkers = 0;
+            for (size_t i = 0; i < fWorkerMix.size(); i++) {
+                deleteBuffers(fWorkerVoice[i]);
+                deleteBuffers(fWorkerMix[i]);
+            }
+            fWorkerVoice.clear();
+            fWorkerMix.clear();
+            if (workers > 1) {
+                for (int i = 0; i < workers; i++) {
+                    fWorkerVoice.push_back(allocBuffers());
+                    fWorkerMix.push_back(allocBuffers());
+                }
+                fWorkers = new voice_worker_pool(workers);
+            }
+        }
+
+        int getParallel() { return (fWorkers) ? fWorkers->size() : 1; }
+
+        /**
+         * Put playing voices to sleep when silent, only used when voices are dynamically allocated.
+         *
+         * @param blocks - the number of consecutive silent blocks (below VOICE_STOP_LEVEL) after which
+         *                 a playing voice is not rendered anymore, until its next keyOn/keyOff, 0 to disable.
+         *
+         * This is only safe for DSP that cannot produce sound again without a control change
+         * (like a held note whose envelope has reached zero).
+         */
+        void setVoiceSleep(int blocks) { fSleepBlocks = std::max<int>(0, blocks); }
+
+        int getVoiceSleep() { return fSleepBlocks; }
+
+        /**
+         * Set the policy used to steal a voice when all voices are playing.
+         *
+         * @param policy - the policy (oldest_voice_policy by default). Beware: mydsp_poly will use and finally delete the pointer.
+         *
+         * This method must not be called while the DSP is running.
+         */
+        void setStealingPolicy(voice_stealing_policy* policy)
+        {
+            assert(policy);
+            delete fStealingPolicy;
+            fStealingPolicy = policy;
+            fTrackLevel = policy->needLevel();
+        }
+
+        voice_stealing_policy* getStealingPolicy() { return fStealingPolicy; }
+
+        // Set the priority of a voice returned by keyOn/newVoice, used by priority_voice_policy
+        void setVoicePriority(MapUI* voice, int priority)
+        {
+            static_cast<dsp_voice*>(voice)->fPriority = priority;
+        }
+
+        /**
+         * Handle timestamped note events (as received by the 'keyOn/keyOff(double date, ...)' MIDI methods).
+         *
+         * @param timestamp - if true, events are applied at their offset in the next rendered block,
+         *                    dates being expressed in usec, or in frames when 'compute' is called with date_usec = -1.
+         *                    If false (default), events are applied at the beginning of the next rendered block.
+         */
+        void setTimeStamp(bool timestamp) { fTimeStamp = timestamp; }
+
+        bool getTimeStamp() { return fTimeStamp; }
+
+        // Number of stolen voices since creation
+        long getStolenVoices() { return fStolenVoices; }
+
+        /**
+         * Voices rendering statistics.
+         *
+         * @param rendered - the number of rendered voice blocks
+         * @param silent - the number of rendered but silent voice blocks (wasted renders)
+         * @param skipped - the number of voice blocks skipped by sleeping voices
+         */
+        void getVoiceStats(long& rendered, long& silent, long& skipped)
+        {
+            rendered = silent = skipped = 0;
+            for (size_t i = 0; i < fVoiceTable.size(); i++) {
+                rendered += fVoiceTable[i]->fRenderedBlocks;
+                silent += fVoiceTable[i]->fSilentRenders;
+                skipped += fVoiceTable[i]->fSkippedBlocks;
+            }
+        }
+
+        void resetVoiceStats()
+        {
+            for (size_t i = 0; i < fVoiceTable.size(); i++) {
+                fVoiceTable[i]->resetStats();
             }
-            delete[] fMixBuffer;
         }
 
         // DSP API
@@ -564,63 +1384,71 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
 
         virtual mydsp_poly* clone()
         {
-            return new mydsp_poly(fDSP->clone(), int(fVoiceTable.size()), fVoiceControl, fGroupControl);
+            mydsp_poly* poly = new mydsp_poly(fDSP->clone(), int(fVoiceTable.size()), fVoiceControl, fGroupControl);
+            poly->setParallel(getParallel());
+            poly->setVoiceSleep(getVoiceSleep());
+            poly->setStealingPolicy(fStealingPolicy->clone());
+            poly->setTimeStamp(getTimeStamp());
+            return poly;
         }
 
         void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
         {
-            assert(count <= MIX_BUFFER_SIZE);
-
-            // First clear the outputs
-            clearOutput(count, outputs);
-
-            if (fVoiceControl) {
-                // Mix all playing voices
-                for (size_t i = 0; i < fVoiceTable.size(); i++) {
-                    dsp_voice* voice = fVoiceTable[i];
-                    if (voice->fNote != kFreeVoice) {
-                        voice->compute(count, inputs, fMixBuffer);
-                        // Mix it in result
-                        voice->fLevel = mixVoice(count, fMixBuffer, outputs);
-                        // Check the level to possibly set the voice in kFreeVoice again
-                        if ((voice->fLevel < VOICE_STOP_LEVEL) && (voice->fNote == kReleaseVoice)) {
-                            voice->fNote = kFreeVoice;
-                        }
-                    }
-                }
+            if (fTimeStamp) {
+                // Take a timestamp at 'compute' call time
+                compute(::GetCurrentTimeInUsec(), count, inputs, outputs);
             } else {
-                // Mix all voices
-                for (size_t i = 0; i < fVoiceTable.size(); i++) {
-                    fVoiceTable[i]->compute(count, inputs, fMixBuffer);
-                    mixVoice(count, fMixBuffer, outputs);
-                }
+                prepareEvents(count, false);
+                computeVoices(count, inputs, outputs);
             }
         }
 
         void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
         {
-            compute(count, inputs, outputs);
+            if (!fTimeStamp) {
+                prepareEvents(count, false);
+                computeVoices(count, inputs, outputs);
+            } else if (date_usec == -1) {
+                // Timestamp is expressed in frames
+                prepareEvents(count, false);
+                computeVoices(count, inputs, outputs);
+            } else {
+                // Save the timestamp offset in the first callback
+                if (fFirstCallback) {
+                    fFirstCallback = false;
+                    double current_date_usec = ::GetCurrentTimeInUsec();
+                    fDateUsec = current_date_usec;
+                    fOffsetUsec = current_date_usec - date_usec;
+                }
+                
+                // Timestamp must be converted in frames
+                prepareEvents(count, true);
+                computeVoices(count, inputs, outputs);
+                
+                // Keep call date
+                fDateUsec = date_usec + fOffsetUsec;
+            }
         }
-    
+
         // Terminate all active voices, gently or immediately (depending of 'hard' value)
         void allNotesOff(bool hard = false)
         {
-            for (size_t i = 0; i < fVoiceTable.size(); i++) {
-                fVoiceTable[i]->keyOff(hard);
-            }
+            pushEvent(kAllNotesOffEvent, 0., false, 0, hard);
         }
 
         // Additional polyphonic API
+
+        // Returns a free voice, or a stolen one if none is available (started at the beginning of the next block)
         MapUI* newVoice()
         {
-            return fVoiceTable[getFreeVoice()];
+            return pushEvent(kNewVoiceEvent, 0., false, 0, 0);
         }
 
         void deleteVoice(MapUI* voice)
         {
             std::vector<dsp_voice*>::iterator it = find(fVoiceTable.begin(), fVoiceTable.end(), reinterpret_cast<dsp_voice*>(voice));
             if (it != fVoiceTable.end()) {
-                (*it)->keyOff();
+                pushEvent(kKeyOffEvent, 0., false, 0, 0, *it);
             } else {
                 std::cout << "Voice not found\n";
             }
@@ -629,27 +1457,34 @@ class mydsp_poly : public dsp_voice_group, public dsp_poly {
         void setGroup(bool group) { fGroupControl = group; }
         bool getGroup() { return fGroupControl; }
 
-        // MIDI API
-        MapUI* keyOn(int channel, int pitch, int velocity)
+        // MIDI API: keyOn returns the voice playing the note, a free one or a stolen one if none is available
+        MapUI* keyOn(double date, int channel, int pitch, int velocity)
         {
-            if (checkPolyphony()) {
-                int voice = getFreeVoice();
-                fVoiceTable[voice]->keyOn(pitch, velocity, true);
-                return fVoiceTable[voice];
+            if (fTimeStamp) {
+                return pushEvent(kKeyOnEvent, date, true, pitch, velocity);
+            } else {
+                return keyOn(channel, pitch, velocity);
+            }
+        }
+
+        void keyOff(double date, int channel, int pitch, int velocity = 127)
+        {
+            if (fTimeStamp) {
+                pushEvent(kKeyOffEvent, date, true, pitch, velocity);
             } else {
-                return 0;
+                keyOff(channel, pitch, velocity);
             }
         }
 
+        MapUI* keyOn(int channel, int pitch, int velocity)
+        {
+            return (checkPolyphony()) ? pushEvent(kKeyOnEvent, 0., false, pitch, velocity) : 0;
+        }
+
         void keyOff(int channel, int pitch, int velocity = 127)
         {
             if (checkPolyphony()) {
-                int voice = getPlayingVoice(pitch);
-                if (voice != kNoVoice) {
-                    fVoiceTable[voice]->keyOff();
-                } else {
-                    std::cout << "Playing pitch = " << pitch << " not found\n";
-                }
+                pushEvent(kKeyOffEvent, 0., false, pitch, velocity);
             }
         }
 
@@ -718,6 +1553,14 @@ class dsp_poly_effect : public dsp_poly {
         }
         
         // MIDI API
+        MapUI* keyOn(double date, int channel, int pitch, int velocity)
+        {
+            return fPolyDSP->keyOn(date, channel, pitch, velocity);
+        }
+        void keyOff(double date, int channel, int pitch, int velocity)
+        {
+            fPolyDSP->keyOff(date, channel, pitch, velocity);
+        }
         MapUI* keyOn(int channel, int pitch, int velocity)
         {
             return fPolyDSP->keyOn(channel, pitch, velocity);
@@ -28,7 +28,7 @@
 #include <map>
 
 #include "faust/dsp/dsp.h"
-#include "faust/gui/JSONUIDecoder.h"
+#include "faust/gui/JSONUIStreamDecoder.h"
 #include "faust/gui/JSONUI.h"
 
 //----------------------------------------------------------------
@@ -42,7 +42,7 @@ class proxy_dsp : public dsp {
     private:
     
         int fSampleRate;
-        JSONUIDecoder* fDecoder;
+        JSONUIStreamDecoder* fDecoder;
         
     public:
     
@@ -56,7 +56,7 @@ class proxy_dsp : public dsp {
     
         void init(const std::string& json)
         {
-            fDecoder = new JSONUIDecoder(json);
+            fDecoder = new JSONUIStreamDecoder(json);
             fSampleRate = -1;
         }
           
@@ -66,7 +66,7 @@ class proxy_dsp : public dsp {
             dsp->metadata(&builder);
             dsp->buildUserInterface(&builder);
             fSampleRate = dsp->getSampleRate();
-            fDecoder = new JSONUIDecoder(builder.JSON());
+            fDecoder = new JSONUIStreamDecoder(builder.JSON());
         }
       
         virtual ~proxy_dsp()
@@ -0,0 +1,825 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+
+ Math functions adapted from the Cephes library (http://www.netlib.org/cephes/)
+ ************************************************************************/
+
+#ifndef __simd_vector__
+#define __simd_vector__
+
+/*
+ Portable SIMD wrapper used by the code generated with the '-simd' option (C and C++ backends).
+
+ The implementation is chosen at compile time from the target instruction set:
+
+    - AVX-512 (16 lanes) when __AVX512F__ is defined
+    - AVX2 (8 lanes) when __AVX2__ is defined
+    - SSE4.1 (4 lanes) when __SSE4_1__ is defined
+    - NEON (4 lanes) on AArch64
+    - a plain C version (4 lanes) otherwise
+
+ So the generated code has to be compiled with the appropriate flags (like '-march=native').
+
+ Only 'float' and 'int' lanes are supported, and all functions are C compatible.
+ Comparison functions return 'int' vectors with 0 or 1 values, following the Faust semantics.
+
+ Vectorized math functions are polynomial approximations, accurate to a few ULP in the usual
+ audio range, but they may differ from the libm versions for very large arguments.
+*/
+
+#include <stdint.h>
+#include <math.h>
+
+#ifndef FAUSTFLOAT
+#define FAUSTFLOAT float
+#endif
+
+#if defined(_MSC_VER)
+#define SIMD_INLINE static __forceinline
+#else
+#define SIMD_INLINE static inline __attribute__((always_inline))
+#endif
+
+#if defined(__AVX512F__)
+#define FAUST_SIMD_AVX512
+#elif defined(__AVX2__)
+#define FAUST_SIMD_AVX2
+#elif defined(__SSE4_1__)
+#define FAUST_SIMD_SSE
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define FAUST_SIMD_NEON
+#else
+#define FAUST_SIMD_GENERIC
+#endif
+
+// ================
+// AVX-512 version
+// ================
+
+#if defined(FAUST_SIMD_AVX512)
+
+#include <immintrin.h>
+
+#define FAUST_SIMD_SIZE 16
+#define FAUST_SIMD_ISA "avx512"
+
+typedef __m512    simd_float;
+typedef __m512i   simd_int;
+typedef __mmask16 simd_mask;
+
+SIMD_INLINE simd_float simd_set1_f(float a) { return _mm512_set1_ps(a); }
+SIMD_INLINE simd_int simd_set1_i(int a) { return _mm512_set1_epi32(a); }
+SIMD_INLINE simd_int simd_index_i(int a)
+{
+    return _mm512_add_epi32(_mm512_set1_epi32(a), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+SIMD_INLINE simd_float simd_load_f(const float* p) { return _mm512_loadu_ps(p); }
+SIMD_INLINE void simd_store_f(float* p, simd_float a) { _mm512_storeu_ps(p, a); }
+SIMD_INLINE simd_int simd_load_i(const int* p) { return _mm512_loadu_si512((const void*)p); }
+SIMD_INLINE void simd_store_i(int* p, simd_int a) { _mm512_storeu_si512((void*)p, a); }
+
+SIMD_INLINE simd_float simd_add_f(simd_float a, simd_float b) { return _mm512_add_ps(a, b); }
+SIMD_INLINE simd_float simd_sub_f(simd_float a, simd_float b) { return _mm512_sub_ps(a, b); }
+SIMD_INLINE simd_float simd_mul_f(simd_float a, simd_float b) { return _mm512_mul_ps(a, b); }
+SIMD_INLINE simd_float simd_div_f(simd_float a, simd_float b) { return _mm512_div_ps(a, b); }
+SIMD_INLINE simd_float simd_min_f(simd_float a, simd_float b) { return _mm512_min_ps(a, b); }
+SIMD_INLINE simd_float simd_max_f(simd_float a, simd_float b) { return _mm512_max_ps(a, b); }
+SIMD_INLINE simd_float simd_sqrt_f(simd_float a) { return _mm512_sqrt_ps(a); }
+SIMD_INLINE simd_float simd_trunc_f(simd_float a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+SIMD_INLINE simd_float simd_rint_f(simd_float a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+SIMD_INLINE simd_int simd_add_i(simd_int a, simd_int b) { return _mm512_add_epi32(a, b); }
+SIMD_INLINE simd_int simd_sub_i(simd_int a, simd_int b) { return _mm512_sub_epi32(a, b); }
+SIMD_INLINE simd_int simd_mul_i(simd_int a, simd_int b) { return _mm512_mullo_epi32(a, b); }
+SIMD_INLINE simd_int simd_and_i(simd_int a, simd_int b) { return _mm512_and_si512(a, b); }
+SIMD_INLINE simd_int simd_or_i(simd_int a, simd_int b) { return _mm512_or_si512(a, b); }
+SIMD_INLINE simd_int simd_xor_i(simd_int a, simd_int b) { return _mm512_xor_si512(a, b); }
+SIMD_INLINE simd_int simd_slli_i(simd_int a, int n) { return _mm512_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+SIMD_INLINE simd_int simd_srli_i(simd_int a, int n) { return _mm512_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+SIMD_INLINE simd_int simd_srai_i(simd_int a, int n) { return _mm512_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+
+SIMD_INLINE simd_int simd_as_i(simd_float a) { return _mm512_castps_si512(a); }
+SIMD_INLINE simd_float simd_as_f(simd_int a) { return _mm512_castsi512_ps(a); }
+SIMD_INLINE simd_float simd_cvt_i2f(simd_int a) { return _mm512_cvtepi32_ps(a); }
+SIMD_INLINE simd_int simd_cvt_f2i(simd_float a) { return _mm512_cvttps_epi32(a); }
+
+SIMD_INLINE simd_mask simd_lt_f(simd_float a, simd_float b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+SIMD_INLINE simd_mask simd_le_f(simd_float a, simd_float b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+SIMD_INLINE simd_mask simd_gt_f(simd_float a, simd_float b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+SIMD_INLINE simd_mask simd_ge_f(simd_float a, simd_float b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+SIMD_INLINE simd_mask simd_eq_f(simd_float a, simd_float b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+SIMD_INLINE simd_mask simd_ne_f(simd_float a, simd_float b) { return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ); }
+SIMD_INLINE simd_mask simd_lt_i(simd_int a, simd_int b) { return _mm512_cmp_epi32_mask(a, b, _MM_CMPINT_LT); }
+SIMD_INLINE simd_mask simd_le_i(simd_int a, simd_int b) { return _mm512_cmp_epi32_mask(a, b, _MM_CMPINT_LE); }
+SIMD_INLINE simd_mask simd_gt_i(simd_int a, simd_int b) { return _mm512_cmp_epi32_mask(a, b, _MM_CMPINT_NLE); }
+SIMD_INLINE simd_mask simd_ge_i(simd_int a, simd_int b) { return _mm512_cmp_epi32_mask(a, b, _MM_CMPINT_NLT); }
+SIMD_INLINE simd_mask simd_eq_i(simd_int a, simd_int b) { return _mm512_cmp_epi32_mask(a, b, _MM_CMPINT_EQ); }
+SIMD_INLINE simd_mask simd_ne_i(simd_int a, simd_int b) { return _mm512_cmp_epi32_mask(a, b, _MM_CMPINT_NE); }
+
+SIMD_INLINE simd_mask simd_and_m(simd_mask a, simd_mask b) { return (simd_mask)(a & b); }
+SIMD_INLINE simd_mask simd_or_m(simd_mask a, simd_mask b) { return (simd_mask)(a | b); }
+SIMD_INLINE simd_mask simd_not_m(simd_mask a) { return (simd_mask)(~a); }
+SIMD_INLINE simd_float simd_blend_f(simd_mask m, simd_float t, simd_float e) { return _mm512_mask_blend_ps(m, e, t); }
+SIMD_INLINE simd_int simd_blend_i(simd_mask m, simd_int t, simd_int e) { return _mm512_mask_blend_epi32(m, e, t); }
+SIMD_INLINE simd_int simd_m2i(simd_mask m) { return _mm512_maskz_mov_epi32(m, _mm512_set1_epi32(1)); }
+
+SIMD_INLINE simd_float simd_gather_f(const float* p, simd_int index) { return _mm512_i32gather_ps(index, p, 4); }
+SIMD_INLINE simd_int simd_gather_i(const int* p, simd_int index) { return _mm512_i32gather_epi32(index, p, 4); }
+
+// =============
+// AVX2 version
+// =============
+
+#elif defined(FAUST_SIMD_AVX2)
+
+#include <immintrin.h>
+
+#define FAUST_SIMD_SIZE 8
+#define FAUST_SIMD_ISA "avx2"
+
+typedef __m256  simd_float;
+typedef __m256i simd_int;
+typedef __m256  simd_mask;
+
+SIMD_INLINE simd_float simd_set1_f(float a) { return _mm256_set1_ps(a); }
+SIMD_INLINE simd_int simd_set1_i(int a) { return _mm256_set1_epi32(a); }
+SIMD_INLINE simd_int simd_index_i(int a)
+{
+    return _mm256_add_epi32(_mm256_set1_epi32(a), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+SIMD_INLINE simd_float simd_load_f(const float* p) { return _mm256_loadu_ps(p); }
+SIMD_INLINE void simd_store_f(float* p, simd_float a) { _mm256_storeu_ps(p, a); }
+SIMD_INLINE simd_int simd_load_i(const int* p) { return _mm256_loadu_si256((const __m256i*)p); }
+SIMD_INLINE void simd_store_i(int* p, simd_int a) { _mm256_storeu_si256((__m256i*)p, a); }
+
+SIMD_INLINE simd_float simd_add_f(simd_float a, simd_float b) { return _mm256_add_ps(a, b); }
+SIMD_INLINE simd_float simd_sub_f(simd_float a, simd_float b) { return _mm256_sub_ps(a, b); }
+SIMD_INLINE simd_float simd_mul_f(simd_float a, simd_float b) { return _mm256_mul_ps(a, b); }
+SIMD_INLINE simd_float simd_div_f(simd_float a, simd_float b) { return _mm256_div_ps(a, b); }
+SIMD_INLINE simd_float simd_min_f(simd_float a, simd_float b) { return _mm256_min_ps(a, b); }
+SIMD_INLINE simd_float simd_max_f(simd_float a, simd_float b) { return _mm256_max_ps(a, b); }
+SIMD_INLINE simd_float simd_sqrt_f(simd_float a) { return _mm256_sqrt_ps(a); }
+SIMD_INLINE simd_float simd_trunc_f(simd_float a) { return _mm256_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+SIMD_INLINE simd_float simd_rint_f(simd_float a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+SIMD_INLINE simd_int simd_add_i(simd_int a, simd_int b) { return _mm256_add_epi32(a, b); }
+SIMD_INLINE simd_int simd_sub_i(simd_int a, simd_int b) { return _mm256_sub_epi32(a, b); }
+SIMD_INLINE simd_int simd_mul_i(simd_int a, simd_int b) { return _mm256_mullo_epi32(a, b); }
+SIMD_INLINE simd_int simd_and_i(simd_int a, simd_int b) { return _mm256_and_si256(a, b); }
+SIMD_INLINE simd_int simd_or_i(simd_int a, simd_int b) { return _mm256_or_si256(a, b); }
+SIMD_INLINE simd_int simd_xor_i(simd_int a, simd_int b) { return _mm256_xor_si256(a, b); }
+SIMD_INLINE simd_int simd_slli_i(simd_int a, int n) { return _mm256_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+SIMD_INLINE simd_int simd_srli_i(simd_int a, int n) { return _mm256_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+SIMD_INLINE simd_int simd_srai_i(simd_int a, int n) { return _mm256_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+
+SIMD_INLINE simd_int simd_as_i(simd_float a) { return _mm256_castps_si256(a); }
+SIMD_INLINE simd_float simd_as_f(simd_int a) { return _mm256_castsi256_ps(a); }
+SIMD_INLINE simd_float simd_cvt_i2f(simd_int a) { return _mm256_cvtepi32_ps(a); }
+SIMD_INLINE simd_int simd_cvt_f2i(simd_float a) { return _mm256_cvttps_epi32(a); }
+
+SIMD_INLINE simd_mask simd_lt_f(simd_float a, simd_float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+SIMD_INLINE simd_mask simd_le_f(simd_float a, simd_float b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+SIMD_INLINE simd_mask simd_gt_f(simd_float a, simd_float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+SIMD_INLINE simd_mask simd_ge_f(simd_float a, simd_float b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+SIMD_INLINE simd_mask simd_eq_f(simd_float a, simd_float b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+SIMD_INLINE simd_mask simd_ne_f(simd_float a, simd_float b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+
+SIMD_INLINE simd_mask simd_and_m(simd_mask a, simd_mask b) { return _mm256_and_ps(a, b); }
+SIMD_INLINE simd_mask simd_or_m(simd_mask a, simd_mask b) { return _mm256_or_ps(a, b); }
+SIMD_INLINE simd_mask simd_not_m(simd_mask a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+
+SIMD_INLINE simd_mask simd_gt_i(simd_int a, simd_int b) { return _mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b)); }
+SIMD_INLINE simd_mask simd_lt_i(simd_int a, simd_int b) { return simd_gt_i(b, a); }
+SIMD_INLINE simd_mask simd_le_i(simd_int a, simd_int b) { return simd_not_m(simd_gt_i(a, b)); }
+SIMD_INLINE simd_mask simd_ge_i(simd_int a, simd_int b) { return simd_not_m(simd_gt_i(b, a)); }
+SIMD_INLINE simd_mask simd_eq_i(simd_int a, simd_int b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+SIMD_INLINE simd_mask simd_ne_i(simd_int a, simd_int b) { return simd_not_m(simd_eq_i(a, b)); }
+
+SIMD_INLINE simd_float simd_blend_f(simd_mask m, simd_float t, simd_float e) { return _mm256_blendv_ps(e, t, m); }
+SIMD_INLINE simd_int simd_blend_i(simd_mask m, simd_int t, simd_int e)
+{
+    return _mm256_blendv_epi8(e, t, _mm256_castps_si256(m));
+}
+SIMD_INLINE simd_int simd_m2i(simd_mask m) { return _mm256_and_si256(_mm256_castps_si256(m), _mm256_set1_epi32(1)); }
+
+SIMD_INLINE simd_float simd_gather_f(const float* p, simd_int index) { return _mm256_i32gather_ps(p, index, 4); }
+SIMD_INLINE simd_int simd_gather_i(const int* p, simd_int index) { return _mm256_i32gather_epi32(p, index, 4); }
+
+// ===============
+// SSE4.1 version
+// ===============
+
+#elif defined(FAUST_SIMD_SSE)
+
+#include <smmintrin.h>
+
+#define FAUST_SIMD_SIZE 4
+#define FAUST_SIMD_ISA "sse4.1"
+
+typedef __m128  simd_float;
+typedef __m128i simd_int;
+typedef __m128  simd_mask;
+
+SIMD_INLINE simd_float simd_set1_f(float a) { return _mm_set1_ps(a); }
+SIMD_INLINE simd_int simd_set1_i(int a) { return _mm_set1_epi32(a); }
+SIMD_INLINE simd_int simd_index_i(int a) { return _mm_add_epi32(_mm_set1_epi32(a), _mm_setr_epi32(0, 1, 2, 3)); }
+
+SIMD_INLINE simd_float simd_load_f(const float* p) { return _mm_loadu_ps(p); }
+SIMD_INLINE void simd_store_f(float* p, simd_float a) { _mm_storeu_ps(p, a); }
+SIMD_INLINE simd_int simd_load_i(const int* p) { return _mm_loadu_si128((const __m128i*)p); }
+SIMD_INLINE void simd_store_i(int* p, simd_int a) { _mm_storeu_si128((__m128i*)p, a); }
+
+SIMD_INLINE simd_float simd_add_f(simd_float a, simd_float b) { return _mm_add_ps(a, b); }
+SIMD_INLINE simd_float simd_sub_f(simd_float a, simd_float b) { return _mm_sub_ps(a, b); }
+SIMD_INLINE simd_float simd_mul_f(simd_float a, simd_float b) { return _mm_mul_ps(a, b); }
+SIMD_INLINE simd_float simd_div_f(simd_float a, simd_float b) { return _mm_div_ps(a, b); }
+SIMD_INLINE simd_float simd_min_f(simd_float a, simd_float b) { return _mm_min_ps(a, b); }
+SIMD_INLINE simd_float simd_max_f(simd_float a, simd_float b) { return _mm_max_ps(a, b); }
+SIMD_INLINE simd_float simd_sqrt_f(simd_float a) { return _mm_sqrt_ps(a); }
+SIMD_INLINE simd_float simd_trunc_f(simd_float a) { return _mm_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+SIMD_INLINE simd_float simd_rint_f(simd_float a) { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+SIMD_INLINE simd_int simd_add_i(simd_int a, simd_int b) { return _mm_add_epi32(a, b); }
+SIMD_INLINE simd_int simd_sub_i(simd_int a, simd_int b) { return _mm_sub_epi32(a, b); }
+SIMD_INLINE simd_int simd_mul_i(simd_int a, simd_int b) { return _mm_mullo_epi32(a, b); }
+SIMD_INLINE simd_int simd_and_i(simd_int a, simd_int b) { return _mm_and_si128(a, b); }
+SIMD_INLINE simd_int simd_or_i(simd_int a, simd_int b) { return _mm_or_si128(a, b); }
+SIMD_INLINE simd_int simd_xor_i(simd_int a, simd_int b) { return _mm_xor_si128(a, b); }
+SIMD_INLINE simd_int simd_slli_i(simd_int a, int n) { return _mm_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+SIMD_INLINE simd_int simd_srli_i(simd_int a, int n) { return _mm_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+SIMD_INLINE simd_int simd_srai_i(simd_int a, int n) { return _mm_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+
+SIMD_INLINE simd_int simd_as_i(simd_float a) { return _mm_castps_si128(a); }
+SIMD_INLINE simd_float simd_as_f(simd_int a) { return _mm_castsi128_ps(a); }
+SIMD_INLINE simd_float simd_cvt_i2f(simd_int a) { return _mm_cvtepi32_ps(a); }
+SIMD_INLINE simd_int simd_cvt_f2i(simd_float a) { return _mm_cvttps_epi32(a); }
+
+SIMD_INLINE simd_mask simd_lt_f(simd_float a, simd_float b) { return _mm_cmplt_ps(a, b); }
+SIMD_INLINE simd_mask simd_le_f(simd_float a, simd_float b) { return _mm_cmple_ps(a, b); }
+SIMD_INLINE simd_mask simd_gt_f(simd_float a, simd_float b) { return _mm_cmpgt_ps(a, b); }
+SIMD_INLINE simd_mask simd_ge_f(simd_float a, simd_float b) { return _mm_cmpge_ps(a, b); }
+SIMD_INLINE simd_mask simd_eq_f(simd_float a, simd_float b) { return _mm_cmpeq_ps(a, b); }
+SIMD_INLINE simd_mask simd_ne_f(simd_float a, simd_float b) { return _mm_cmpneq_ps(a, b); }
+
+SIMD_INLINE simd_mask simd_and_m(simd_mask a, simd_mask b) { return _mm_and_ps(a, b); }
+SIMD_INLINE simd_mask simd_or_m(simd_mask a, simd_mask b) { return _mm_or_ps(a, b); }
+SIMD_INLINE simd_mask simd_not_m(simd_mask a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+
+SIMD_INLINE simd_mask simd_lt_i(simd_int a, simd_int b) { return _mm_castsi128_ps(_mm_cmplt_epi32(a, b)); }
+SIMD_INLINE simd_mask simd_gt_i(simd_int a, simd_int b) { return _mm_castsi128_ps(_mm_cmpgt_epi32(a, b)); }
+SIMD_INLINE simd_mask simd_le_i(simd_int a, simd_int b) { return simd_not_m(simd_gt_i(a, b)); }
+SIMD_INLINE simd_mask simd_ge_i(simd_int a, simd_int b) { return simd_not_m(simd_lt_i(a, b)); }
+SIMD_INLINE simd_mask simd_eq_i(simd_int a, simd_int b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+SIMD_INLINE simd_mask simd_ne_i(simd_int a, simd_int b) { return simd_not_m(simd_eq_i(a, b)); }
+
+SIMD_INLINE simd_float simd_blend_f(simd_mask m, simd_float t, simd_float e) { return _mm_blendv_ps(e, t, m); }
+SIMD_INLINE simd_int simd_blend_i(simd_mask m, simd_int t, simd_int e)
+{
+    return _mm_blendv_epi8(e, t, _mm_castps_si128(m));
+}
+SIMD_INLINE simd_int simd_m2i(simd_mask m) { return _mm_and_si128(_mm_castps_si128(m), _mm_set1_epi32(1)); }
+
+#define FAUST_SIMD_LANEWISE_GATHER
+
+// =============================
+// NEON version (AArch64 only)
+// =============================
+
+#elif defined(FAUST_SIMD_NEON)
+
+#include <arm_neon.h>
+
+#define FAUST_SIMD_SIZE 4
+#define FAUST_SIMD_ISA "neon"
+
+typedef float32x4_t simd_float;
+typedef int32x4_t   simd_int;
+typedef uint32x4_t  simd_mask;
+
+SIMD_INLINE simd_float simd_set1_f(float a) { return vdupq_n_f32(a); }
+SIMD_INLINE simd_int simd_set1_i(int a) { return vdupq_n_s32(a); }
+SIMD_INLINE simd_int simd_index_i(int a)
+{
+    static const int32_t iota[4] = {0, 1, 2, 3};
+    return vaddq_s32(vdupq_n_s32(a), vld1q_s32(iota));
+}
+
+SIMD_INLINE simd_float simd_load_f(const float* p) { return vld1q_f32(p); }
+SIMD_INLINE void simd_store_f(float* p, simd_float a) { vst1q_f32(p, a); }
+SIMD_INLINE simd_int simd_load_i(const int* p) { return vld1q_s32((const int32_t*)p); }
+SIMD_INLINE void simd_store_i(int* p, simd_int a) { vst1q_s32((int32_t*)p, a); }
+
+SIMD_INLINE simd_float simd_add_f(simd_float a, simd_float b) { return vaddq_f32(a, b); }
+SIMD_INLINE simd_float simd_sub_f(simd_float a, simd_float b) { return vsubq_f32(a, b); }
+SIMD_INLINE simd_float simd_mul_f(simd_float a, simd_float b) { return vmulq_f32(a, b); }
+SIMD_INLINE simd_float simd_div_f(simd_float a, simd_float b) { return vdivq_f32(a, b); }
+SIMD_INLINE simd_float simd_min_f(simd_float a, simd_float b) { return vminq_f32(a, b); }
+SIMD_INLINE simd_float simd_max_f(simd_float a, simd_float b) { return vmaxq_f32(a, b); }
+SIMD_INLINE simd_float simd_sqrt_f(simd_float a) { return vsqrtq_f32(a); }
+SIMD_INLINE simd_float simd_trunc_f(simd_float a) { return vrndq_f32(a); }
+SIMD_INLINE simd_float simd_rint_f(simd_float a) { return vrndnq_f32(a); }
+
+SIMD_INLINE simd_int simd_add_i(simd_int a, simd_int b) { return vaddq_s32(a, b); }
+SIMD_INLINE simd_int simd_sub_i(simd_int a, simd_int b) { return vsubq_s32(a, b); }
+SIMD_INLINE simd_int simd_mul_i(simd_int a, simd_int b) { return vmulq_s32(a, b); }
+SIMD_INLINE simd_int simd_and_i(simd_int a, simd_int b) { return vandq_s32(a, b); }
+SIMD_INLINE simd_int simd_or_i(simd_int a, simd_int b) { return vorrq_s32(a, b); }
+SIMD_INLINE simd_int simd_xor_i(simd_int a, simd_int b) { return veorq_s32(a, b); }
+SIMD_INLINE simd_int simd_slli_i(simd_int a, int n) { return vshlq_s32(a, vdupq_n_s32(n)); }
+SIMD_INLINE simd_int simd_srli_i(simd_int a, int n)
+{
+    return vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(a), vdupq_n_s32(-n)));
+}
+SIMD_INLINE simd_int simd_srai_i(simd_int a, int n) { return vshlq_s32(a, vdupq_n_s32(-n)); }
+
+SIMD_INLINE simd_int simd_as_i(simd_float a) { return vreinterpretq_s32_f32(a); }
+SIMD_INLINE simd_float simd_as_f(simd_int a) { return vreinterpretq_f32_s32(a); }
+SIMD_INLINE simd_float simd_cvt_i2f(simd_int a) { return vcvtq_f32_s32(a); }
+SIMD_INLINE simd_int simd_cvt_f2i(simd_float a) { return vcvtq_s32_f32(a); }
+
+SIMD_INLINE simd_mask simd_lt_f(simd_float a, simd_float b) { return vcltq_f32(a, b); }
+SIMD_INLINE simd_mask simd_le_f(simd_float a, simd_float b) { return vcleq_f32(a, b); }
+SIMD_INLINE simd_mask simd_gt_f(simd_float a, simd_float b) { return vcgtq_f32(a, b); }
+SIMD_INLINE simd_mask simd_ge_f(simd_float a, simd_float b) { return vcgeq_f32(a, b); }
+SIMD_INLINE simd_mask simd_eq_f(simd_float a, simd_float b) { return vceqq_f32(a, b); }
+SIMD_INLINE simd_mask simd_ne_f(simd_float a, simd_float b) { return vmvnq_u32(vceqq_f32(a, b)); }
+SIMD_INLINE simd_mask simd_lt_i(simd_int a, simd_int b) { return vcltq_s32(a, b); }
+SIMD_INLINE simd_mask simd_le_i(simd_int a, simd_int b) { return vcleq_s32(a, b); }
+SIMD_INLINE simd_mask simd_gt_i(simd_int a, simd_int b) { return vcgtq_s32(a, b); }
+SIMD_INLINE simd_mask simd_ge_i(simd_int a, simd_int b) { return vcgeq_s32(a, b); }
+SIMD_INLINE simd_mask simd_eq_i(simd_int a, simd_int b) { return vceqq_s32(a, b); }
+SIMD_INLINE simd_mask simd_ne_i(simd_int a, simd_int b) { return vmvnq_u32(vceqq_s32(a, b)); }
+
+SIMD_INLINE simd_mask simd_and_m(simd_mask a, simd_mask b) { return vandq_u32(a, b); }
+SIMD_INLINE simd_mask simd_or_m(simd_mask a, simd_mask b) { return vorrq_u32(a, b); }
+SIMD_INLINE simd_mask simd_not_m(simd_mask a) { return vmvnq_u32(a); }
+SIMD_INLINE simd_float simd_blend_f(simd_mask m, simd_float t, simd_float e) { return vbslq_f32(m, t, e); }
+SIMD_INLINE simd_int simd_blend_i(simd_mask m, simd_int t, simd_int e) { return vbslq_s32(m, t, e); }
+SIMD_INLINE simd_int simd_m2i(simd_mask m) { return vreinterpretq_s32_u32(vandq_u32(m, vdupq_n_u32(1))); }
+
+#define FAUST_SIMD_LANEWISE_GATHER
+
+// =======================================
+// Generic version (plain C, 4 lanes)
+// =======================================
+
+#else
+
+#define FAUST_SIMD_SIZE 4
+#define FAUST_SIMD_ISA "generic"
+
+typedef struct { float v[FAUST_SIMD_SIZE]; } simd_float;
+typedef struct { int32_t v[FAUST_SIMD_SIZE]; } simd_int;
+typedef struct { int32_t v[FAUST_SIMD_SIZE]; } simd_mask;
+
+#define SIMD_LANES(type, expr) type r; int k; for (k = 0; k < FAUST_SIMD_SIZE; k++) { r.v[k] = (expr); } return r;
+
+SIMD_INLINE simd_float simd_set1_f(float a) { SIMD_LANES(simd_float, a) }
+SIMD_INLINE simd_int simd_set1_i(int a) { SIMD_LANES(simd_int, a) }
+SIMD_INLINE simd_int simd_index_i(int a) { SIMD_LANES(simd_int, a + k) }
+
+SIMD_INLINE simd_float simd_load_f(const float* p) { SIMD_LANES(simd_float, p[k]) }
+SIMD_INLINE void simd_store_f(float* p, simd_float a) { int k; for (k = 0; k < FAUST_SIMD_SIZE; k++) p[k] = a.v[k]; }
+SIMD_INLINE simd_int simd_load_i(const int* p) { SIMD_LANES(simd_int, p[k]) }
+SIMD_INLINE void simd_store_i(int* p, simd_int a) { int k; for (k = 0; k < FAUST_SIMD_SIZE; k++) p[k] = a.v[k]; }
+
+SIMD_INLINE simd_float simd_add_f(simd_float a, simd_float b) { SIMD_LANES(simd_float, a.v[k] + b.v[k]) }
+SIMD_INLINE simd_float simd_sub_f(simd_float a, simd_float b) { SIMD_LANES(simd_float, a.v[k] - b.v[k]) }
+SIMD_INLINE simd_float simd_mul_f(simd_float a, simd_float b) { SIMD_LANES(simd_float, a.v[k] * b.v[k]) }
+SIMD_INLINE simd_float simd_div_f(simd_float a, simd_float b) { SIMD_LANES(simd_float, a.v[k] / b.v[k]) }
+SIMD_INLINE simd_float simd_min_f(simd_float a, simd_float b) { SIMD_LANES(simd_float, (a.v[k] < b.v[k]) ? a.v[k] : b.v[k]) }
+SIMD_INLINE simd_float simd_max_f(simd_float a, simd_float b) { SIMD_LANES(simd_float, (a.v[k] > b.v[k]) ? a.v[k] : b.v[k]) }
+SIMD_INLINE simd_float simd_sqrt_f(simd_float a) { SIMD_LANES(simd_float, sqrtf(a.v[k])) }
+SIMD_INLINE simd_float simd_trunc_f(simd_float a) { SIMD_LANES(simd_float, truncf(a.v[k])) }
+SIMD_INLINE simd_float simd_rint_f(simd_float a) { SIMD_LANES(simd_float, rintf(a.v[k])) }
+
+SIMD_INLINE simd_int simd_add_i(simd_int a, simd_int b) { SIMD_LANES(simd_int, (int32_t)((uint32_t)a.v[k] + (uint32_t)b.v[k])) }
+SIMD_INLINE simd_int simd_sub_i(simd_int a, simd_int b) { SIMD_LANES(simd_int, (int32_t)((uint32_t)a.v[k] - (uint32_t)b.v[k])) }
+SIMD_INLINE simd_int simd_mul_i(simd_int a, simd_int b) { SIMD_LANES(simd_int, (int32_t)((uint32_t)a.v[k] * (uint32_t)b.v[k])) }
+SIMD_INLINE simd_int simd_and_i(simd_int a, simd_int b) { SIMD_LANES(simd_int, a.v[k] & b.v[k]) }
+SIMD_INLINE simd_int simd_or_i(simd_int a, simd_int b) { SIMD_LANES(simd_int, a.v[k] | b.v[k]) }
+SIMD_INLINE simd_int simd_xor_i(simd_int a, simd_int b) { SIMD_LANES(simd_int, a.v[k] ^ b.v[k]) }
+SIMD_INLINE simd_int simd_slli_i(simd_int a, int n) { SIMD_LANES(simd_int, (int32_t)((uint32_t)a.v[k] << n)) }
+SIMD_INLINE simd_int simd_srli_i(simd_int a, int n) { SIMD_LANES(simd_int, (int32_t)((uint32_t)a.v[k] >> n)) }
+SIMD_INLINE simd_int simd_srai_i(simd_int a, int n) { SIMD_LANES(simd_int, a.v[k] >> n) }
+
+SIMD_INLINE simd_int simd_as_i(simd_float a)
+{
+    union { simd_float f; simd_int i; } u;
+    u.f = a;
+    return u.i;
+}
+SIMD_INLINE simd_float simd_as_f(simd_int a)
+{
+    union { simd_float f; simd_int i; } u;
+    u.i = a;
+    return u.f;
+}
+SIMD_INLINE simd_float simd_cvt_i2f(simd_int a) { SIMD_LANES(simd_float, (float)a.v[k]) }
+SIMD_INLINE simd_int simd_cvt_f2i(simd_float a) { SIMD_LANES(simd_int, (int32_t)a.v[k]) }
+
+SIMD_INLINE simd_mask simd_lt_f(simd_float a, simd_float b) { SIMD_LANES(simd_mask, -(a.v[k] < b.v[k])) }
+SIMD_INLINE simd_mask simd_le_f(simd_float a, simd_float b) { SIMD_LANES(simd_mask, -(a.v[k] <= b.v[k])) }
+SIMD_INLINE simd_mask simd_gt_f(simd_float a, simd_float b) { SIMD_LANES(simd_mask, -(a.v[k] > b.v[k])) }
+SIMD_INLINE simd_mask simd_ge_f(simd_float a, simd_float b) { SIMD_LANES(simd_mask, -(a.v[k] >= b.v[k])) }
+SIMD_INLINE simd_mask simd_eq_f(simd_float a, simd_float b) { SIMD_LANES(simd_mask, -(a.v[k] == b.v[k])) }
+SIMD_INLINE simd_mask simd_ne_f(simd_float a, simd_float b) { SIMD_LANES(simd_mask, -(a.v[k] != b.v[k])) }
+SIMD_INLINE simd_mask simd_lt_i(simd_int a, simd_int b) { SIMD_LANES(simd_mask, -(a.v[k] < b.v[k])) }
+SIMD_INLINE simd_mask simd_le_i(simd_int a, simd_int b) { SIMD_LANES(simd_mask, -(a.v[k] <= b.v[k])) }
+SIMD_INLINE simd_mask simd_gt_i(simd_int a, simd_int b) { SIMD_LANES(simd_mask, -(a.v[k] > b.v[k])) }
+SIMD_INLINE simd_mask simd_ge_i(simd_int a, simd_int b) { SIMD_LANES(simd_mask, -(a.v[k] >= b.v[k])) }
+SIMD_INLINE simd_mask simd_eq_i(simd_int a, simd_int b) { SIMD_LANES(simd_mask, -(a.v[k] == b.v[k])) }
+SIMD_INLINE simd_mask simd_ne_i(simd_int a, simd_int b) { SIMD_LANES(simd_mask, -(a.v[k] != b.v[k])) }
+
+SIMD_INLINE simd_mask simd_and_m(simd_mask a, simd_mask b) { SIMD_LANES(simd_mask, a.v[k] & b.v[k]) }
+SIMD_INLINE simd_mask simd_or_m(simd_mask a, simd_mask b) { SIMD_LANES(simd_mask, a.v[k] | b.v[k]) }
+SIMD_INLINE simd_mask simd_not_m(simd_mask a) { SIMD_LANES(simd_mask, ~a.v[k]) }
+SIMD_INLINE simd_float simd_blend_f(simd_mask m, simd_float t, simd_float e) { SIMD_LANES(simd_float, m.v[k] ? t.v[k] : e.v[k]) }
+SIMD_INLINE simd_int simd_blend_i(simd_mask m, simd_int t, simd_int e) { SIMD_LANES(simd_int, m.v[k] ? t.v[k] : e.v[k]) }
+SIMD_INLINE simd_int simd_m2i(simd_mask m) { SIMD_LANES(simd_int, m.v[k] & 1) }
+
+#undef SIMD_LANES
+
+#define FAUST_SIMD_LANEWISE_GATHER
+
+#endif
+
+// Number of frames that can be computed with full vectors
+#define FAUST_SIMD_FLOOR(n) ((n) & ~(FAUST_SIMD_SIZE - 1))
+
+// =============================================
+// Functions shared by all implementations
+// =============================================
+
+#ifdef FAUST_SIMD_LANEWISE_GATHER
+SIMD_INLINE simd_float simd_gather_f(const float* p, simd_int index)
+{
+    int   idx[FAUST_SIMD_SIZE];
+    float res[FAUST_SIMD_SIZE];
+    int   k;
+    simd_store_i(idx, index);
+    for (k = 0; k < FAUST_SIMD_SIZE; k++) res[k] = p[idx[k]];
+    return simd_load_f(res);
+}
+SIMD_INLINE simd_int simd_gather_i(const int* p, simd_int index)
+{
+    int idx[FAUST_SIMD_SIZE];
+    int res[FAUST_SIMD_SIZE];
+    int k;
+    simd_store_i(idx, index);
+    for (k = 0; k < FAUST_SIMD_SIZE; k++) res[k] = p[idx[k]];
+    return simd_load_i(res);
+}
+#undef FAUST_SIMD_LANEWISE_GATHER
+#endif
+
+// FAUSTFLOAT buffers (inputs/outputs) may be 'double' while computations are done on 'float'
+SIMD_INLINE simd_float simd_load_ff(const FAUSTFLOAT* p)
+{
+    if (sizeof(FAUSTFLOAT) == sizeof(float)) {
+        return simd_load_f((const float*)p);
+    } else {
+        float res[FAUST_SIMD_SIZE];
+        int   k;
+        for (k = 0; k < FAUST_SIMD_SIZE; k++) res[k] = (float)p[k];
+        return simd_load_f(res);
+    }
+}
+SIMD_INLINE void simd_store_ff(FAUSTFLOAT* p, simd_float a)
+{
+    if (sizeof(FAUSTFLOAT) == sizeof(float)) {
+        simd_store_f((float*)p, a);
+    } else {
+        float res[FAUST_SIMD_SIZE];
+        int   k;
+        simd_store_f(res, a);
+        for (k = 0; k < FAUST_SIMD_SIZE; k++) p[k] = (FAUSTFLOAT)res[k];
+    }
+}
+
+// Comparisons with the Faust semantics (0 or 1 int values)
+SIMD_INLINE simd_int simd_cmplt_f(simd_float a, simd_float b) { return simd_m2i(simd_lt_f(a, b)); }
+SIMD_INLINE simd_int simd_cmple_f(simd_float a, simd_float b) { return simd_m2i(simd_le_f(a, b)); }
+SIMD_INLINE simd_int simd_cmpgt_f(simd_float a, simd_float b) { return simd_m2i(simd_gt_f(a, b)); }
+SIMD_INLINE simd_int simd_cmpge_f(simd_float a, simd_float b) { return simd_m2i(simd_ge_f(a, b)); }
+SIMD_INLINE simd_int simd_cmpeq_f(simd_float a, simd_float b) { return simd_m2i(simd_eq_f(a, b)); }
+SIMD_INLINE simd_int simd_cmpne_f(simd_float a, simd_float b) { return simd_m2i(simd_ne_f(a, b)); }
+SIMD_INLINE simd_int simd_cmplt_i(simd_int a, simd_int b) { return simd_m2i(simd_lt_i(a, b)); }
+SIMD_INLINE simd_int simd_cmple_i(simd_int a, simd_int b) { return simd_m2i(simd_le_i(a, b)); }
+SIMD_INLINE simd_int simd_cmpgt_i(simd_int a, simd_int b) { return simd_m2i(simd_gt_i(a, b)); }
+SIMD_INLINE simd_int simd_cmpge_i(simd_int a, simd_int b) { return simd_m2i(simd_ge_i(a, b)); }
+SIMD_INLINE simd_int simd_cmpeq_i(simd_int a, simd_int b) { return simd_m2i(simd_eq_i(a, b)); }
+SIMD_INLINE simd_int simd_cmpne_i(simd_int a, simd_int b) { return simd_m2i(simd_ne_i(a, b)); }
+
+// Select with a 0/non 0 condition, both branches are computed
+SIMD_INLINE simd_float simd_select_f(simd_int c, simd_float t, simd_float e)
+{
+    return simd_blend_f(simd_ne_i(c, simd_set1_i(0)), t, e);
+}
+SIMD_INLINE simd_int simd_select_i(simd_int c, simd_int t, simd_int e)
+{
+    return simd_blend_i(simd_ne_i(c, simd_set1_i(0)), t, e);
+}
+
+// Integer operations without SIMD instructions are done lane by lane
+#define SIMD_LANEWISE_I(name, expr)                      \
+    SIMD_INLINE simd_int name(simd_int a, simd_int b)    \
+    {                                                    \
+        int x[FAUST_SIMD_SIZE], y[FAUST_SIMD_SIZE];      \
+        int k;                                           \
+        simd_store_i(x, a);                              \
+        simd_store_i(y, b);                              \
+        for (k = 0; k < FAUST_SIMD_SIZE; k++) {          \
+            x[k] = (expr);                               \
+        }                                                \
+        return simd_load_i(x);                           \
+    }
+
+// Division by zero (possibly computed in the unused branch of a select) gives 0
+SIMD_LANEWISE_I(simd_div_i, (y[k] != 0) ? x[k] / y[k] : 0)
+SIMD_LANEWISE_I(simd_rem_i, (y[k] != 0) ? x[k] % y[k] : 0)
+SIMD_LANEWISE_I(simd_shl_i, x[k] << y[k])
+SIMD_LANEWISE_I(simd_shr_i, x[k] >> y[k])
+
+#undef SIMD_LANEWISE_I
+
+SIMD_INLINE simd_int simd_min_i(simd_int a, simd_int b) { return simd_blend_i(simd_lt_i(a, b), a, b); }
+SIMD_INLINE simd_int simd_max_i(simd_int a, simd_int b) { return simd_blend_i(simd_gt_i(a, b), a, b); }
+SIMD_INLINE simd_int simd_abs_i(simd_int a) { return simd_blend_i(simd_lt_i(a, simd_set1_i(0)), simd_sub_i(simd_set1_i(0), a), a); }
+
+SIMD_INLINE simd_int simd_faustpower_i(simd_int a, int n)
+{
+    simd_int r = simd_set1_i(1);
+    int      k;
+    for (k = 0; k < n; k++) r = simd_mul_i(r, a);
+    return r;
+}
+
+// ===============
+// Math functions
+// ===============
+
+SIMD_INLINE simd_float simd_faustpower_f(simd_float a, int n)
+{
+    simd_float r = simd_set1_f(1.f);
+    int        k;
+    for (k = 0; k < n; k++) r = simd_mul_f(r, a);
+    return r;
+}
+
+SIMD_INLINE simd_float simd_abs_f(simd_float a) { return simd_as_f(simd_and_i(simd_as_i(a), simd_set1_i(0x7fffffff))); }
+
+SIMD_INLINE simd_float simd_floor_f(simd_float a)
+{
+    simd_float t = simd_trunc_f(a);
+    return simd_blend_f(simd_lt_f(a, t), simd_sub_f(t, simd_set1_f(1.f)), t);
+}
+
+SIMD_INLINE simd_float simd_ceil_f(simd_float a)
+{
+    simd_float t = simd_trunc_f(a);
+    return simd_blend_f(simd_gt_f(a, t), simd_add_f(t, simd_set1_f(1.f)), t);
+}
+
+// Rounding half away from zero, like 'roundf'
+SIMD_INLINE simd_float simd_round_f(simd_float a)
+{
+    simd_float t = simd_trunc_f(a);
+    simd_float d = simd_sub_f(a, t);
+    t = simd_blend_f(simd_ge_f(d, simd_set1_f(0.5f)), simd_add_f(t, simd_set1_f(1.f)), t);
+    return simd_blend_f(simd_le_f(d, simd_set1_f(-0.5f)), simd_sub_f(t, simd_set1_f(1.f)), t);
+}
+
+SIMD_INLINE simd_float simd_fmod_f(simd_float a, simd_float b)
+{
+    return simd_sub_f(a, simd_mul_f(simd_trunc_f(simd_div_f(a, b)), b));
+}
+
+SIMD_INLINE simd_float simd_remainder_f(simd_float a, simd_float b)
+{
+    return simd_sub_f(a, simd_mul_f(simd_rint_f(simd_div_f(a, b)), b));
+}
+
+SIMD_INLINE simd_float simd_exp_f(simd_float x)
+{
+    simd_float in = x;
+    simd_float fx, y, z;
+    simd_int   n;
+
+    x = simd_min_f(x, simd_set1_f(88.3762626647949f));
+    x = simd_max_f(x, simd_set1_f(-87.3365447504019f));
+
+    // exp(x) = 2^n * exp(g), with |g| <= 0.5 * log(2)
+    fx = simd_floor_f(simd_add_f(simd_mul_f(x, simd_set1_f(1.44269504088896341f)), simd_set1_f(0.5f)));
+    x  = simd_sub_f(x, simd_mul_f(fx, simd_set1_f(0.693359375f)));
+    x  = simd_sub_f(x, simd_mul_f(fx, simd_set1_f(-2.12194440e-4f)));
+    z  = simd_mul_f(x, x);
+
+    y = simd_set1_f(1.9875691500E-4f);
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(1.3981999507E-3f));
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(8.3334519073E-3f));
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(4.1665795894E-2f));
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(1.6666665459E-1f));
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(5.0000001201E-1f));
+    y = simd_add_f(simd_add_f(simd_mul_f(y, z), x), simd_set1_f(1.f));
+
+    // Build 2^n
+    n = simd_slli_i(simd_add_i(simd_cvt_f2i(fx), simd_set1_i(127)), 23);
+    y = simd_mul_f(y, simd_as_f(n));
+
+    // Overflow, underflow and NaN
+    y = simd_blend_f(simd_gt_f(in, simd_set1_f(88.7228391116729996f)), simd_set1_f(HUGE_VALF), y);
+    y = simd_blend_f(simd_lt_f(in, simd_set1_f(-87.3365447504019f)), simd_set1_f(0.f), y);
+    return simd_blend_f(simd_ne_f(in, in), in, y);
+}
+
+SIMD_INLINE simd_float simd_log_f(simd_float x)
+{
+    simd_float in = x;
+    simd_float e, y, z, tmp;
+    simd_mask  mask;
+    simd_int   xi;
+
+    // Cut off denormalized values
+    x  = simd_max_f(x, simd_set1_f(1.17549435e-38f));
+    xi = simd_as_i(x);
+
+    // Split in exponent and mantissa in [0.5, 1[
+    e  = simd_cvt_i2f(simd_sub_i(simd_srli_i(xi, 23), simd_set1_i(126)));
+    x  = simd_as_f(simd_or_i(simd_and_i(xi, simd_set1_i(0x807fffff)), simd_set1_i(0x3f000000)));
+
+    mask = simd_lt_f(x, simd_set1_f(0.707106781186547524f));
+    tmp  = simd_blend_f(mask, x, simd_set1_f(0.f));
+    x    = simd_sub_f(x, simd_set1_f(1.f));
+    e    = simd_sub_f(e, simd_blend_f(mask, simd_set1_f(1.f), simd_set1_f(0.f)));
+    x    = simd_add_f(x, tmp);
+    z    = simd_mul_f(x, x);
+
+    y = simd_set1_f(7.0376836292E-2f);
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(-1.1514610310E-1f));
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(1.1676998740E-1f));
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(-1.2420140846E-1f));
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(1.4249322787E-1f));
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(-1.6668057665E-1f));
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(2.0000714765E-1f));
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(-2.4999993993E-1f));
+    y = simd_add_f(simd_mul_f(y, x), simd_set1_f(3.3333331174E-1f));
+    y = simd_mul_f(simd_mul_f(y, x), z);
+
+    y = simd_add_f(y, simd_mul_f(e, simd_set1_f(-2.12194440e-4f)));
+    y = simd_sub_f(y, simd_mul_f(z, simd_set1_f(0.5f)));
+    x = simd_add_f(x, y);
+    x = simd_add_f(x, simd_mul_f(e, simd_set1_f(0.693359375f)));
+
+    // Special values: log(0) = -inf, log(x < 0) = NaN, log(inf) = inf, log(NaN) = NaN
+    x = simd_blend_f(simd_eq_f(in, simd_set1_f(0.f)), simd_set1_f(-HUGE_VALF), x);
+    x = simd_blend_f(simd_lt_f(in, simd_set1_f(0.f)), simd_set1_f(NAN), x);
+    x = simd_blend_f(simd_eq_f(in, simd_set1_f(HUGE_VALF)), in, x);
+    return simd_blend_f(simd_ne_f(in, in), in, x);
+}
+
+SIMD_INLINE simd_float simd_exp2_f(simd_float x) { return simd_exp_f(simd_mul_f(x, simd_set1_f(0.693147180559945309f))); }
+SIMD_INLINE simd_float simd_exp10_f(simd_float x) { return simd_exp_f(simd_mul_f(x, simd_set1_f(2.30258509299404568f))); }
+SIMD_INLINE simd_float simd_log2_f(simd_float x) { return simd_mul_f(simd_log_f(x), simd_set1_f(1.44269504088896341f)); }
+SIMD_INLINE simd_float simd_log10_f(simd_float x) { return simd_mul_f(simd_log_f(x), simd_set1_f(0.434294481903251828f)); }
+
+SIMD_INLINE simd_float simd_pow_f(simd_float x, simd_float y)
+{
+    simd_float r     = simd_exp_f(simd_mul_f(y, simd_log_f(simd_abs_f(x))));
+    simd_float yi    = simd_trunc_f(y);
+    simd_mask  y_int = simd_eq_f(yi, y);
+    simd_mask  y_odd = simd_ne_i(simd_and_i(simd_cvt_f2i(yi), simd_set1_i(1)), simd_set1_i(0));
+    simd_mask  x_neg = simd_lt_f(x, simd_set1_f(0.f));
+
+    // Negative base: defined for integer exponents only
+    r = simd_blend_f(simd_and_m(x_neg, simd_and_m(y_int, y_odd)), simd_sub_f(simd_set1_f(0.f), r), r);
+    r = simd_blend_f(simd_and_m(x_neg, simd_not_m(y_int)), simd_set1_f(NAN), r);
+    return simd_blend_f(simd_or_m(simd_eq_f(y, simd_set1_f(0.f)), simd_eq_f(x, simd_set1_f(1.f))), simd_set1_f(1.f), r);
+}
+
+// Shared sin/cos range reduction and polynomials
+SIMD_INLINE simd_float simd_sincos_aux(simd_float x, simd_int* j)
+{
+    simd_float y;
+    simd_int   n;
+
+    // Reduce in [-PI/4, PI/4], j is the octant (always even after rounding)
+    y  = simd_mul_f(x, simd_set1_f(1.27323954473516f));
+    n  = simd_and_i(simd_add_i(simd_cvt_f2i(y), simd_set1_i(1)), simd_set1_i(~1));
+    y  = simd_cvt_i2f(n);
+    *j = n;
+
+    x = simd_sub_f(x, simd_mul_f(y, simd_set1_f(0.78515625f)));
+    x = simd_sub_f(x, simd_mul_f(y, simd_set1_f(2.4187564849853515625e-4f)));
+    return simd_sub_f(x, simd_mul_f(y, simd_set1_f(3.77489497744594108e-8f)));
+}
+
+SIMD_INLINE simd_float simd_sincos_poly(simd_float x, simd_mask sin_poly)
+{
+    simd_float z = simd_mul_f(x, x);
+    simd_float c, s;
+
+    c = simd_set1_f(2.443315711809948E-005f);
+    c = simd_add_f(simd_mul_f(c, z), simd_set1_f(-1.388731625493765E-003f));
+    c = simd_add_f(simd_mul_f(c, z), simd_set1_f(4.166664568298827E-002f));
+    c = simd_mul_f(simd_mul_f(c, z), z);
+    c = simd_add_f(simd_sub_f(c, simd_mul_f(z, simd_set1_f(0.5f))), simd_set1_f(1.f));
+
+    s = simd_set1_f(-1.9515295891E-4f);
+    s = simd_add_f(simd_mul_f(s, z), simd_set1_f(8.3321608736E-3f));
+    s = simd_add_f(simd_mul_f(s, z), simd_set1_f(-1.6666654611E-1f));
+    s = simd_add_f(simd_mul_f(simd_mul_f(s, z), x), x);
+
+    return simd_blend_f(sin_poly, s, c);
+}
+
+SIMD_INLINE simd_float simd_sin_f(simd_float x)
+{
+    simd_int   sign = simd_and_i(simd_as_i(x), simd_set1_i((int)0x80000000));
+    simd_int   j;
+    simd_float y;
+
+    x    = simd_sincos_aux(simd_abs_f(x), &j);
+    sign = simd_xor_i(sign, simd_slli_i(simd_and_i(j, simd_set1_i(4)), 29));
+    y    = simd_sincos_poly(x, simd_eq_i(simd_and_i(j, simd_set1_i(2)), simd_set1_i(0)));
+    return simd_as_f(simd_xor_i(simd_as_i(y), sign));
+}
+
+SIMD_INLINE simd_float simd_cos_f(simd_float x)
+{
+    simd_int   sign;
+    simd_int   j;
+    simd_float y;
+
+    x    = simd_sincos_aux(simd_abs_f(x), &j);
+    j    = simd_sub_i(j, simd_set1_i(2));
+    sign = simd_slli_i(simd_and_i(simd_xor_i(j, simd_set1_i(-1)), simd_set1_i(4)), 29);
+    y    = simd_sincos_poly(x, simd_eq_i(simd_and_i(j, simd_set1_i(2)), simd_set1_i(0)));
+    return simd_as_f(simd_xor_i(simd_as_i(y), sign));
+}
+
+SIMD_INLINE simd_float simd_tan_f(simd_float x) { return simd_div_f(simd_sin_f(x), simd_cos_f(x)); }
+
+SIMD_INLINE simd_float simd_atan_f(simd_float x)
+{
+    simd_int   sign = simd_and_i(simd_as_i(x), simd_set1_i((int)0x80000000));
+    simd_float y0, y, z;
+    simd_mask  big, mid;
+
+    x = simd_abs_f(x);
+
+    // Reduce in [0, tan(PI/8)]
+    big = simd_gt_f(x, simd_set1_f(2.414213562373095f));
+    mid = simd_and_m(simd_not_m(big), simd_gt_f(x, simd_set1_f(0.4142135623730950f)));
+    y0  = simd_blend_f(big, simd_set1_f(1.57079632679489661923f),
+                       simd_blend_f(mid, simd_set1_f(0.78539816339744830962f), simd_set1_f(0.f)));
+    x   = simd_blend_f(big, simd_div_f(simd_set1_f(-1.f), x),
+                       simd_blend_f(mid, simd_div_f(simd_sub_f(x, simd_set1_f(1.f)), simd_add_f(x, simd_set1_f(1.f))), x));
+    z   = simd_mul_f(x, x);
+
+    y = simd_set1_f(8.05374449538e-2f);
+    y = simd_add_f(simd_mul_f(y, z), simd_set1_f(-1.38776856032E-1f));
+    y = simd_add_f(simd_mul_f(y, z), simd_set1_f(1.99777106478E-1f));
+    y = simd_add_f(simd_mul_f(y, z), simd_set1_f(-3.33329491539E-1f));
+    y = simd_add_f(simd_add_f(simd_mul_f(simd_mul_f(y, z), x), x), y0);
+
+    return simd_as_f(simd_xor_i(simd_as_i(y), sign));
+}
+
+SIMD_INLINE simd_float simd_atan2_f(simd_float y, simd_float x)
+{
+    simd_float zero = simd_set1_f(0.f);
+    simd_float pi   = simd_set1_f(3.14159265358979323846f);
+    simd_float r    = simd_atan_f(simd_div_f(y, x));
+
+    // Left half plane
+    r = simd_blend_f(simd_lt_f(x, zero), simd_add_f(r, simd_blend_f(simd_ge_f(y, zero), pi, simd_sub_f(zero, pi))), r);
+
+    // Vertical axis
+    r = simd_blend_f(simd_and_m(simd_eq_f(x, zero), simd_gt_f(y, zero)), simd_set1_f(1.57079632679489661923f), r);
+    r = simd_blend_f(simd_and_m(simd_eq_f(x, zero), simd_lt_f(y, zero)), simd_set1_f(-1.57079632679489661923f), r);
+    return simd_blend_f(simd_and_m(simd_eq_f(x, zero), simd_eq_f(y, zero)), zero, r);
+}
+
+#endif
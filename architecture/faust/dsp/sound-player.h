@@ -390,6 +390,9 @@ class PositionManager : public GUI {
         // Add a sound_base_player (sound_memory_player or sound_dtd_player) in the PositionManager
         void addDSP(sound_base_player* dsp)
         {
+            // Both zones are also written by the player itself
+            registerPassiveZone(dsp->getCurFramesZone());
+            registerPassiveZone(dsp->getSetFramesZone());
             fFileReader[dsp] = std::make_pair(new uiCallbackItem(this, dsp->getCurFramesZone(), sound_base_player::setFrame, dsp),
                                               new uiCallbackItem(this, dsp->getSetFramesZone(), sound_base_player::setFrame, dsp));
         }
@@ -25,13 +25,14 @@
 #define __timed_dsp__
 
 #include <set>
+#include <vector>
+#include <algorithm>
 #include <float.h>
 #include <assert.h>
 
 #include "faust/dsp/dsp.h" 
 #include "faust/gui/GUI.h" 
 #include "faust/gui/DecoratorUI.h"
-#include "faust/gui/ring-buffer.h"
 
 namespace {
     
@@ -159,38 +160,107 @@ class timed_dsp : public decorator_dsp {
             return std::max<double>(0., (double(getSampleRate()) * (usec - fDateUsec)) / 1000000.);
         }
         
-        ztimedmap::iterator getNextControl(DatedControl& res)
+        /*
+         * Pending controls are kept in a min-heap (ordered by date, then zone address) holding
+         * the first value of each non-empty zone ring buffer. The heap is built once per block,
+         * then finding the next control and moving to the following value of the same zone are O(log n).
+         * The values of each zone are read in place from the span available at the beginning
+         * of the block, and released with a single 'read_advance' at the end of the block.
+         */
+        struct ZoneControl {
+            
+            double fDate;
+            FAUSTFLOAT* fZone;
+            size_t fIndex;      // Index of the zone in fZones and fSpans
+            size_t fPos;        // Position of the value in the zone span
+            
+            ZoneControl(double date = 0., FAUSTFLOAT* zone = 0, size_t index = 0, size_t pos = 0)
+            :fDate(date), fZone(zone), fIndex(index), fPos(pos)
+            {}
+            
+            // Reversed comparison since std heap functions build a max-heap
+            bool operator<(const ZoneControl& control) const
+            {
+                return (fDate > control.fDate) || ((fDate == control.fDate) && (fZone > control.fZone));
+            }
+            
+        };
+    
+        std::vector<FAUSTFLOAT*> fZones;
+        std::vector<dated_control_ring*> fRings;
+        std::vector<dated_control_ring::read_span> fSpans;
+        std::vector<ZoneControl> fControlHeap;
+        int fTimedZoneMapVersion;   // GUI::gTimedZoneMap version of the fRings pointers
+    
+        // Ring buffers are only looked up again when GUI::gTimedZoneMap has changed (since MidiUI may have been desallocated)
+        void resolveRings()
+        {
+            fTimedZoneMapVersion = GUI::timedZoneMapVersion();
+            for (size_t i = 0; i < fZones.size(); i++) {
+                ztimedmap::iterator it = GUI::gTimedZoneMap.find(fZones[i]);
+                fRings[i] = (it != GUI::gTimedZoneMap.end()) ? (*it).second : 0;
+            }
+        }
+    
+        void pushControl(size_t index, size_t pos)
+        {
+            if (pos < fSpans[index].size()) {
+                fControlHeap.push_back(ZoneControl(fSpans[index][pos].fDate, fZones[index], index, pos));
+                std::push_heap(fControlHeap.begin(), fControlHeap.end());
+            }
+        }
+    
+        void prepareControls()
         {
-            DatedControl date1(DBL_MAX, 0);
-            ztimedmap::iterator it1, it2 = GUI::gTimedZoneMap.end();
-            std::set<FAUSTFLOAT*>::iterator it3;
-              
-            // Find date of next audio slice to compute
-            for (it3 = fZoneUI.fZoneSet.begin(); it3 != fZoneUI.fZoneSet.end(); it3++) {
-                // If value list is not empty, get the date and keep the minimal one
-                it1 = GUI::gTimedZoneMap.find(*it3);
-                if (it1 != GUI::gTimedZoneMap.end()) { // Check if zone still in global GUI::gTimedZoneMap (since MidiUI may have been desallocated)
-                    DatedControl date2;
-                    if (ringbuffer_peek((*it1).second, (char*)&date2, sizeof(DatedControl)) == sizeof(DatedControl) 
-                        && date2.fDate < date1.fDate) {
-                        it2 = it1;
-                        date1 = date2;
-                    }
+            fControlHeap.clear();
+            if (fTimedZoneMapVersion != GUI::timedZoneMapVersion()) {
+                resolveRings();
+            }
+            for (size_t i = 0; i < fZones.size(); i++) {
+                if (fRings[i]) {
+                    fSpans[i] = fRings[i]->read_available();
+                    pushControl(i, 0);
+                } else {
+                    fSpans[i] = dated_control_ring::read_span();
                 }
             }
-            
-            res = date1;
-            return it2;
+        }
+    
+        // Release all values read in the block
+        void releaseControls()
+        {
+            for (size_t i = 0; i < fZones.size(); i++) {
+                if (fSpans[i].size() > 0) {
+                    fRings[i]->read_advance(fSpans[i].size());
+                    // The zone has been changed, so that GUIs reflect it
+                    GUI::markAllGuis(fZones[i]);
+                }
+            }
+        }
+    
+        // Remove the earliest control from the heap and return it, or return false if there is none
+        bool getNextControl(ZoneControl& zone_control, DatedControl& res)
+        {
+            if (fControlHeap.empty()) return false;
+            std::pop_heap(fControlHeap.begin(), fControlHeap.end());
+            zone_control = fControlHeap.back();
+            fControlHeap.pop_back();
+            res = fSpans[zone_control.fIndex][zone_control.fPos];
+            // The following value of the same zone (if any) takes its place in the heap
+            pushControl(zone_control.fIndex, zone_control.fPos + 1);
+            return true;
         }
         
         virtual void computeAux(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs, bool convert_ts)
         {
             int slice, offset = 0;
-            ztimedmap::iterator it;
+            ZoneControl zone_control;
             DatedControl next_control;
+            
+            prepareControls();
              
             // Do audio computation "slice" by "slice"
-            while ((it = getNextControl(next_control)) != GUI::gTimedZoneMap.end()) {
+            while (getNextControl(zone_control, next_control)) {
                 
                 // If needed, convert next_control in samples from begining of the buffer, possible moving to 0 (if negative)
                 if (convert_ts) {
@@ -203,21 +273,19 @@ class timed_dsp : public decorator_dsp {
                 offset += slice;
                
                 // Update control
-                ringbuffer_t* control_values = (*it).second;
-                *((*it).first) = next_control.fValue;
-                
-                // Move ringbuffer pointer
-                ringbuffer_read_advance(control_values, sizeof(DatedControl));
+                *(zone_control.fZone) = next_control.fValue;
             } 
             
             // Compute last audio slice
             slice = count - offset;
             computeSlice(offset, slice, inputs, outputs);
+            
+            releaseControls();
         }
 
     public:
 
-        timed_dsp(dsp* dsp):decorator_dsp(dsp), fDateUsec(0), fOffsetUsec(0), fFirstCallback(true)
+        timed_dsp(dsp* dsp):decorator_dsp(dsp), fDateUsec(0), fOffsetUsec(0), fFirstCallback(true), fTimedZoneMapVersion(-1)
         {
             fInputsSlice = new FAUSTFLOAT*[dsp->getNumInputs()];
             fOutputsSlice = new FAUSTFLOAT*[dsp->getNumOutputs()];
@@ -238,6 +306,11 @@ class timed_dsp : public decorator_dsp {
             fDSP->buildUserInterface(ui_interface); 
             // Only keep zones that are in GUI::gTimedZoneMap
             fDSP->buildUserInterface(&fZoneUI);
+            fZones.assign(fZoneUI.fZoneSet.begin(), fZoneUI.fZoneSet.end());
+            fRings.assign(fZones.size(), 0);
+            fSpans.assign(fZones.size(), dated_control_ring::read_span());
+            fControlHeap.reserve(fZones.size());
+            resolveRings();
         }
     
         virtual timed_dsp* clone()
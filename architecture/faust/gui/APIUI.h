@@ -355,13 +355,10 @@ class APIUI : public PathBuilder, public Meta, public UI
 		int getParamsCount() { return fNumParameters; }
         int getParamIndex(const char* path)
         {
-            if (fPathMap.find(path) != fPathMap.end()) {
-                return fPathMap[path];
-            } else if (fLabelMap.find(path) != fLabelMap.end()) {
-                return fLabelMap[path];
-            } else {
-                return -1;
-            }
+            std::map<std::string, int>::iterator it = fPathMap.find(path);
+            if (it != fPathMap.end()) return (*it).second;
+            it = fLabelMap.find(path);
+            return (it != fLabelMap.end()) ? (*it).second : -1;
         }
         const char* getParamAddress(int p) { return fPaths[p].c_str(); }
         const char* getParamLabel(int p) { return fLabels[p].c_str(); }
@@ -389,6 +386,25 @@ class APIUI : public PathBuilder, public Meta, public UI
         FAUSTFLOAT getParamValue(int p) { return *fZone[p]; }
         void setParamValue(int p, FAUSTFLOAT v) { *fZone[p] = v; }
 
+        // Resolved handle (the parameter zone) for a path or label, or 0 if not found
+        FAUSTFLOAT* getParamHandle(const char* path)
+        {
+            int p = getParamIndex(path);
+            return (p >= 0) ? fZone[p] : 0;
+        }
+        static void setParamValues(FAUSTFLOAT* const* handles, const FAUSTFLOAT* values, int n)
+        {
+            for (int i = 0; i < n; i++) {
+                *handles[i] = values[i];
+            }
+        }
+        static void getParamValues(FAUSTFLOAT* const* handles, FAUSTFLOAT* values, int n)
+        {
+            for (int i = 0; i < n; i++) {
+                values[i] = *handles[i];
+            }
+        }
+
         double getParamRatio(int p) { return fConversion[p]->faust2ui(*fZone[p]); }
         void setParamRatio(int p, double r) { *fZone[p] = fConversion[p]->ui2faust(r); }
 
@@ -444,6 +460,10 @@ class APIUI : public PathBuilder, public Meta, public UI
             }
         }
     
+        // Zones possibly changed by 'propagateAcc' for a given accelerometer
+        int getAccZonesCount(int acc) { return int(fAcc[acc].size()); }
+        FAUSTFLOAT* getAccZone(int acc, int i) { return fAcc[acc][i]->getZone(); }
+    
         /**
          * Used to edit accelerometer curves and mapping. Set curve and related mapping for a given UI parameter.
          *
@@ -521,6 +541,10 @@ class APIUI : public PathBuilder, public Meta, public UI
                 fGyr[gyr][i]->update(value);
             }
         }
+    
+        // Zones possibly changed by 'propagateGyr' for a given gyroscope
+        int getGyrZonesCount(int gyr) { return int(fGyr[gyr].size()); }
+        FAUSTFLOAT* getGyrZone(int gyr, int i) { return fGyr[gyr][i]->getZone(); }
    
         // getScreenColor() : -1 means no screen color control (no screencolor metadata found)
         // otherwise return 0x00RRGGBB a ready to use color
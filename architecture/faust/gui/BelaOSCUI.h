@@ -101,6 +101,7 @@ class BelaOSCUI : public GUI {
                 float floatArg;
                 if (msg.match(msgAdress).popFloat(floatArg).isOkNoMoreArgs() && paramIndex != -1) {
                     fAPIUI.setParamValue(paramIndex, floatArg);
+                    GUI::markAllGuis(fAPIUI.getParamZone(paramIndex));
                 // "get" message with correct address
                 } else if (msg.match("/get").isOkNoMoreArgs()) {
                     for (int p = 0; p < fAPIUI.getParamsCount(); ++p) {
@@ -0,0 +1,447 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef FAUST_BINARYUI_H
+#define FAUST_BINARYUI_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <map>
+#include <string>
+
+#include "faust/gui/UI.h"
+#include "faust/gui/PathBuilder.h"
+#include "faust/gui/meta.h"
+
+/*******************************************************************************
+ * Binary DSP description format
+ *
+ * A compact alternative to the JSON description, with the same content,
+ * designed to be used in place once loaded (see BinaryUIDecoder.h):
+ *
+ * - a header with the I/O counts, memory layout and tables positions
+ * - the UI items table, in the 'buildUserInterface' order, groups being
+ *   followed by their items then by a 'close' item
+ * - the metadata table: global metadata, then items metadata
+ * - the library list and include pathnames tables
+ * - the strings table, where all strings are null terminated
+ *
+ * All positions are byte offsets from the start of the description, strings
+ * are given by their offset in the strings table. Numbers are written in the
+ * host byte order, which is checked with the magic number when reading.
+ ******************************************************************************/
+
+struct BinaryUIFormat {
+
+    enum { kMagic = 0x53444246, kVersion = 1 };   // "FBDS" in little endian
+
+    enum ItemType { kHGroup, kVGroup, kTGroup, kVSlider, kHSlider, kNumEntry, kButton, kCheckButton,
+                    kHBargraph, kVBargraph, kSoundfile, kClose };
+
+    struct Header {
+        uint32_t fMagic;
+        uint32_t fVersion;
+        uint32_t fSize;             // of the complete description, in bytes
+        int32_t fInputs;
+        int32_t fOutputs;
+        int32_t fSRIndex;           // -1 if unknown
+        int32_t fDSPSize;           // in bytes, -1 if unknown
+        uint32_t fName;
+        uint32_t fFileName;
+        uint32_t fLibVersion;
+        uint32_t fCompileOptions;
+        uint32_t fSHAKey;
+        uint32_t fCode;
+        uint32_t fItems, fItemsSize;
+        uint32_t fMetas, fMetasSize, fGlobalMetasSize;
+        uint32_t fLists, fLibraryListSize, fIncludePathnamesSize;
+        uint32_t fStrings, fStringsSize;
+    };
+
+    struct Item {
+        int32_t fType;
+        uint32_t fLabel;
+        uint32_t fAddress;
+        uint32_t fURL;
+        int32_t fIndex;             // in the DSP memory block, -1 if unknown
+        uint32_t fMeta;             // first metadata in the metadata table
+        uint32_t fMetaSize;
+        int32_t fReserved;
+        double fInit, fMin, fMax, fStep;
+    };
+
+    struct MetaEntry {
+        uint32_t fKey;
+        uint32_t fValue;
+    };
+
+};
+
+/*******************************************************************************
+ * BinaryUI : Faust User Interface
+ * This class produces a binary description of the DSP instance, with the same
+ * content as the JSONUI one.
+ ******************************************************************************/
+
+template <typename REAL>
+class BinaryUIAux : public PathBuilder, public Meta, public UI
+{
+
+    protected:
+
+        BinaryUIFormat::Header fHeader;
+        std::vector<BinaryUIFormat::Item> fItems;
+        std::vector<BinaryUIFormat::MetaEntry> fMetas;      // Global metadata
+        std::vector<BinaryUIFormat::MetaEntry> fItemMetas;
+        std::vector<BinaryUIFormat::MetaEntry> fMetaAux;    // Metadata of the next item
+        std::vector<uint32_t> fLibraryList;
+        std::vector<uint32_t> fIncludePathnames;
+        std::string fStrings;
+        std::map<std::string, uint32_t> fStringsTable;      // Shared strings
+        std::map<std::string, int> fPathTable;
+        bool fHasName, fHasFileName;
+
+        uint32_t addString(const std::string& str)
+        {
+            std::map<std::string, uint32_t>::iterator it = fStringsTable.find(str);
+            if (it != fStringsTable.end()) return (*it).second;
+            uint32_t offset = uint32_t(fStrings.size());
+            fStrings.append(str.c_str(), str.size() + 1);
+            fStringsTable[str] = offset;
+            return offset;
+        }
+
+        int getAddressIndex(const std::string& path)
+        {
+            std::map<std::string, int>::iterator it = fPathTable.find(path);
+            return (it != fPathTable.end()) ? (*it).second : -1;
+        }
+
+        void addItem(int type, const char* label, const char* url, double init, double min, double max, double step)
+        {
+            BinaryUIFormat::Item item;
+            memset(&item, 0, sizeof(item));
+            item.fType = type;
+            item.fLabel = addString(label);
+            item.fURL = addString(url);
+            if (type == BinaryUIFormat::kClose || type <= BinaryUIFormat::kTGroup) {
+                item.fAddress = addString("");
+                item.fIndex = -1;
+            } else {
+                std::string path = buildPath(label);
+                item.fAddress = addString(path);
+                item.fIndex = getAddressIndex(path);
+            }
+            item.fMeta = uint32_t(fItemMetas.size());
+            item.fMetaSize = uint32_t(fMetaAux.size());
+            fItemMetas.insert(fItemMetas.end(), fMetaAux.begin(), fMetaAux.end());
+            fMetaAux.clear();
+            item.fInit = init;
+            item.fMin = min;
+            item.fMax = max;
+            item.fStep = step;
+            fItems.push_back(item);
+        }
+
+        static uint32_t align(uint32_t size) { return (size + 7) & ~uint32_t(7); }
+
+     public:
+
+        BinaryUIAux(const std::string& name,
+                    const std::string& filename,
+                    int inputs,
+                    int outputs,
+                    int sr_index,
+                    const std::string& sha_key,
+                    const std::string& dsp_code,
+                    const std::string& version,
+                    const std::string& compile_options,
+                    const std::vector<std::string>& library_list,
+                    const std::vector<std::string>& include_pathnames,
+                    const std::string& size,
+                    const std::map<std::string, int>& path_table)
+        {
+            init(name, filename, inputs, outputs, sr_index, sha_key, dsp_code, version, compile_options, library_list, include_pathnames, size, path_table);
+        }
+
+        BinaryUIAux(const std::string& name, const std::string& filename, int inputs, int outputs)
+        {
+            init(name, filename, inputs, outputs, -1, "", "", "", "", std::vector<std::string>(), std::vector<std::string>(), "", std::map<std::string, int>());
+        }
+
+        BinaryUIAux(int inputs, int outputs)
+        {
+            init("", "", inputs, outputs, -1, "", "", "", "", std::vector<std::string>(), std::vector<std::string>(), "", std::map<std::string, int>());
+        }
+
+        BinaryUIAux()
+        {
+            init("", "", -1, -1, -1, "", "", "", "", std::vector<std::string>(), std::vector<std::string>(), "", std::map<std::string, int>());
+        }
+
+        virtual ~BinaryUIAux() {}
+
+        void setInputs(int inputs) { fHeader.fInputs = inputs; }
+        void setOutputs(int outputs) { fHeader.fOutputs = outputs; }
+
+        void setSRIndex(int sr_index) { fHeader.fSRIndex = sr_index; }
+
+        // Init may be called multiple times so the tables are reinitialized
+        void init(const std::string& name,
+                  const std::string& filename,
+                  int inputs,
+                  int outputs,
+                  int sr_index,
+                  const std::string& sha_key,
+                  const std::string& dsp_code,
+                  const std::string& version,
+                  const std::string& compile_options,
+                  const std::vector<std::string>& library_list,
+                  const std::vector<std::string>& include_pathnames,
+                  const std::string& size,
+                  const std::map<std::string, int>& path_table)
+        {
+            fItems.clear();
+            fMetas.clear();
+            fItemMetas.clear();
+            fMetaAux.clear();
+            fLibraryList.clear();
+            fIncludePathnames.clear();
+            fStrings.clear();
+            fStringsTable.clear();
+            fControlsLevel.clear();
+
+            memset(&fHeader, 0, sizeof(fHeader));
+            fHeader.fMagic = BinaryUIFormat::kMagic;
+            fHeader.fVersion = BinaryUIFormat::kVersion;
+            fHeader.fInputs = inputs;
+            fHeader.fOutputs = outputs;
+            fHeader.fSRIndex = sr_index;
+            fHeader.fDSPSize = (size != "") ? atoi(size.c_str()) : -1;
+            fHeader.fName = addString(name);
+            fHeader.fFileName = addString(filename);
+            fHeader.fLibVersion = addString(version);
+            fHeader.fCompileOptions = addString(compile_options);
+            fHeader.fSHAKey = addString(sha_key);
+            fHeader.fCode = addString(dsp_code);
+            fHasName = (name != "");
+            fHasFileName = (filename != "");
+            for (size_t i = 0; i < library_list.size(); i++) {
+                fLibraryList.push_back(addString(library_list[i]));
+            }
+            for (size_t i = 0; i < include_pathnames.size(); i++) {
+                fIncludePathnames.push_back(addString(include_pathnames[i]));
+            }
+            fPathTable = path_table;
+        }
+
+        // -- widget's layouts
+
+        virtual void openTabBox(const char* label)
+        {
+            addItem(BinaryUIFormat::kTGroup, label, "", 0, 0, 0, 0);
+            pushLabel(label);
+        }
+
+        virtual void openHorizontalBox(const char* label)
+        {
+            addItem(BinaryUIFormat::kHGroup, label, "", 0, 0, 0, 0);
+            pushLabel(label);
+        }
+
+        virtual void openVerticalBox(const char* label)
+        {
+            addItem(BinaryUIFormat::kVGroup, label, "", 0, 0, 0, 0);
+            pushLabel(label);
+        }
+
+        virtual void closeBox()
+        {
+            popLabel();
+            addItem(BinaryUIFormat::kClose, "", "", 0, 0, 0, 0);
+        }
+
+        // -- active widgets
+
+        virtual void addButton(const char* label, REAL* zone)
+        {
+            addItem(BinaryUIFormat::kButton, label, "", 0, 0, 0, 0);
+        }
+
+        virtual void addCheckButton(const char* label, REAL* zone)
+        {
+            addItem(BinaryUIFormat::kCheckButton, label, "", 0, 0, 0, 0);
+        }
+
+        virtual void addVerticalSlider(const char* label, REAL* zone, REAL init, REAL min, REAL max, REAL step)
+        {
+            addItem(BinaryUIFormat::kVSlider, label, "", init, min, max, step);
+        }
+
+        virtual void addHorizontalSlider(const char* label, REAL* zone, REAL init, REAL min, REAL max, REAL step)
+        {
+            addItem(BinaryUIFormat::kHSlider, label, "", init, min, max, step);
+        }
+
+        virtual void addNumEntry(const char* label, REAL* zone, REAL init, REAL min, REAL max, REAL step)
+        {
+            addItem(BinaryUIFormat::kNumEntry, label, "", init, min, max, step);
+        }
+
+        // -- passive widgets
+
+        virtual void addHorizontalBargraph(const char* label, REAL* zone, REAL min, REAL max)
+        {
+            addItem(BinaryUIFormat::kHBargraph, label, "", 0, min, max, 0);
+        }
+
+        virtual void addVerticalBargraph(const char* label, REAL* zone, REAL min, REAL max)
+        {
+            addItem(BinaryUIFormat::kVBargraph, label, "", 0, min, max, 0);
+        }
+
+        virtual void addSoundfile(const char* label, const char* url, Soundfile** zone)
+        {
+            addItem(BinaryUIFormat::kSoundfile, label, url, 0, 0, 0, 0);
+        }
+
+        // -- metadata declarations
+
+        virtual void declare(REAL* zone, const char* key, const char* val)
+        {
+            BinaryUIFormat::MetaEntry meta = { addString(key), addString(val) };
+            fMetaAux.push_back(meta);
+        }
+
+        // Meta interface
+        virtual void declare(const char* key, const char* value)
+        {
+            // Name and filename found in metadata
+            if ((strcmp(key, "name") == 0) && !fHasName) {
+                fHeader.fName = addString(value);
+                fHasName = true;
+            }
+            if ((strcmp(key, "filename") == 0) && !fHasFileName) {
+                fHeader.fFileName = addString(value);
+                fHasFileName = true;
+            }
+            BinaryUIFormat::MetaEntry meta = { addString(key), addString(value) };
+            fMetas.push_back(meta);
+        }
+
+        // The complete description
+        std::string binary()
+        {
+            BinaryUIFormat::Header header = fHeader;
+            uint32_t offset = align(sizeof(BinaryUIFormat::Header));
+            header.fItems = offset;
+            header.fItemsSize = uint32_t(fItems.size());
+            offset += align(uint32_t(sizeof(BinaryUIFormat::Item) * fItems.size()));
+            header.fMetas = offset;
+            header.fMetasSize = uint32_t(fMetas.size() + fItemMetas.size());
+            header.fGlobalMetasSize = uint32_t(fMetas.size());
+            offset += align(uint32_t(sizeof(BinaryUIFormat::MetaEntry) * header.fMetasSize));
+            header.fLists = offset;
+            header.fLibraryListSize = uint32_t(fLibraryList.size());
+            header.fIncludePathnamesSize = uint32_t(fIncludePathnames.size());
+            offset += align(uint32_t(sizeof(uint32_t) * (fLibraryList.size() + fIncludePathnames.size())));
+            header.fStrings = offset;
+            header.fStringsSize = uint32_t(fStrings.size());
+            header.fSize = align(offset + header.fStringsSize);
+
+            std::string res(header.fSize, '\0');
+            char* data = &res[0];
+            memcpy(data, &header, sizeof(header));
+            if (fItems.size() > 0) {
+                // Items metadata follow the global ones
+                std::vector<BinaryUIFormat::Item> items = fItems;
+                for (size_t i = 0; i < items.size(); i++) {
+                    items[i].fMeta += header.fGlobalMetasSize;
+                }
+                memcpy(data + header.fItems, items.data(), sizeof(BinaryUIFormat::Item) * items.size());
+            }
+            if (fMetas.size() > 0) {
+                memcpy(data + header.fMetas, fMetas.data(), sizeof(BinaryUIFormat::MetaEntry) * fMetas.size());
+            }
+            if (fItemMetas.size() > 0) {
+                memcpy(data + header.fMetas + sizeof(BinaryUIFormat::MetaEntry) * fMetas.size(),
+                       fItemMetas.data(), sizeof(BinaryUIFormat::MetaEntry) * fItemMetas.size());
+            }
+            if (fLibraryList.size() > 0) {
+                memcpy(data + header.fLists, fLibraryList.data(), sizeof(uint32_t) * fLibraryList.size());
+            }
+            if (fIncludePathnames.size() > 0) {
+                memcpy(data + header.fLists + sizeof(uint32_t) * fLibraryList.size(),
+                       fIncludePathnames.data(), sizeof(uint32_t) * fIncludePathnames.size());
+            }
+            memcpy(data + header.fStrings, fStrings.data(), fStrings.size());
+            return res;
+        }
+
+};
+
+// Externally available class using FAUSTFLOAT
+
+class BinaryUI : public BinaryUIAux<FAUSTFLOAT>
+{
+    public :
+
+        BinaryUI(const std::string& name,
+                 const std::string& filename,
+                 int inputs,
+                 int outputs,
+                 int sr_index,
+                 const std::string& sha_key,
+                 const std::string& dsp_code,
+                 const std::string& version,
+                 const std::string& compile_options,
+                 const std::vector<std::string>& library_list,
+                 const std::vector<std::string>& include_pathnames,
+                 const std::string& size,
+                 const std::map<std::string, int>& path_table):
+        BinaryUIAux<FAUSTFLOAT>(name, filename,
+                                inputs, outputs,
+                                sr_index,
+                                sha_key, dsp_code,
+                                version, compile_options,
+                                library_list, include_pathnames,
+                                size, path_table)
+        {}
+
+        BinaryUI(const std::string& name, const std::string& filename, int inputs, int outputs):
+        BinaryUIAux<FAUSTFLOAT>(name, filename, inputs, outputs)
+        {}
+
+        BinaryUI(int inputs, int outputs):BinaryUIAux<FAUSTFLOAT>(inputs, outputs)
+        {}
+
+        BinaryUI():BinaryUIAux<FAUSTFLOAT>()
+        {}
+
+        virtual ~BinaryUI() {}
+
+};
+
+#endif // FAUST_BINARYUI_H
@@ -0,0 +1,473 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __BinaryUIDecoder__
+#define __BinaryUIDecoder__
+
+#include <stdint.h>
+#include <string.h>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "faust/gui/BinaryUI.h"
+#include "faust/gui/JSONUIDecoder.h"
+#include "faust/gui/JSONUIStreamDecoder.h"
+
+//--------------------------------------------------------------------------------------
+//  Use a binary dsp description (see BinaryUI.h) and implement 'buildUserInterface',
+//  with the same API as JSONUIDecoderAux.
+//
+//  The description is copied in a single allocation, also holding the controls,
+//  and is then used in place: decoding only checks that the header and the tables
+//  are consistent. A 'std::bad_alloc' exception is thrown on an invalid description.
+//--------------------------------------------------------------------------------------
+
+template <typename REAL>
+struct BinaryUIDecoderAux {
+
+    char* fData;
+    const BinaryUIFormat::Header* fHeader;
+    const BinaryUIFormat::Item* fItems;
+    const BinaryUIFormat::MetaEntry* fMetas;
+    const uint32_t* fLists;
+    const char* fStrings;
+
+    int* fZones;            // in fInControl, fOutControl or fSoundfiles, depending of the type
+    REAL* fInControl;
+    REAL* fOutControl;
+    Soundfile** fSoundfiles;
+
+    int fNumInputs, fNumOutputs, fSRIndex;
+    int fDSPSize;
+
+    static bool isInput(int type) { return (type >= BinaryUIFormat::kVSlider && type <= BinaryUIFormat::kCheckButton); }
+    static bool isOutput(int type) { return (type == BinaryUIFormat::kHBargraph || type == BinaryUIFormat::kVBargraph); }
+    static bool isSoundfile(int type) { return (type == BinaryUIFormat::kSoundfile); }
+
+    static size_t align(size_t size) { return (size + 15) & ~size_t(15); }
+
+    BinaryUIDecoderAux(const std::string& binary)
+    {
+        init(binary.data(), binary.size());
+    }
+
+    BinaryUIDecoderAux(const char* data, size_t size)
+    {
+        init(data, size);
+    }
+
+    virtual ~BinaryUIDecoderAux()
+    {
+        delete [] fData;
+    }
+
+    // Check the header and the tables bounds
+    static bool check(const char* data, size_t size)
+    {
+        if (size < sizeof(BinaryUIFormat::Header)) return false;
+        BinaryUIFormat::Header header;
+        memcpy(&header, data, sizeof(header));
+        if (header.fMagic != BinaryUIFormat::kMagic || header.fVersion != BinaryUIFormat::kVersion || header.fSize > size) {
+            return false;
+        }
+        uint64_t end = header.fSize;
+        if (uint64_t(header.fItems) + uint64_t(header.fItemsSize) * sizeof(BinaryUIFormat::Item) > end
+            || uint64_t(header.fMetas) + uint64_t(header.fMetasSize) * sizeof(BinaryUIFormat::MetaEntry) > end
+            || uint64_t(header.fLists) + (uint64_t(header.fLibraryListSize) + header.fIncludePathnamesSize) * sizeof(uint32_t) > end
+            || uint64_t(header.fStrings) + header.fStringsSize > end
+            || header.fGlobalMetasSize > header.fMetasSize
+            || header.fStringsSize == 0 || data[header.fStrings + header.fStringsSize - 1] != 0
+            || (header.fItems % 8) != 0 || (header.fMetas % 4) != 0 || (header.fLists % 4) != 0) {
+            return false;
+        }
+        return true;
+    }
+
+    void init(const char* data, size_t size)
+    {
+        if (!check(data, size)) {
+            std::cerr << "BinaryUIDecoder : invalid description" << std::endl;
+            throw std::bad_alloc();
+        }
+        const BinaryUIFormat::Header* header = reinterpret_cast<const BinaryUIFormat::Header*>(data);
+        size_t items = header->fItemsSize;
+        size_t data_size = align(header->fSize);
+        fData = new char[data_size + align(sizeof(int) * items) + align(sizeof(REAL) * items) + sizeof(Soundfile*) * items];
+        memcpy(fData, data, header->fSize);
+
+        fHeader = reinterpret_cast<const BinaryUIFormat::Header*>(fData);
+        fItems = reinterpret_cast<const BinaryUIFormat::Item*>(fData + fHeader->fItems);
+        fMetas = reinterpret_cast<const BinaryUIFormat::MetaEntry*>(fData + fHeader->fMetas);
+        fLists = reinterpret_cast<const uint32_t*>(fData + fHeader->fLists);
+        fStrings = fData + fHeader->fStrings;
+        fNumInputs = fHeader->fInputs;
+        fNumOutputs = fHeader->fOutputs;
+        fSRIndex = fHeader->fSRIndex;
+        fDSPSize = fHeader->fDSPSize;
+
+        // Check the items strings and metadata, and give its zone to each control
+        char* arena = fData + data_size;
+        fZones = reinterpret_cast<int*>(arena);
+        arena += align(sizeof(int) * items);
+        int inputs = 0, outputs = 0, soundfiles = 0;
+        for (size_t i = 0; i < items; i++) {
+            const BinaryUIFormat::Item& item = fItems[i];
+            if (item.fType < BinaryUIFormat::kHGroup || item.fType > BinaryUIFormat::kClose
+                || item.fLabel >= fHeader->fStringsSize || item.fAddress >= fHeader->fStringsSize || item.fURL >= fHeader->fStringsSize
+                || uint64_t(item.fMeta) + item.fMetaSize > fHeader->fMetasSize) {
+                delete [] fData;
+                std::cerr << "BinaryUIDecoder : invalid item " << i << std::endl;
+                throw std::bad_alloc();
+            }
+            fZones[i] = isInput(item.fType) ? inputs++ : isOutput(item.fType) ? outputs++ : isSoundfile(item.fType) ? soundfiles++ : -1;
+        }
+        for (size_t i = 0; i < fHeader->fMetasSize; i++) {
+            if (fMetas[i].fKey >= fHeader->fStringsSize || fMetas[i].fValue >= fHeader->fStringsSize) {
+                delete [] fData;
+                std::cerr << "BinaryUIDecoder : invalid metadata " << i << std::endl;
+                throw std::bad_alloc();
+            }
+        }
+        for (size_t i = 0; i < fHeader->fLibraryListSize + fHeader->fIncludePathnamesSize; i++) {
+            if (fLists[i] >= fHeader->fStringsSize) {
+                delete [] fData;
+                std::cerr << "BinaryUIDecoder : invalid list " << i << std::endl;
+                throw std::bad_alloc();
+            }
+        }
+
+        fInControl = reinterpret_cast<REAL*>(arena);
+        fOutControl = fInControl + inputs;
+        arena += align(sizeof(REAL) * items);
+        fSoundfiles = reinterpret_cast<Soundfile**>(arena);
+        for (size_t i = 0; i < items; i++) {
+            if (isInput(fItems[i].fType)) {
+                fInControl[fZones[i]] = REAL(fItems[i].fInit);
+            } else if (isOutput(fItems[i].fType)) {
+                fOutControl[fZones[i]] = REAL(0);
+            } else if (isSoundfile(fItems[i].fType)) {
+                fSoundfiles[fZones[i]] = 0;
+            }
+        }
+    }
+
+    const char* getString(uint32_t offset) { return fStrings + offset; }
+
+    std::string getName() { return getString(fHeader->fName); }
+    std::string getFileName() { return getString(fHeader->fFileName); }
+    std::string getLibVersion() { return getString(fHeader->fLibVersion); }
+    std::string getCompileOptions() { return getString(fHeader->fCompileOptions); }
+    std::string getSHAKey() { return getString(fHeader->fSHAKey); }
+
+    std::vector<std::string> getLibraryList()
+    {
+        std::vector<std::string> list;
+        for (uint32_t i = 0; i < fHeader->fLibraryListSize; i++) {
+            list.push_back(getString(fLists[i]));
+        }
+        return list;
+    }
+
+    std::vector<std::string> getIncludePathnames()
+    {
+        std::vector<std::string> list;
+        for (uint32_t i = fHeader->fLibraryListSize; i < fHeader->fLibraryListSize + fHeader->fIncludePathnamesSize; i++) {
+            list.push_back(getString(fLists[i]));
+        }
+        return list;
+    }
+
+    void metadata(Meta* m)
+    {
+        for (uint32_t i = 0; i < fHeader->fGlobalMetasSize; i++) {
+            m->declare(getString(fMetas[i].fKey), getString(fMetas[i].fValue));
+        }
+    }
+
+    void metadata(MetaGlue* m)
+    {
+        for (uint32_t i = 0; i < fHeader->fGlobalMetasSize; i++) {
+            m->declare(m->metaInterface, getString(fMetas[i].fKey), getString(fMetas[i].fValue));
+        }
+    }
+
+    void resetUserInterface()
+    {
+        for (uint32_t i = 0; i < fHeader->fItemsSize; i++) {
+            if (isInput(fItems[i].fType)) {
+                fInControl[fZones[i]] = REAL(fItems[i].fInit);
+            }
+        }
+    }
+
+    void resetUserInterface(char* memory_block, Soundfile* defaultsound = nullptr)
+    {
+        for (uint32_t i = 0; i < fHeader->fItemsSize; i++) {
+            int offset = fItems[i].fIndex;
+            if (isInput(fItems[i].fType)) {
+                *REAL_ADR(offset) = REAL(fItems[i].fInit);
+            } else if (isSoundfile(fItems[i].fType)) {
+                if (*SOUNDFILE_ADR(offset) == nullptr) {
+                    *SOUNDFILE_ADR(offset) = defaultsound;
+                }
+            }
+        }
+    }
+
+    int getSampleRate(char* memory_block)
+    {
+        return *reinterpret_cast<int*>(&memory_block[fSRIndex]);
+    }
+
+    // Controls zones are given by 'zone', soundfiles by 'sound'
+    void buildItem(UI* ui_interface, const BinaryUIFormat::Item& item, REAL* zone, Soundfile** sound)
+    {
+        for (uint32_t i = item.fMeta; i < item.fMeta + item.fMetaSize; i++) {
+            REAL_UI(ui_interface)->declare(zone, getString(fMetas[i].fKey), getString(fMetas[i].fValue));
+        }
+        const char* label = getString(item.fLabel);
+        switch (item.fType) {
+            case BinaryUIFormat::kHGroup:
+                REAL_UI(ui_interface)->openHorizontalBox(label);
+                break;
+            case BinaryUIFormat::kVGroup:
+                REAL_UI(ui_interface)->openVerticalBox(label);
+                break;
+            case BinaryUIFormat::kTGroup:
+                REAL_UI(ui_interface)->openTabBox(label);
+                break;
+            case BinaryUIFormat::kVSlider:
+                REAL_UI(ui_interface)->addVerticalSlider(label, zone, REAL(item.fInit), REAL(item.fMin), REAL(item.fMax), REAL(item.fStep));
+                break;
+            case BinaryUIFormat::kHSlider:
+                REAL_UI(ui_interface)->addHorizontalSlider(label, zone, REAL(item.fInit), REAL(item.fMin), REAL(item.fMax), REAL(item.fStep));
+                break;
+            case BinaryUIFormat::kNumEntry:
+                REAL_UI(ui_interface)->addNumEntry(label, zone, REAL(item.fInit), REAL(item.fMin), REAL(item.fMax), REAL(item.fStep));
+                break;
+            case BinaryUIFormat::kButton:
+                REAL_UI(ui_interface)->addButton(label, zone);
+                break;
+            case BinaryUIFormat::kCheckButton:
+                REAL_UI(ui_interface)->addCheckButton(label, zone);
+                break;
+            case BinaryUIFormat::kHBargraph:
+                REAL_UI(ui_interface)->addHorizontalBargraph(label, zone, REAL(item.fMin), REAL(item.fMax));
+                break;
+            case BinaryUIFormat::kVBargraph:
+                REAL_UI(ui_interface)->addVerticalBargraph(label, zone, REAL(item.fMin), REAL(item.fMax));
+                break;
+            case BinaryUIFormat::kSoundfile:
+                REAL_UI(ui_interface)->addSoundfile(label, getString(item.fURL), sound);
+                break;
+            case BinaryUIFormat::kClose:
+                REAL_UI(ui_interface)->closeBox();
+                break;
+        }
+    }
+
+    void buildUserInterface(UI* ui_interface)
+    {
+        for (uint32_t i = 0; i < fHeader->fItemsSize; i++) {
+            const BinaryUIFormat::Item& item = fItems[i];
+            REAL* zone = 0;
+            if (isInput(item.fType)) {
+                zone = &fInControl[fZones[i]];
+                *zone = REAL(item.fInit);
+            } else if (isOutput(item.fType)) {
+                zone = &fOutControl[fZones[i]];
+            }
+            buildItem(ui_interface, item, zone, isSoundfile(item.fType) ? &fSoundfiles[fZones[i]] : 0);
+        }
+    }
+
+    void buildUserInterface(UI* ui_interface, char* memory_block)
+    {
+        for (uint32_t i = 0; i < fHeader->fItemsSize; i++) {
+            const BinaryUIFormat::Item& item = fItems[i];
+            REAL* zone = 0;
+            if (isInput(item.fType)) {
+                zone = REAL_ADR(item.fIndex);
+                *zone = REAL(item.fInit);
+            } else if (isOutput(item.fType)) {
+                zone = REAL_ADR(item.fIndex);
+            }
+            buildItem(ui_interface, item, zone, isSoundfile(item.fType) ? SOUNDFILE_ADR(item.fIndex) : 0);
+        }
+    }
+
+    // Not implemented, as in JSONUIDecoderAux
+    void buildUserInterface(UIGlue* ui_interface, char* memory_block)
+    {}
+
+    bool hasCompileOption(const std::string& option)
+    {
+        return JSONUIStreamDecoderAux<REAL>::hasCompileOption(getString(fHeader->fCompileOptions), option);
+    }
+
+};
+
+// Templated decoders
+
+struct BinaryUIFloatDecoder : public BinaryUIDecoderAux<float>, public JSONUITemplatedDecoder
+{
+    BinaryUIFloatDecoder(const char* data, size_t size):BinaryUIDecoderAux<float>(data, size)
+    {}
+
+    void metadata(Meta* m) { BinaryUIDecoderAux<float>::metadata(m); }
+    void metadata(MetaGlue* glue) { BinaryUIDecoderAux<float>::metadata(glue); }
+    int getDSPSize() { return fDSPSize; }
+    std::string getLibVersion() { return BinaryUIDecoderAux<float>::getLibVersion(); }
+    std::string getCompileOptions() { return BinaryUIDecoderAux<float>::getCompileOptions(); }
+    std::vector<std::string> getLibraryList() { return BinaryUIDecoderAux<float>::getLibraryList(); }
+    std::vector<std::string> getIncludePathnames() { return BinaryUIDecoderAux<float>::getIncludePathnames(); }
+    int getNumInputs() { return fNumInputs; }
+    int getNumOutputs() { return fNumOutputs; }
+    int getSampleRate(char* memory_block) { return BinaryUIDecoderAux<float>::getSampleRate(memory_block); }
+    void resetUserInterface(char* memory_block, Soundfile* defaultsound = nullptr)
+    {
+        BinaryUIDecoderAux<float>::resetUserInterface(memory_block, defaultsound);
+    }
+    void buildUserInterface(UI* ui_interface, char* memory_block)
+    {
+        BinaryUIDecoderAux<float>::buildUserInterface(ui_interface, memory_block);
+    }
+    void buildUserInterface(UIGlue* ui_interface, char* memory_block)
+    {
+        BinaryUIDecoderAux<float>::buildUserInterface(ui_interface, memory_block);
+    }
+    bool hasCompileOption(const std::string& option) { return BinaryUIDecoderAux<float>::hasCompileOption(option); }
+};
+
+struct BinaryUIDoubleDecoder : public BinaryUIDecoderAux<double>, public JSONUITemplatedDecoder
+{
+    BinaryUIDoubleDecoder(const char* data, size_t size):BinaryUIDecoderAux<double>(data, size)
+    {}
+
+    void metadata(Meta* m) { BinaryUIDecoderAux<double>::metadata(m); }
+    void metadata(MetaGlue* glue) { BinaryUIDecoderAux<double>::metadata(glue); }
+    int getDSPSize() { return fDSPSize; }
+    std::string getLibVersion() { return BinaryUIDecoderAux<double>::getLibVersion(); }
+    std::string getCompileOptions() { return BinaryUIDecoderAux<double>::getCompileOptions(); }
+    std::vector<std::string> getLibraryList() { return BinaryUIDecoderAux<double>::getLibraryList(); }
+    std::vector<std::string> getIncludePathnames() { return BinaryUIDecoderAux<double>::getIncludePathnames(); }
+    int getNumInputs() { return fNumInputs; }
+    int getNumOutputs() { return fNumOutputs; }
+    int getSampleRate(char* memory_block) { return BinaryUIDecoderAux<double>::getSampleRate(memory_block); }
+    void resetUserInterface(char* memory_block, Soundfile* defaultsound = nullptr)
+    {
+        BinaryUIDecoderAux<double>::resetUserInterface(memory_block, defaultsound);
+    }
+    void buildUserInterface(UI* ui_interface, char* memory_block)
+    {
+        BinaryUIDecoderAux<double>::buildUserInterface(ui_interface, memory_block);
+    }
+    void buildUserInterface(UIGlue* ui_interface, char* memory_block)
+    {
+        BinaryUIDecoderAux<double>::buildUserInterface(ui_interface, memory_block);
+    }
+    bool hasCompileOption(const std::string& option) { return BinaryUIDecoderAux<double>::hasCompileOption(option); }
+};
+
+// FAUSTFLOAT decoder
+
+struct BinaryUIDecoder : public BinaryUIDecoderAux<FAUSTFLOAT>
+{
+    BinaryUIDecoder(const std::string& binary):BinaryUIDecoderAux<FAUSTFLOAT>(binary)
+    {}
+
+    BinaryUIDecoder(const char* data, size_t size):BinaryUIDecoderAux<FAUSTFLOAT>(data, size)
+    {}
+};
+
+static JSONUITemplatedDecoder* createBinaryUIDecoder(const char* data, size_t size)
+{
+    if (!BinaryUIDecoderAux<float>::check(data, size)) {
+        std::cerr << "BinaryUIDecoder : invalid description" << std::endl;
+        throw std::bad_alloc();
+    }
+    BinaryUIFormat::Header header;
+    memcpy(&header, data, sizeof(header));
+    const char* options = data + header.fStrings + header.fCompileOptions;
+    if (header.fCompileOptions < header.fStringsSize && JSONUIStreamDecoderAux<float>::hasCompileOption(options, "-double")) {
+        return new BinaryUIDoubleDecoder(data, size);
+    } else {
+        return new BinaryUIFloatDecoder(data, size);
+    }
+}
+
+// Convert a JSON description to a binary one, items indexes being kept if the JSON gives the DSP size.
+// Items are directly added from the decoded JSON, so that values are kept in double precision.
+
+class BinaryUIConverter : public BinaryUI
+{
+
+    public:
+
+        std::string convert(const std::string& json)
+        {
+            JSONUIStreamDecoderAux<double> decoder(json);
+            std::map<std::string, int> path_table;
+            std::stringstream size;
+            if (decoder.fDSPSize >= 0) {
+                size << decoder.fDSPSize;
+                for (int i = 0; i < decoder.fItemsSize; i++) {
+                    if (decoder.fItems[i].fAddress[0] != 0) {
+                        path_table[decoder.fItems[i].fAddress] = decoder.fItems[i].fIndex;
+                    }
+                }
+            }
+            init(decoder.fName, decoder.fFileName,
+                 decoder.fNumInputs, decoder.fNumOutputs,
+                 decoder.fSRIndex,
+                 "", "",
+                 decoder.fVersion, decoder.fCompileOptions,
+                 decoder.getLibraryList(), decoder.getIncludePathnames(),
+                 size.str(), path_table);
+            decoder.metadata(this);
+            for (int i = 0; i < decoder.fItemsSize; i++) {
+                const JSONUIStreamDecoderAux<double>::itemView& item = decoder.fItems[i];
+                if (item.fType == JSONUIStreamDecoderAux<double>::kUnknown) continue;
+                for (int m = item.fMeta; m < item.fMeta + item.fMetaSize; m++) {
+                    declare(nullptr, decoder.fMetas[m].fKey, decoder.fMetas[m].fValue);
+                }
+                // Both item types enumerations have the same order
+                int type = item.fType - JSONUIStreamDecoderAux<double>::kHGroup;
+                if (type == BinaryUIFormat::kClose) popLabel();
+                addItem(type, item.fLabel, item.fURL, item.fInit, item.fMin, item.fMax, item.fStep);
+                if (type <= BinaryUIFormat::kTGroup) pushLabel(item.fLabel);
+            }
+            return binary();
+        }
+
+};
+
+static std::string createBinaryDescription(const std::string& json)
+{
+    BinaryUIConverter converter;
+    return converter.convert(json);
+}
+
+#endif
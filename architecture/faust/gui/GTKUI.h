@@ -1229,6 +1229,7 @@ struct uiBargraph : public uiItem
 
 void GTKUI::addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT lo, FAUSTFLOAT hi)
 {
+    registerPassiveZone(zone);
     GtkWidget* pb = gtk_progress_bar_new();
     gtk_progress_bar_set_orientation(GTK_PROGRESS_BAR(pb), GTK_PROGRESS_BOTTOM_TO_TOP);
     gtk_widget_set_size_request(pb, 8, -1);
@@ -1248,6 +1249,7 @@ void GTKUI::addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT
     
 void GTKUI::addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT lo, FAUSTFLOAT hi)
 {
+    registerPassiveZone(zone);
     GtkWidget* pb = gtk_progress_bar_new();
     gtk_progress_bar_set_orientation(GTK_PROGRESS_BAR(pb), GTK_PROGRESS_LEFT_TO_RIGHT);
     gtk_widget_set_size_request(pb, -1, 8);
@@ -24,10 +24,16 @@
 #ifndef __GUI_H__
 #define __GUI_H__
 
+#include <stdint.h>
 #include <list>
 #include <map>
 #include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm>
 #include <iostream>
+#include <mutex>
+#include <set>
 
 #ifdef _WIN32
 # pragma warning (disable: 4100)
@@ -36,7 +42,7 @@
 #endif
 
 #include "faust/gui/UI.h"
-#include "faust/gui/ring-buffer.h"
+#include "faust/gui/spsc-ring-buffer.h"
 
 /*******************************************************************************
  * GUI : Abstract Graphic User Interface
@@ -81,7 +87,119 @@ static void createUiCallbackItem(GUI* ui, FAUSTFLOAT* zone, uiCallback foo, void
 
 typedef std::map<FAUSTFLOAT*, clist*> zmap;
 
-typedef std::map<FAUSTFLOAT*, ringbuffer_t*> ztimedmap;
+/**
+ *  For timestamped control
+ */
+
+struct DatedControl {
+    
+    double fDate;
+    FAUSTFLOAT fValue;
+    
+    DatedControl(double d = 0., FAUSTFLOAT v = FAUSTFLOAT(0)):fDate(d), fValue(v) {}
+    
+};
+
+typedef spsc_ring_buffer<DatedControl> dated_control_ring;
+
+typedef std::map<FAUSTFLOAT*, dated_control_ring*> ztimedmap;
+
+/**
+ * Set of 'dirty' zone bits: bits can be set by any thread (without lock or allocation),
+ * and are collected (that is read and cleared) by the UI thread. A second level of bits
+ * tells which words have been set, so that collecting only visits the set bits.
+ */
+
+class zone_bitset
+{
+    
+    private:
+    
+        std::unique_ptr<std::atomic<uint32_t>[]> fWords;
+        std::unique_ptr<std::atomic<uint32_t>[]> fSummary;  // One bit per word of fWords
+        int fWordsCount;
+        int fSummaryCount;
+    
+    public:
+    
+        zone_bitset():fWordsCount(0), fSummaryCount(0)
+        {}
+    
+        // To be called when no other thread uses the set, all bits are set
+        void resize(int size)
+        {
+            fWordsCount = (size + 31) / 32;
+            fSummaryCount = (fWordsCount + 31) / 32;
+            fWords.reset(new std::atomic<uint32_t>[fWordsCount]);
+            fSummary.reset(new std::atomic<uint32_t>[fSummaryCount]);
+            for (int i = 0; i < fWordsCount; i++) {
+                fWords[i].store((i < size / 32) ? 0xFFFFFFFF : (uint32_t(1) << (size & 31)) - 1);
+            }
+            for (int i = 0; i < fSummaryCount; i++) {
+                fSummary[i].store(0xFFFFFFFF);
+            }
+        }
+    
+        void set(int index)
+        {
+            int word = index >> 5;
+            fWords[word].fetch_or(uint32_t(1) << (index & 31), std::memory_order_release);
+            fSummary[word >> 5].fetch_or(uint32_t(1) << (word & 31), std::memory_order_release);
+        }
+    
+        // Call 'fun(arg, index)' for each set bit (in increasing order), and clear them
+        template <typename FUN, typename ARG>
+        void collect(FUN fun, ARG arg)
+        {
+            for (int s = 0; s < fSummaryCount; s++) {
+                // A word marked after its summary bit has been cleared is collected on next call
+                uint32_t words = fSummary[s].exchange(0, std::memory_order_acquire);
+                for (int w = s * 32; words; w++, words >>= 1) {
+                    if (!(words & 1) || w >= fWordsCount) continue;
+                    uint32_t bits = fWords[w].exchange(0, std::memory_order_acquire);
+                    for (int i = w * 32; bits; i++, bits >>= 1) {
+                        if (bits & 1) fun(arg, i);
+                    }
+                }
+            }
+        }
+    
+};
+
+/**
+ * Contiguous zone table, built from the GUI zone map (so sorted by zone address):
+ * zone 'i' items are fItems[fItemOffsets[i]] to fItems[fItemOffsets[i + 1] - 1].
+ * A table is immutable once published (except its dirty bits and passive values),
+ * so that writers can mark zones from any thread while the UI thread reflects them.
+ */
+
+struct zone_table
+{
+    
+    std::vector<FAUSTFLOAT*> fZones;
+    std::vector<uiItemBase*> fItems;
+    std::vector<int> fItemOffsets;
+    std::vector<int> fPassiveZones;             // Zones written by the DSP (like bargraphs)
+    std::vector<FAUSTFLOAT> fPassiveValues;     // Their last reflected values
+    zone_bitset fDirtyZones;
+    
+    int getZoneIndex(FAUSTFLOAT* zone) const
+    {
+        std::vector<FAUSTFLOAT*>::const_iterator it = std::lower_bound(fZones.begin(), fZones.end(), zone);
+        return (it != fZones.end() && *it == zone) ? int(it - fZones.begin()) : -1;
+    }
+    
+    void reflectZone(int index)
+    {
+        FAUSTFLOAT v = *fZones[index];
+        for (int c = fItemOffsets[index]; c < fItemOffsets[index + 1]; c++) {
+            if (fItems[c]->cache() != v) fItems[c]->reflectZone();
+        }
+    }
+    
+    static void reflectTableZone(zone_table* table, int index) { table->reflectZone(index); }
+    
+};
 
 class GUI : public UI
 {
@@ -91,10 +209,64 @@ class GUI : public UI
         static std::list<GUI*> fGuiList;
         zmap fZoneMap;
         bool fStopped;
+    
+        /*
+         The zone table is rebuilt (on the next update) when zones are registered. Old tables are kept
+         until the GUI is deleted, since writers of other threads may still be marking them.
+         */
+        std::atomic<zone_table*> fTable;
+        std::vector<std::unique_ptr<zone_table> > fTables;
+        std::atomic<bool> fTableChanged;
+        std::mutex fTableMutex;             // Serializes the table building and the zones registration
+        std::set<FAUSTFLOAT*> fPassiveZones;
+    
+        zone_table* getZoneTable()
+        {
+            if (fTableChanged.load(std::memory_order_acquire)) {
+                std::lock_guard<std::mutex> lock(fTableMutex);
+                if (fTableChanged.load(std::memory_order_relaxed)) {
+                    zone_table* table = new zone_table();
+                    table->fItemOffsets.assign(1, 0);
+                    for (zmap::iterator it = fZoneMap.begin(); it != fZoneMap.end(); it++) {
+                        if ((*it).first) {
+                            if (fPassiveZones.count((*it).first)) {
+                                table->fPassiveZones.push_back(int(table->fZones.size()));
+                                table->fPassiveValues.push_back(*(*it).first);
+                            }
+                            table->fZones.push_back((*it).first);
+                            table->fItems.insert(table->fItems.end(), (*it).second->begin(), (*it).second->end());
+                            table->fItemOffsets.push_back(int(table->fItems.size()));
+                        }
+                    }
+                    // All zones are reflected on next update
+                    table->fDirtyZones.resize(int(table->fZones.size()));
+                    fTables.push_back(std::unique_ptr<zone_table>(table));
+                    fTable.store(table, std::memory_order_release);
+                    fTableChanged.store(false, std::memory_order_release);
+                }
+            }
+            return fTable.load(std::memory_order_acquire);
+        }
+    
+    protected:
+    
+        /**
+         * Register a zone written by the DSP (like a bargraph one): its value is compared with the last
+         * reflected one on each update, since it is not marked by a writer. To be called by the GUIs
+         * which reflect bargraphs (typically in 'addHorizontalBargraph' and 'addVerticalBargraph').
+         *
+         * @param z - the zone
+         */
+        void registerPassiveZone(FAUSTFLOAT* z)
+        {
+            std::lock_guard<std::mutex> lock(fTableMutex);
+            fPassiveZones.insert(z);
+            fTableChanged = true;
+        }
         
      public:
             
-        GUI():fStopped(false)
+        GUI():fStopped(false), fTable(0), fTableChanged(true)
         {	
             fGuiList.push_back(this);
         }
@@ -114,30 +286,61 @@ class GUI : public UI
         
         void registerZone(FAUSTFLOAT* z, uiItemBase* c)
         {
+            std::lock_guard<std::mutex> lock(fTableMutex);
             if (fZoneMap.find(z) == fZoneMap.end()) fZoneMap[z] = new clist();
             fZoneMap[z]->push_back(c);
+            fTableChanged = true;
+        }
+    
+        /**
+         * Mark a zone as changed, so that it is reflected on next update. All writers (except the DSP)
+         * have to mark the zones they change, since only marked and passive zones are visited on update.
+         * Can be called from any thread (like the audio one) without lock or allocation.
+         * Marks done before the zone table is (re)built are not needed: all zones are then reflected.
+         *
+         * @param z - the zone
+         */
+        void markZone(FAUSTFLOAT* z)
+        {
+            zone_table* table = fTable.load(std::memory_order_acquire);
+            if (!table) return;
+            int index = table->getZoneIndex(z);
+            if (index >= 0) table->fDirtyZones.set(index);
+        }
+    
+        // Mark a zone as changed in all GUIs
+        static void markAllGuis(FAUSTFLOAT* z)
+        {
+            std::list<GUI*>::iterator g;
+            for (g = fGuiList.begin(); g != fGuiList.end(); g++) {
+                (*g)->markZone(z);
+            }
         }
  
-        void updateAllZones()
+        // Reflect the zones marked since the last update, and the changed passive ones
+        virtual void updateAllZones()
         {
-            for (zmap::iterator m = fZoneMap.begin(); m != fZoneMap.end(); m++) {
-                FAUSTFLOAT* z = m->first;
-                clist*	l = m->second;
-                if (z) {
-                    FAUSTFLOAT v = *z;
-                    for (clist::iterator c = l->begin(); c != l->end(); c++) {
-                        if ((*c)->cache() != v) (*c)->reflectZone();
-                    }
+            zone_table* table = getZoneTable();
+            for (size_t p = 0; p < table->fPassiveZones.size(); p++) {
+                int index = table->fPassiveZones[p];
+                FAUSTFLOAT v = *table->fZones[index];
+                if (v != table->fPassiveValues[p]) {
+                    table->fPassiveValues[p] = v;
+                    table->fDirtyZones.set(index);
                 }
             }
+            table->fDirtyZones.collect(zone_table::reflectTableZone, table);
         }
         
         void updateZone(FAUSTFLOAT* z)
         {
-            FAUSTFLOAT v = *z;
-            clist* l = fZoneMap[z];
-            for (clist::iterator c = l->begin(); c != l->end(); c++) {
-                if ((*c)->cache() != v) (*c)->reflectZone();
+            zone_table* table = getZoneTable();
+            int index = table->getZoneIndex(z);
+            if (index >= 0) table->reflectZone(index);
+            // Other GUIs will reflect the zone on their next update
+            std::list<GUI*>::iterator g;
+            for (g = fGuiList.begin(); g != fGuiList.end(); g++) {
+                if (*g != this) (*g)->markZone(z);
             }
         }
     
@@ -184,8 +387,8 @@ class GUI : public UI
     
         // -- passive widgets
         
-        virtual void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) {}
-        virtual void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) {}
+        virtual void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) { registerPassiveZone(zone); }
+        virtual void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) { registerPassiveZone(zone); }
     
         // -- soundfiles
     
@@ -197,6 +400,13 @@ class GUI : public UI
     
         // Static global for timed zones, shared between all UI that will set timed values
         static ztimedmap gTimedZoneMap;
+    
+        // Incremented each time a zone is added to or removed from gTimedZoneMap
+        static std::atomic<int>& timedZoneMapVersion()
+        {
+            static std::atomic<int> version(0);
+            return version;
+        }
 
 };
 
@@ -303,19 +513,6 @@ class uiCallbackItem : public uiItem {
         }
 };
 
-/**
- *  For timestamped control
- */
-
-struct DatedControl {
-    
-    double fDate;
-    FAUSTFLOAT fValue;
-    
-    DatedControl(double d = 0., FAUSTFLOAT v = FAUSTFLOAT(0)):fDate(d), fValue(v) {}
-    
-};
-
 /**
  * Base class for timed items
  */
@@ -334,7 +531,8 @@ class uiTimedItem : public uiItem
         uiTimedItem(GUI* ui, FAUSTFLOAT* zone):uiItem(ui, zone)
         {
             if (GUI::gTimedZoneMap.find(fZone) == GUI::gTimedZoneMap.end()) {
-                GUI::gTimedZoneMap[fZone] = ringbuffer_create(8192);
+                GUI::gTimedZoneMap[fZone] = new dated_control_ring(512);
+                GUI::timedZoneMapVersion()++;
                 fDelete = true;
             } else {
                 fDelete = false;
@@ -345,17 +543,16 @@ class uiTimedItem : public uiItem
         {
             ztimedmap::iterator it;
             if (fDelete && ((it = GUI::gTimedZoneMap.find(fZone)) != GUI::gTimedZoneMap.end())) {
-                ringbuffer_free((*it).second);
+                delete (*it).second;
                 GUI::gTimedZoneMap.erase(it);
+                GUI::timedZoneMapVersion()++;
             }
         }
         
         virtual void modifyZone(double date, FAUSTFLOAT v)
         {
-            size_t res;
-            DatedControl dated_val(date, v);
-            if ((res = ringbuffer_write(GUI::gTimedZoneMap[fZone], (const char*)&dated_val, sizeof(DatedControl))) != sizeof(DatedControl)) {
-                std::cerr << "ringbuffer_write error DatedControl" << std::endl;
+            if (!GUI::gTimedZoneMap[fZone]->push(DatedControl(date, v))) {
+                std::cerr << "ring buffer write error DatedControl" << std::endl;
             }
         }
     
@@ -387,6 +584,7 @@ class uiGroupItem : public uiItem
             std::vector<FAUSTFLOAT*>::iterator it;
             for (it = fZoneMap.begin(); it != fZoneMap.end(); it++) {
                 (*(*it)) = v;
+                GUI::markAllGuis(*it);
             }
         }
         
@@ -0,0 +1,650 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __JSONUIStreamDecoder__
+#define __JSONUIStreamDecoder__
+
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "faust/gui/JSONUIDecoder.h"
+
+//--------------------------------------------------------------------------------------
+//  Decode a dsp JSON description and implement 'buildUserInterface', with the same API
+//  as JSONUIDecoderAux, but:
+//
+//  - the JSON is decoded in a single pass, directly into a flat items table
+//  - strings are kept as views in a private copy of the JSON, unquoted in place
+//  - numbers are converted once, at decoding time
+//  - the JSON copies, the items and metadata tables and the controls all live
+//    in a single allocation, sized by a quick scan of the JSON
+//
+//  Libraries and include pathnames lists are only decoded when asked for.
+//
+//  Global metadata are declared in the JSON order.
+//--------------------------------------------------------------------------------------
+
+template <typename REAL>
+struct JSONUIStreamDecoderAux {
+
+    enum { kUnknown, kHGroup, kVGroup, kTGroup, kVSlider, kHSlider, kNumEntry, kButton, kCheckButton,
+           kHBargraph, kVBargraph, kSoundfile, kClose };
+
+    struct itemView {
+        int fType;
+        const char* fLabel;
+        const char* fURL;
+        const char* fAddress;
+        int fIndex;
+        int fZone;          // in fInControl, fOutControl or fSoundfiles, depending of the type
+        REAL fInit, fMin, fMax, fStep;
+        int fMeta;          // first item metadata in fMetas
+        int fMetaSize;
+    };
+
+    struct metaView {
+        const char* fKey;
+        const char* fValue;
+    };
+
+    char* fArena;
+    const char* fJSON;      // the source JSON (unmodified)
+    const char* fParsed;    // the parsed JSON copy, where strings are kept
+
+    const char* fName;
+    const char* fFileName;
+    const char* fVersion;
+    const char* fCompileOptions;
+
+    itemView* fItems;
+    int fItemsSize, fItemsMax;
+    metaView* fMetas;
+    int fMetasSize, fMetasMax;
+    int fGlobalMeta, fGlobalMetaSize;
+    int fLibraryList;       // offset of the list in fJSON, or -1
+    int fIncludePathnames;  // offset of the list in fJSON, or -1
+
+    REAL* fInControl;
+    REAL* fOutControl;
+    Soundfile** fSoundfiles;
+
+    int fNumInputs, fNumOutputs, fSRIndex;
+    int fInputItems, fOutputItems, fSoundfileItems;
+    int fDSPSize;
+
+    bool isInput(int type) { return (type >= kVSlider && type <= kCheckButton); }
+    bool isOutput(int type) { return (type == kHBargraph || type == kVBargraph); }
+    bool isSoundfile(int type) { return (type == kSoundfile); }
+
+    static int getType(const char* type)
+    {
+        static const char* types[] = { "hgroup", "vgroup", "tgroup", "vslider", "hslider", "nentry", "button", "checkbox",
+                                       "hbargraph", "vbargraph", "soundfile" };
+        for (int i = 0; i < kClose - 1; i++) {
+            if (strcmp(type, types[i]) == 0) return i + 1;
+        }
+        return kUnknown;
+    }
+
+    static size_t align(size_t size) { return (size + 15) & ~size_t(15); }
+
+    JSONUIStreamDecoderAux(const std::string& json)
+    {
+        // Bounds of the tables: items and metadata are objects, plus the closing of groups
+        size_t size = json.size();
+        const char* src = json.c_str();
+        int objects = int(std::count(json.begin(), json.end(), '{'));
+        int groups = 0;
+        for (const char* c = strstr(src, "\"items\""); c; c = strstr(c + 7, "\"items\"")) {
+            groups++;
+        }
+
+        size_t items_size = align(sizeof(itemView) * (objects + groups));
+        size_t metas_size = align(sizeof(metaView) * objects);
+        size_t zones_size = align(sizeof(REAL) * objects) + align(sizeof(Soundfile*) * objects);
+        size_t json_size = align(size + 1);
+        fArena = new char[2 * json_size + items_size + metas_size + zones_size];
+
+        char* arena = fArena;
+        memcpy(arena, src, size + 1);
+        fJSON = arena;
+        arena += json_size;
+        char* p = arena;
+        memcpy(p, src, size + 1);
+        fParsed = p;
+        arena += json_size;
+        fItems = reinterpret_cast<itemView*>(arena);
+        arena += items_size;
+        fMetas = reinterpret_cast<metaView*>(arena);
+        arena += metas_size;
+
+        fName = fFileName = fVersion = fCompileOptions = "";
+        fItemsSize = fMetasSize = 0;
+        fItemsMax = objects + groups;
+        fMetasMax = objects;
+        fGlobalMeta = fGlobalMetaSize = 0;
+        fLibraryList = fIncludePathnames = -1;
+        fNumInputs = fNumOutputs = fSRIndex = fDSPSize = -1;
+        if (!parseJSON(p)) {
+            std::cerr << "JSONUIStreamDecoder : parse error here : " << (fJSON + offset(p)) << std::endl;
+        }
+
+        // Controls, in the items order
+        fInputItems = fOutputItems = fSoundfileItems = 0;
+        for (int i = 0; i < fItemsSize; i++) {
+            int type = fItems[i].fType;
+            fItems[i].fZone = isInput(type) ? fInputItems++ : isOutput(type) ? fOutputItems++ : isSoundfile(type) ? fSoundfileItems++ : -1;
+        }
+        fInControl = reinterpret_cast<REAL*>(arena);
+        fOutControl = fInControl + fInputItems;
+        arena += align(sizeof(REAL) * objects);
+        fSoundfiles = reinterpret_cast<Soundfile**>(arena);
+        for (int i = 0; i < fItemsSize; i++) {
+            if (isInput(fItems[i].fType)) {
+                fInControl[fItems[i].fZone] = fItems[i].fInit;
+            } else if (isOutput(fItems[i].fType)) {
+                fOutControl[fItems[i].fZone] = REAL(0);
+            } else if (isSoundfile(fItems[i].fType)) {
+                fSoundfiles[fItems[i].fZone] = 0;
+            }
+        }
+    }
+
+    virtual ~JSONUIStreamDecoderAux()
+    {
+        delete [] fArena;
+    }
+
+    // In place parsing: strings are unquoted and null terminated in the JSON copy
+
+    static void skipBlank(char*& p)
+    {
+        while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') { p++; }
+    }
+
+    static bool parseChar(char*& p, char x)
+    {
+        skipBlank(p);
+        if (*p == x) {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    static char* parseString(char*& p)
+    {
+        skipBlank(p);
+        if (*p != '"') return 0;
+        char* str = ++p;
+        p += strcspn(p, "\"\\");
+        // Escaped characters are unquoted by moving the rest of the string
+        char* dst = p;
+        while (*p != '"') {
+            if (*p == 0) return 0;
+            if (*p == '\\' && p[1] != 0) p++;
+            *dst++ = *p++;
+        }
+        *dst = 0;
+        p++;
+        return str;
+    }
+
+    // Numbers are quoted in Faust JSON, but are also accepted as is
+    static bool parseNumber(char*& p, double& x)
+    {
+        skipBlank(p);
+        if (*p == '"') {
+            char* str = parseString(p);
+            if (!str) return false;
+            x = strtod(str, 0);
+            return true;
+        }
+        char* end;
+        x = strtod(p, &end);
+        if (end == p) return false;
+        p = end;
+        return true;
+    }
+
+    // Skip an unknown value
+    static bool skipValue(char*& p)
+    {
+        skipBlank(p);
+        if (*p == '"') {
+            return parseString(p) != 0;
+        } else if (*p == '[' || *p == '{') {
+            char close = (*p++ == '[') ? ']' : '}';
+            if (parseChar(p, close)) return true;
+            do {
+                if (close == '}' && !(parseString(p) && parseChar(p, ':'))) return false;
+                if (!skipValue(p)) return false;
+            } while (parseChar(p, ','));
+            return parseChar(p, close);
+        } else {
+            char* start = p;
+            while (*p != 0 && *p != ',' && *p != '}' && *p != ']' && !isspace(*p)) { p++; }
+            return p != start;
+        }
+    }
+
+    // [{ "key": "value" }, ...]
+    bool parseMeta(char*& p)
+    {
+        if (!parseChar(p, '[')) return false;
+        if (parseChar(p, ']')) return true;
+        do {
+            if (fMetasSize == fMetasMax) return false;
+            metaView& meta = fMetas[fMetasSize++];
+            if (!(parseChar(p, '{') && (meta.fKey = parseString(p)) && parseChar(p, ':')
+                  && (meta.fValue = parseString(p)) && parseChar(p, '}'))) return false;
+        } while (parseChar(p, ','));
+        return parseChar(p, ']');
+    }
+
+    // [ "string", ...]
+    static bool parseList(char*& p, std::vector<std::string>& list)
+    {
+        if (!parseChar(p, '[')) return false;
+        if (parseChar(p, ']')) return true;
+        do {
+            char* str = parseString(p);
+            if (!str) return false;
+            list.push_back(str);
+        } while (parseChar(p, ','));
+        return parseChar(p, ']');
+    }
+
+    bool parseItems(char*& p)
+    {
+        if (!parseChar(p, '[')) return false;
+        if (parseChar(p, ']')) return true;
+        do {
+            if (!parseItem(p)) return false;
+        } while (parseChar(p, ','));
+        return parseChar(p, ']');
+    }
+
+    // { "type": "...", "label": "...", ..., "items": [...] }
+    bool parseItem(char*& p)
+    {
+        if (!parseChar(p, '{') || fItemsSize == fItemsMax) return false;
+        // The item is created before its subitems
+        int item = fItemsSize++;
+        itemView* view = &fItems[item];
+        memset(view, 0, sizeof(itemView));
+        view->fLabel = view->fURL = view->fAddress = "";
+        bool group = false;
+        if (!parseChar(p, '}')) {
+            do {
+                char* key = parseString(p);
+                double value;
+                if (!key || !parseChar(p, ':')) return false;
+                view = &fItems[item];
+                if (strcmp(key, "type") == 0) {
+                    char* type = parseString(p);
+                    if (!type) return false;
+                    view->fType = getType(type);
+                } else if (strcmp(key, "label") == 0) {
+                    if (!(view->fLabel = parseString(p))) return false;
+                } else if (strcmp(key, "url") == 0) {
+                    if (!(view->fURL = parseString(p))) return false;
+                } else if (strcmp(key, "address") == 0) {
+                    if (!(view->fAddress = parseString(p))) return false;
+                } else if (strcmp(key, "index") == 0) {
+                    if (!parseNumber(p, value)) return false;
+                    view->fIndex = int(value);
+                } else if (strcmp(key, "init") == 0) {
+                    if (!parseNumber(p, value)) return false;
+                    view->fInit = REAL(value);
+                } else if (strcmp(key, "min") == 0) {
+                    if (!parseNumber(p, value)) return false;
+                    view->fMin = REAL(value);
+                } else if (strcmp(key, "max") == 0) {
+                    if (!parseNumber(p, value)) return false;
+                    view->fMax = REAL(value);
+                } else if (strcmp(key, "step") == 0) {
+                    if (!parseNumber(p, value)) return false;
+                    view->fStep = REAL(value);
+                } else if (strcmp(key, "meta") == 0) {
+                    view->fMeta = fMetasSize;
+                    if (!parseMeta(p)) return false;
+                    fItems[item].fMetaSize = fMetasSize - fItems[item].fMeta;
+                } else if (strcmp(key, "items") == 0) {
+                    if (!parseItems(p)) return false;
+                    group = true;
+                } else if (!skipValue(p)) {
+                    return false;
+                }
+            } while (parseChar(p, ','));
+            if (!parseChar(p, '}')) return false;
+        }
+        if (group) {
+            if (fItemsSize == fItemsMax) return false;
+            itemView* close = &fItems[fItemsSize++];
+            memset(close, 0, sizeof(itemView));
+            close->fType = kClose;
+            close->fLabel = close->fURL = close->fAddress = "";
+        }
+        return true;
+    }
+
+    bool parseJSON(char*& p)
+    {
+        if (!parseChar(p, '{')) return false;
+        if (parseChar(p, '}')) return true;
+        do {
+            char* key = parseString(p);
+            if (!key || !parseChar(p, ':')) return false;
+            double value;
+            if (strcmp(key, "ui") == 0) {
+                if (!parseItems(p)) return false;
+            } else if (strcmp(key, "meta") == 0) {
+                fGlobalMeta = fMetasSize;
+                if (!parseMeta(p)) return false;
+                fGlobalMetaSize = fMetasSize - fGlobalMeta;
+            } else if (strcmp(key, "library_list") == 0) {
+                fLibraryList = offset(p);
+                if (!skipValue(p)) return false;
+            } else if (strcmp(key, "include_pathnames") == 0) {
+                fIncludePathnames = offset(p);
+                if (!skipValue(p)) return false;
+            } else if (strcmp(key, "name") == 0) {
+                if (!(fName = parseString(p))) return false;
+            } else if (strcmp(key, "filename") == 0) {
+                if (!(fFileName = parseString(p))) return false;
+            } else if (strcmp(key, "version") == 0) {
+                if (!(fVersion = parseString(p))) return false;
+            } else if (strcmp(key, "compile_options") == 0) {
+                if (!(fCompileOptions = parseString(p))) return false;
+            } else if (strcmp(key, "size") == 0) {
+                if (!parseNumber(p, value)) return false;
+                fDSPSize = int(value);
+            } else if (strcmp(key, "inputs") == 0) {
+                if (!parseNumber(p, value)) return false;
+                fNumInputs = int(value);
+            } else if (strcmp(key, "outputs") == 0) {
+                if (!parseNumber(p, value)) return false;
+                fNumOutputs = int(value);
+            } else if (strcmp(key, "sr_index") == 0) {
+                if (!parseNumber(p, value)) return false;
+                fSRIndex = int(value);
+            } else if (!skipValue(p)) {
+                return false;
+            }
+        } while (parseChar(p, ','));
+        return parseChar(p, '}');
+    }
+
+    // Offset in fJSON of a position in the parsed copy
+    int offset(const char* p) { return int(p - fParsed); }
+
+    std::vector<std::string> getList(int offset)
+    {
+        std::vector<std::string> list;
+        if (offset >= 0) {
+            std::vector<char> json(fJSON + offset, fJSON + strlen(fJSON) + 1);
+            char* p = json.data();
+            parseList(p, list);
+        }
+        return list;
+    }
+
+    std::vector<std::string> getLibraryList() { return getList(fLibraryList); }
+    std::vector<std::string> getIncludePathnames() { return getList(fIncludePathnames); }
+
+    void metadata(Meta* m)
+    {
+        for (int i = fGlobalMeta; i < fGlobalMeta + fGlobalMetaSize; i++) {
+            m->declare(fMetas[i].fKey, fMetas[i].fValue);
+        }
+    }
+
+    void metadata(MetaGlue* m)
+    {
+        for (int i = fGlobalMeta; i < fGlobalMeta + fGlobalMetaSize; i++) {
+            m->declare(m->metaInterface, fMetas[i].fKey, fMetas[i].fValue);
+        }
+    }
+
+    void resetUserInterface()
+    {
+        for (int i = 0; i < fItemsSize; i++) {
+            if (isInput(fItems[i].fType)) {
+                fInControl[fItems[i].fZone] = fItems[i].fInit;
+            }
+        }
+    }
+
+    void resetUserInterface(char* memory_block, Soundfile* defaultsound = nullptr)
+    {
+        for (int i = 0; i < fItemsSize; i++) {
+            int offset = fItems[i].fIndex;
+            if (isInput(fItems[i].fType)) {
+                *REAL_ADR(offset) = fItems[i].fInit;
+            } else if (isSoundfile(fItems[i].fType)) {
+                if (*SOUNDFILE_ADR(offset) == nullptr) {
+                    *SOUNDFILE_ADR(offset) = defaultsound;
+                }
+            }
+        }
+    }
+
+    int getSampleRate(char* memory_block)
+    {
+        return *reinterpret_cast<int*>(&memory_block[fSRIndex]);
+    }
+
+    void declare(UI* ui_interface, const itemView& item, REAL* zone)
+    {
+        for (int i = item.fMeta; i < item.fMeta + item.fMetaSize; i++) {
+            REAL_UI(ui_interface)->declare(zone, fMetas[i].fKey, fMetas[i].fValue);
+        }
+    }
+
+    // Controls zones are given by 'zone', soundfiles by 'sound'
+    void buildItem(UI* ui_interface, const itemView& item, REAL* zone, Soundfile** sound)
+    {
+        switch (item.fType) {
+            case kHGroup:
+                REAL_UI(ui_interface)->openHorizontalBox(item.fLabel);
+                break;
+            case kVGroup:
+                REAL_UI(ui_interface)->openVerticalBox(item.fLabel);
+                break;
+            case kTGroup:
+                REAL_UI(ui_interface)->openTabBox(item.fLabel);
+                break;
+            case kVSlider:
+                REAL_UI(ui_interface)->addVerticalSlider(item.fLabel, zone, item.fInit, item.fMin, item.fMax, item.fStep);
+                break;
+            case kHSlider:
+                REAL_UI(ui_interface)->addHorizontalSlider(item.fLabel, zone, item.fInit, item.fMin, item.fMax, item.fStep);
+                break;
+            case kNumEntry:
+                REAL_UI(ui_interface)->addNumEntry(item.fLabel, zone, item.fInit, item.fMin, item.fMax, item.fStep);
+                break;
+            case kButton:
+                REAL_UI(ui_interface)->addButton(item.fLabel, zone);
+                break;
+            case kCheckButton:
+                REAL_UI(ui_interface)->addCheckButton(item.fLabel, zone);
+                break;
+            case kHBargraph:
+                REAL_UI(ui_interface)->addHorizontalBargraph(item.fLabel, zone, item.fMin, item.fMax);
+                break;
+            case kVBargraph:
+                REAL_UI(ui_interface)->addVerticalBargraph(item.fLabel, zone, item.fMin, item.fMax);
+                break;
+            case kSoundfile:
+                REAL_UI(ui_interface)->addSoundfile(item.fLabel, item.fURL, sound);
+                break;
+            case kClose:
+                REAL_UI(ui_interface)->closeBox();
+                break;
+        }
+    }
+
+    void buildUserInterface(UI* ui_interface)
+    {
+        for (int i = 0; i < fItemsSize; i++) {
+            const itemView& item = fItems[i];
+            REAL* zone = 0;
+            if (isInput(item.fType)) {
+                zone = &fInControl[item.fZone];
+                *zone = item.fInit;
+            } else if (isOutput(item.fType)) {
+                zone = &fOutControl[item.fZone];
+            }
+            declare(ui_interface, item, zone);
+            buildItem(ui_interface, item, zone, isSoundfile(item.fType) ? &fSoundfiles[item.fZone] : 0);
+        }
+    }
+
+    void buildUserInterface(UI* ui_interface, char* memory_block)
+    {
+        for (int i = 0; i < fItemsSize; i++) {
+            const itemView& item = fItems[i];
+            REAL* zone = 0;
+            if (isInput(item.fType)) {
+                zone = REAL_ADR(item.fIndex);
+                *zone = item.fInit;
+            } else if (isOutput(item.fType)) {
+                zone = REAL_ADR(item.fIndex);
+            }
+            declare(ui_interface, item, zone);
+            buildItem(ui_interface, item, zone, isSoundfile(item.fType) ? SOUNDFILE_ADR(item.fIndex) : 0);
+        }
+    }
+
+    // Not implemented, as in JSONUIDecoderAux
+    void buildUserInterface(UIGlue* ui_interface, char* memory_block)
+    {}
+
+    bool hasCompileOption(const std::string& option)
+    {
+        return hasCompileOption(fCompileOptions, option);
+    }
+
+    static bool hasCompileOption(const char* options, const std::string& option)
+    {
+        size_t size = option.size();
+        for (const char* token = strstr(options, option.c_str()); token; token = strstr(token + 1, option.c_str())) {
+            if ((token == options || token[-1] == ' ') && (token[size] == 0 || token[size] == ' ')) return true;
+        }
+        return false;
+    }
+
+};
+
+// Templated decoders
+
+struct JSONUIStreamFloatDecoder : public JSONUIStreamDecoderAux<float>, public JSONUITemplatedDecoder
+{
+    JSONUIStreamFloatDecoder(const std::string& json):JSONUIStreamDecoderAux<float>(json)
+    {}
+
+    void metadata(Meta* m) { JSONUIStreamDecoderAux<float>::metadata(m); }
+    void metadata(MetaGlue* glue) { JSONUIStreamDecoderAux<float>::metadata(glue); }
+    int getDSPSize() { return fDSPSize; }
+    std::string getLibVersion() { return fVersion; }
+    std::string getCompileOptions() { return fCompileOptions; }
+    std::vector<std::string> getLibraryList() { return JSONUIStreamDecoderAux<float>::getLibraryList(); }
+    std::vector<std::string> getIncludePathnames() { return JSONUIStreamDecoderAux<float>::getIncludePathnames(); }
+    int getNumInputs() { return fNumInputs; }
+    int getNumOutputs() { return fNumOutputs; }
+    int getSampleRate(char* memory_block)  { return JSONUIStreamDecoderAux<float>::getSampleRate(memory_block); }
+    void resetUserInterface(char* memory_block, Soundfile* defaultsound = nullptr)
+    {
+        JSONUIStreamDecoderAux<float>::resetUserInterface(memory_block, defaultsound);
+    }
+    void buildUserInterface(UI* ui_interface, char* memory_block)
+    {
+        JSONUIStreamDecoderAux<float>::buildUserInterface(ui_interface, memory_block);
+    }
+    void buildUserInterface(UIGlue* ui_interface, char* memory_block)
+    {
+        JSONUIStreamDecoderAux<float>::buildUserInterface(ui_interface, memory_block);
+    }
+    bool hasCompileOption(const std::string& option) { return JSONUIStreamDecoderAux<float>::hasCompileOption(option); }
+};
+
+struct JSONUIStreamDoubleDecoder : public JSONUIStreamDecoderAux<double>, public JSONUITemplatedDecoder
+{
+    JSONUIStreamDoubleDecoder(const std::string& json):JSONUIStreamDecoderAux<double>(json)
+    {}
+
+    void metadata(Meta* m) { JSONUIStreamDecoderAux<double>::metadata(m); }
+    void metadata(MetaGlue* glue) { JSONUIStreamDecoderAux<double>::metadata(glue); }
+    int getDSPSize() { return fDSPSize; }
+    std::string getLibVersion() { return fVersion; }
+    std::string getCompileOptions() { return fCompileOptions; }
+    std::vector<std::string> getLibraryList() { return JSONUIStreamDecoderAux<double>::getLibraryList(); }
+    std::vector<std::string> getIncludePathnames() { return JSONUIStreamDecoderAux<double>::getIncludePathnames(); }
+    int getNumInputs() { return fNumInputs; }
+    int getNumOutputs() { return fNumOutputs; }
+    int getSampleRate(char* memory_block) { return JSONUIStreamDecoderAux<double>::getSampleRate(memory_block); }
+    void resetUserInterface(char* memory_block, Soundfile* defaultsound = nullptr)
+    {
+        JSONUIStreamDecoderAux<double>::resetUserInterface(memory_block, defaultsound);
+    }
+    void buildUserInterface(UI* ui_interface, char* memory_block)
+    {
+        JSONUIStreamDecoderAux<double>::buildUserInterface(ui_interface, memory_block);
+    }
+    void buildUserInterface(UIGlue* ui_interface, char* memory_block)
+    {
+        JSONUIStreamDecoderAux<double>::buildUserInterface(ui_interface, memory_block);
+    }
+    bool hasCompileOption(const std::string& option) { return JSONUIStreamDecoderAux<double>::hasCompileOption(option); }
+};
+
+// FAUSTFLOAT decoder
+
+struct JSONUIStreamDecoder : public JSONUIStreamDecoderAux<FAUSTFLOAT>
+{
+    JSONUIStreamDecoder(const std::string& json):JSONUIStreamDecoderAux<FAUSTFLOAT>(json)
+    {}
+};
+
+// Unlike createJSONUIDecoder, the JSON is decoded once: only the "compile_options" value is looked for first
+static JSONUITemplatedDecoder* createJSONUIStreamDecoder(const std::string& json)
+{
+    const char* key = strstr(json.c_str(), "\"compile_options\"");
+    std::string options;
+    if (key) {
+        const char* begin = strchr(key + 17, '"');
+        const char* end = (begin) ? strchr(begin + 1, '"') : 0;
+        if (end) options.assign(begin + 1, end);
+    }
+    if (JSONUIStreamDecoderAux<float>::hasCompileOption(options.c_str(), "-double")) {
+        return new JSONUIStreamDoubleDecoder(json);
+    } else {
+        return new JSONUIStreamFloatDecoder(json);
+    }
+}
+
+#endif
@@ -1896,6 +1896,7 @@ class JuceGUI : public GUI, public MetaDataUI, public Component
         /** Add a bargraph to the user interface. */
         void addBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max, int kWidth, int kHeight, VUMeterType type)
         {
+            registerPassiveZone(zone);
             if (isLed(zone)) {
                 addLed(String(label), zone, min, max);
             } else if (isNumerical(zone)) {
@@ -78,7 +78,9 @@ class JuceOSCUI : private OSCReceiver, private OSCReceiver::Listener<OSCReceiver
             
             for (int i = 0; i < message.size(); ++i) {
                 if (message[i].isFloat32()) {
-                    fAPIUI.setParamValue(fAPIUI.getParamIndex(address.toStdString().c_str()), FAUSTFLOAT(message[i].getFloat32()));
+                    int index = fAPIUI.getParamIndex(address.toStdString().c_str());
+                    fAPIUI.setParamValue(index, FAUSTFLOAT(message[i].getFloat32()));
+                    GUI::markAllGuis(fAPIUI.getParamZone(index));
                     // "get" message with correct address
                 } else if (message[i].isString()
                            && message[i].getString().equalsIgnoreCase("get")
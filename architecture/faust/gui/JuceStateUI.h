@@ -27,6 +27,7 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 
 #include "faust/gui/MapUI.h"
+#include "faust/gui/GUI.h"
 
 // A class to save/restore DSP state using JUCE, which also set default values at construction time.
 
@@ -65,10 +66,12 @@ class JuceStateUI : public MapUI {
             if (sizeof(FAUSTFLOAT) == sizeof(float)) {
                 while ((path = stream.readString().toStdString()) != "") {
                     setParamValue(path, stream.readFloat());
+                    GUI::markAllGuis(getParamHandle(path));
                 }
             } else {
                 while ((path = stream.readString().toStdString()) != "") {
                     setParamValue(path, stream.readDouble());
+                    GUI::markAllGuis(getParamHandle(path));
                 }
             }
         }
@@ -119,21 +119,38 @@ class MapUI : public UI, public PathBuilder
         // set/get
         void setParamValue(const std::string& path, FAUSTFLOAT value)
         {
-            if (fPathZoneMap.find(path) != fPathZoneMap.end()) {
-                *fPathZoneMap[path] = value;
-            } else if (fLabelZoneMap.find(path) != fLabelZoneMap.end()) {
-                *fLabelZoneMap[path] = value;
-            }
+            FAUSTFLOAT* zone = getParamHandle(path);
+            if (zone) *zone = value;
         }
         
         FAUSTFLOAT getParamValue(const std::string& path)
         {
-            if (fPathZoneMap.find(path) != fPathZoneMap.end()) {
-                return *fPathZoneMap[path];
-            } else if (fLabelZoneMap.find(path) != fLabelZoneMap.end()) {
-                return *fLabelZoneMap[path];
-            } else {
-                return FAUSTFLOAT(0);
+            FAUSTFLOAT* zone = getParamHandle(path);
+            return (zone) ? *zone : FAUSTFLOAT(0);
+        }
+    
+        // Resolved handles: a path (or label) is looked up once, and the returned handle (the parameter zone,
+        // valid as long as the DSP exists) is then used on the control path without any string comparison
+    
+        FAUSTFLOAT* getParamHandle(const std::string& path)
+        {
+            std::map<std::string, FAUSTFLOAT*>::iterator it = fPathZoneMap.find(path);
+            if (it != fPathZoneMap.end()) return (*it).second;
+            it = fLabelZoneMap.find(path);
+            return (it != fLabelZoneMap.end()) ? (*it).second : 0;
+        }
+    
+        static void setParamValues(FAUSTFLOAT* const* handles, const FAUSTFLOAT* values, int n)
+        {
+            for (int i = 0; i < n; i++) {
+                *handles[i] = values[i];
+            }
+        }
+    
+        static void getParamValues(FAUSTFLOAT* const* handles, FAUSTFLOAT* values, int n)
+        {
+            for (int i = 0; i < n; i++) {
+                values[i] = *handles[i];
             }
         }
     
@@ -552,6 +552,30 @@ class MidiUI : public GUI, public midi
         bool fDelete;
         bool fTimeStamp;
     
+        // Update all items mapped on 'num' (resolved with a single table lookup)
+        template <typename ITEM>
+        void modifyItems(std::map<int, std::vector<ITEM*> >& table, int num, double date, FAUSTFLOAT value)
+        {
+            typename std::map<int, std::vector<ITEM*> >::iterator it = table.find(num);
+            if (it != table.end()) {
+                modifyItems((*it).second, date, value);
+            }
+        }
+    
+        template <typename ITEM>
+        void modifyItems(std::vector<ITEM*>& items, double date, FAUSTFLOAT value)
+        {
+            if (fTimeStamp) {
+                for (size_t i = 0; i < items.size(); i++) {
+                    items[i]->modifyZone(date, value);
+                }
+            } else {
+                for (size_t i = 0; i < items.size(); i++) {
+                    items[i]->modifyZone(value);
+                }
+            }
+        }
+    
         void addGenericZone(FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max, bool input = true)
         {
             if (fMetaAux.size() > 0) {
@@ -643,10 +667,12 @@ class MidiUI : public GUI, public midi
 
         virtual void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) 
         {
+            registerPassiveZone(zone);
             addGenericZone(zone, min, max, false);
         }
         virtual void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
         {
+            registerPassiveZone(zone);
             addGenericZone(zone, min, max, false);
         }
 
@@ -661,130 +687,42 @@ class MidiUI : public GUI, public midi
         
         MapUI* keyOn(double date, int channel, int note, int velocity)
         {
-            if (fKeyOnTable.find(note) != fKeyOnTable.end()) {
-                if (fTimeStamp) {
-                    for (unsigned int i = 0; i < fKeyOnTable[note].size(); i++) {
-                        fKeyOnTable[note][i]->modifyZone(date, FAUSTFLOAT(velocity));
-                    }
-                } else {
-                    for (unsigned int i = 0; i < fKeyOnTable[note].size(); i++) {
-                        fKeyOnTable[note][i]->modifyZone(FAUSTFLOAT(velocity));
-                    }
-                }
-            }
+            modifyItems(fKeyOnTable, note, date, FAUSTFLOAT(velocity));
             // If note is in fKeyTable, handle it as a keyOn
-            if (fKeyTable.find(note) != fKeyTable.end()) {
-                if (fTimeStamp) {
-                    for (unsigned int i = 0; i < fKeyTable[note].size(); i++) {
-                        fKeyTable[note][i]->modifyZone(date, FAUSTFLOAT(velocity));
-                    }
-                } else {
-                    for (unsigned int i = 0; i < fKeyTable[note].size(); i++) {
-                        fKeyTable[note][i]->modifyZone(FAUSTFLOAT(velocity));
-                    }
-                }
-            }
+            modifyItems(fKeyTable, note, date, FAUSTFLOAT(velocity));
             return 0;
         }
         
         void keyOff(double date, int channel, int note, int velocity)
         {
-            if (fKeyOffTable.find(note) != fKeyOffTable.end()) {
-                if (fTimeStamp) {
-                    for (unsigned int i = 0; i < fKeyOffTable[note].size(); i++) {
-                        fKeyOffTable[note][i]->modifyZone(date, FAUSTFLOAT(velocity));
-                    }
-                } else {
-                    for (unsigned int i = 0; i < fKeyOffTable[note].size(); i++) {
-                        fKeyOffTable[note][i]->modifyZone(FAUSTFLOAT(velocity));
-                    }
-                }
-            }
+            modifyItems(fKeyOffTable, note, date, FAUSTFLOAT(velocity));
             // If note is in fKeyTable, handle it as a keyOff with a 0 velocity
-            if (fKeyTable.find(note) != fKeyTable.end()) {
-                if (fTimeStamp) {
-                    for (unsigned int i = 0; i < fKeyTable[note].size(); i++) {
-                        fKeyTable[note][i]->modifyZone(date, 0);
-                    }
-                } else {
-                    for (unsigned int i = 0; i < fKeyTable[note].size(); i++) {
-                        fKeyTable[note][i]->modifyZone(0);
-                    }
-                }
-            }
+            modifyItems(fKeyTable, note, date, FAUSTFLOAT(0));
         }
            
         void ctrlChange(double date, int channel, int ctrl, int value)
         {
-            if (fCtrlChangeTable.find(ctrl) != fCtrlChangeTable.end()) {
-                if (fTimeStamp) {
-                    for (unsigned int i = 0; i < fCtrlChangeTable[ctrl].size(); i++) {
-                        fCtrlChangeTable[ctrl][i]->modifyZone(date, FAUSTFLOAT(value));
-                    }
-                } else {
-                    for (unsigned int i = 0; i < fCtrlChangeTable[ctrl].size(); i++) {
-                        fCtrlChangeTable[ctrl][i]->modifyZone(FAUSTFLOAT(value));
-                    }
-                }
-            }
+            modifyItems(fCtrlChangeTable, ctrl, date, FAUSTFLOAT(value));
         }
         
         void progChange(double date, int channel, int pgm)
         {
-            if (fProgChangeTable.find(pgm) != fProgChangeTable.end()) {
-                if (fTimeStamp) {
-                    for (unsigned int i = 0; i < fProgChangeTable[pgm].size(); i++) {
-                        fProgChangeTable[pgm][i]->modifyZone(date, FAUSTFLOAT(1));
-                    }
-                } else {
-                    for (unsigned int i = 0; i < fProgChangeTable[pgm].size(); i++) {
-                        fProgChangeTable[pgm][i]->modifyZone(FAUSTFLOAT(1));
-                    }
-                }
-            }
+            modifyItems(fProgChangeTable, pgm, date, FAUSTFLOAT(1));
         }
         
         void pitchWheel(double date, int channel, int wheel) 
         {
-            if (fTimeStamp) {
-                for (unsigned int i = 0; i < fPitchWheelTable.size(); i++) {
-                    fPitchWheelTable[i]->modifyZone(date, FAUSTFLOAT(wheel));
-                }
-            } else {
-                for (unsigned int i = 0; i < fPitchWheelTable.size(); i++) {
-                    fPitchWheelTable[i]->modifyZone(FAUSTFLOAT(wheel));
-                }
-            }
+            modifyItems(fPitchWheelTable, date, FAUSTFLOAT(wheel));
         }
         
         void keyPress(double date, int channel, int pitch, int press) 
         {
-            if (fKeyPressTable.find(pitch) != fKeyPressTable.end()) {
-                if (fTimeStamp) {
-                    for (unsigned int i = 0; i < fKeyPressTable[pitch].size(); i++) {
-                        fKeyPressTable[pitch][i]->modifyZone(date, FAUSTFLOAT(press));
-                    }
-                } else {
-                    for (unsigned int i = 0; i < fKeyPressTable[pitch].size(); i++) {
-                        fKeyPressTable[pitch][i]->modifyZone(FAUSTFLOAT(press));
-                    }
-                }
-            }
+            modifyItems(fKeyPressTable, pitch, date, FAUSTFLOAT(press));
         }
         
         void chanPress(double date, int channel, int press)
         {
-            if (fChanPressTable.find(press) != fChanPressTable.end()) {
-                if (fTimeStamp) {
-                    for (unsigned int i = 0; i < fChanPressTable[press].size(); i++) {
-                        fChanPressTable[press][i]->modifyZone(date, FAUSTFLOAT(1));
-                    }
-                } else {
-                    for (unsigned int i = 0; i < fChanPressTable[press].size(); i++) {
-                        fChanPressTable[press][i]->modifyZone(FAUSTFLOAT(1));
-                    }
-                }
-            } 
+            modifyItems(fChanPressTable, press, date, FAUSTFLOAT(1));
         }
         
         void ctrlChange14bits(double date, int channel, int ctrl, int value) {}
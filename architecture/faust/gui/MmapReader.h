@@ -0,0 +1,596 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __MmapReader__
+#define __MmapReader__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "faust/gui/Soundfile.h"
+
+/*
+ A 'MmapReader' object loads soundfiles for large sample libraries (POSIX systems only):
+
+ - the soundfile channels are allocated in a memory mapped (and already unlinked) temporary file,
+   so that the OS can page them out to this file and back in on demand, instead of keeping
+   the whole decoded audio in RAM (or swap). Only the real channels of the files are allocated.
+
+ - mono files whose samples are already in the FAUSTFLOAT format (32 bits float WAV or AIFC 'fl32' file
+   with 'float', 64 bits with 'double') are directly mapped in the channel, without any copy.
+
+ - other uncompressed files (WAV and AIFF/AIFC with 8/16/24/32 bits integer or 32/64 bits float samples)
+   are memory mapped and directly converted in the soundfile channels, without intermediate buffer.
+   Raw float files ('.f32' and '.f64' extensions) are headerless mono files, in the machine byte order
+   and at SAMPLE_RATE.
+
+ - other files are decoded by the COMPRESSED_READER base class (like LibsndfileReader) on a read-ahead thread,
+   so that the soundfile is returned immediately. Each part stays silent until it is decoded: a new copy of
+   the soundfile parameters including the part is then stored in the DSP soundfile zones set by SoundUI,
+   so that the DSP uses it at its next 'compute' (the parameters of the soundfile it reads are never modified).
+
+ So that the audio thread does not wait for the disk when starting to play a part, the first 'lock_frames'
+ frames of each part are locked in memory (or only prefaulted when the RLIMIT_MEMLOCK limit is reached),
+ and the OS is asked to read the rest of the part ahead.
+ */
+
+// Memory mapped soundfile channels, which also owns the read-ahead thread
+template <class COMPRESSED_READER>
+struct MmapMemory : public SoundfileMemory {
+
+    struct ReadJob {
+        std::string fPathName;
+        int fPart;
+        int fOffset;
+        int fMaxChan;
+    };
+
+    void* fData;
+    size_t fSize;
+    int fChannels;
+    int fLockFrames;
+
+    COMPRESSED_READER* fReader;
+    std::vector<ReadJob> fJobs;
+    std::mutex fMutex;
+    std::thread fThread;
+    bool fRunning;
+    bool fStopped;
+
+    // Decoded by the read-ahead thread (fChannels is -1 in the parameters copies, so that channels are not owned)
+    Soundfile fDecodedParams;                       // parts parameters filled by the decoder
+    int fMaxChan;
+    Soundfile* fCurrent;                            // last published parameters (the soundfile itself at first)
+    std::vector<Soundfile*> fVersions;              // published copies, kept until the soundfile is deleted
+    std::vector<Soundfile**> fZones;                // DSP zones the parameters are published to
+
+    MmapMemory(size_t size, int channels, int lock_frames, const std::string& directory, COMPRESSED_READER* reader)
+    :fData(MAP_FAILED), fSize(size), fChannels(channels), fLockFrames(lock_frames), fReader(reader),
+    fRunning(false), fStopped(false), fMaxChan(0), fCurrent(NULL)
+    {
+        std::string path_name = directory + "/faust-soundfile-XXXXXX";
+        std::vector<char> name(path_name.begin(), path_name.end());
+        name.push_back(0);
+        int fd = mkstemp(name.data());
+        if (fd < 0) {
+            throw std::bad_alloc();
+        }
+        // The file is only referenced by the mapping, and will be deleted with it
+        unlink(name.data());
+        if (ftruncate(fd, off_t(size)) == 0) {
+            fData = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (fData == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+    }
+
+    virtual ~MmapMemory()
+    {
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fStopped = true;
+        }
+        if (fThread.joinable()) fThread.join();
+        for (size_t i = 0; i < fVersions.size(); i++) {
+            delete fVersions[i];
+        }
+        munmap(fData, fSize);
+    }
+
+    FAUSTFLOAT* getChannel(int chan)
+    {
+        return static_cast<FAUSTFLOAT*>(fData) + (fSize / sizeof(FAUSTFLOAT) / fChannels) * chan;
+    }
+
+    /**
+     * Make the [offset, offset + length) frames of the first 'channels' channels resident before the audio thread
+     * reads them: the first 'fLockFrames' frames are locked (or prefaulted if they cannot be locked),
+     * and the OS is asked to read the others ahead.
+     */
+    void prefault(int offset, int length, int channels)
+    {
+        size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+        int lock_length = std::min<int>(length, fLockFrames);
+        for (int chan = 0; chan < std::min<int>(channels, fChannels); chan++) {
+            uintptr_t begin = uintptr_t(getChannel(chan) + offset) & ~uintptr_t(page_size - 1);
+            uintptr_t lock_end = uintptr_t(getChannel(chan) + offset + lock_length);
+            uintptr_t end = uintptr_t(getChannel(chan) + offset + length);
+            if (end > begin) madvise((void*)begin, end - begin, MADV_WILLNEED);
+            if (lock_end > begin && mlock((void*)begin, lock_end - begin) != 0) {
+                for (uintptr_t page = begin; page < lock_end; page += page_size) {
+                    (void)*static_cast<volatile unsigned char*>((void*)page);
+                }
+            }
+        }
+    }
+
+    // Called by SoundUI with the zone set to the soundfile, once all its parts have been set
+    virtual void addZone(Soundfile** zone)
+    {
+        start(*zone);
+        std::lock_guard<std::mutex> lock(fMutex);
+        fZones.push_back(zone);
+        *zone = fCurrent;
+    }
+
+    // Publish a copy of the current parameters with the decoded 'part' to the DSP zones
+    void publish(int part)
+    {
+        Soundfile* version = new Soundfile();
+        version->fBuffers = new FAUSTFLOAT*[fMaxChan];
+        memcpy(version->fBuffers, fCurrent->fBuffers, sizeof(FAUSTFLOAT*) * fMaxChan);
+        memcpy(version->fLength, fCurrent->fLength, sizeof(version->fLength));
+        memcpy(version->fSR, fCurrent->fSR, sizeof(version->fSR));
+        memcpy(version->fOffset, fCurrent->fOffset, sizeof(version->fOffset));
+        version->fLength[part] = fDecodedParams.fLength[part];
+        version->fSR[part] = fDecodedParams.fSR[part];
+        version->fOffset[part] = fDecodedParams.fOffset[part];
+
+        std::lock_guard<std::mutex> lock(fMutex);
+        fVersions.push_back(version);
+        fCurrent = version;
+        // The decoded samples and the copy are visible before the zones (read by the DSP in its next 'compute')
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < fZones.size(); i++) {
+            *fZones[i] = version;
+        }
+    }
+
+    void readAhead()
+    {
+        while (true) {
+            ReadJob job;
+            {
+                std::lock_guard<std::mutex> lock(fMutex);
+                if (fJobs.empty() || fStopped) {
+                    fRunning = false;
+                    return;
+                }
+                job = fJobs.front();
+                fJobs.erase(fJobs.begin());
+            }
+            // The part region is not used by the DSP yet (the part still refers to the silent frames)
+            fReader->COMPRESSED_READER::readFile(&fDecodedParams, job.fPathName, job.fPart, job.fOffset, job.fMaxChan);
+            prefault(fDecodedParams.fOffset[job.fPart], fDecodedParams.fLength[job.fPart], job.fMaxChan);
+            publish(job.fPart);
+        }
+    }
+
+    void pushJob(const ReadJob& job)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fJobs.push_back(job);
+    }
+
+    // Start decoding the compressed parts (only once), when all parts of 'soundfile' have been set
+    void start(Soundfile* soundfile)
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        if (fCurrent) return;
+        fCurrent = soundfile;
+        if (!fJobs.empty()) {
+            fRunning = true;
+            fThread = std::thread(&MmapMemory::readAhead, this);
+        }
+    }
+
+};
+
+template <class COMPRESSED_READER>
+struct MmapReader : public COMPRESSED_READER {
+
+    // Uncompressed file description
+    struct MappedFormat {
+        int fChannels;
+        int fLength;
+        int fSampleRate;
+        int fSampleSize;    // in bytes
+        bool fFloat;
+        bool fBigEndian;
+        bool fUnsigned;
+        size_t fDataOffset;
+    };
+
+    std::string fDirectory;
+    int fLockFrames;
+
+    /**
+     * Create the reader.
+     *
+     * @param directory - the directory where the soundfile channels temporary files are created (TMPDIR, or /tmp by default)
+     * @param lock_frames - the number of frames locked in memory at the beginning of each part
+     */
+    MmapReader(const std::string& directory = "", int lock_frames = 65536):fLockFrames(lock_frames)
+    {
+        const char* tmp_dir = getenv("TMPDIR");
+        fDirectory = (directory != "") ? directory : ((tmp_dir) ? tmp_dir : "/tmp");
+    }
+
+    static uint32_t readLE(const unsigned char* p, int bytes)
+    {
+        uint32_t res = 0;
+        for (int i = bytes - 1; i >= 0; i--) res = (res << 8) | p[i];
+        return res;
+    }
+
+    static uint32_t readBE(const unsigned char* p, int bytes)
+    {
+        uint32_t res = 0;
+        for (int i = 0; i < bytes; i++) res = (res << 8) | p[i];
+        return res;
+    }
+
+    // 80 bits IEEE 754 extended float, used for the AIFF sample rate
+    static double readExtended(const unsigned char* p)
+    {
+        int exponent = ((p[0] & 0x7F) << 8) | p[1];
+        uint64_t mantissa = (uint64_t(readBE(p + 2, 4)) << 32) | readBE(p + 6, 4);
+        double res = ldexp(double(mantissa), exponent - 16383 - 63);
+        return (p[0] & 0x80) ? -res : res;
+    }
+
+    static bool parseWAV(const unsigned char* data, size_t size, MappedFormat& format)
+    {
+        if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) return false;
+        int tag = -1, block_align = 0;
+        size_t pos = 12;
+        while (pos + 8 <= size) {
+            const unsigned char* chunk = data + pos;
+            size_t chunk_size = readLE(chunk + 4, 4);
+            if (memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16 && pos + 8 + chunk_size <= size) {
+                tag = readLE(chunk + 8, 2);
+                format.fChannels = readLE(chunk + 10, 2);
+                format.fSampleRate = readLE(chunk + 12, 4);
+                block_align = readLE(chunk + 20, 2);
+                format.fSampleSize = readLE(chunk + 22, 2) / 8;
+                // WAVE_FORMAT_EXTENSIBLE: the actual format is at the beginning of the sub-format GUID
+                if (tag == 0xFFFE && chunk_size >= 40) tag = readLE(chunk + 32, 2);
+            } else if (memcmp(chunk, "data", 4) == 0 && tag != -1) {
+                if (!(tag == 1 || tag == 3) || format.fChannels <= 0 || block_align != format.fChannels * format.fSampleSize) return false;
+                format.fFloat = (tag == 3);
+                format.fBigEndian = false;
+                format.fUnsigned = (format.fSampleSize == 1);
+                format.fDataOffset = pos + 8;
+                format.fLength = int(std::min<size_t>(chunk_size, size - format.fDataOffset) / block_align);
+                return true;
+            }
+            // Chunks are 2 bytes aligned
+            pos += 8 + chunk_size + (chunk_size & 1);
+        }
+        return false;
+    }
+
+    static bool parseAIFF(const unsigned char* data, size_t size, MappedFormat& format)
+    {
+        if (size < 12 || memcmp(data, "FORM", 4) != 0) return false;
+        bool aifc = (memcmp(data + 8, "AIFC", 4) == 0);
+        if (!aifc && memcmp(data + 8, "AIFF", 4) != 0) return false;
+        bool comm = false;
+        int frames = 0;
+        size_t pos = 12;
+        while (pos + 8 <= size) {
+            const unsigned char* chunk = data + pos;
+            size_t chunk_size = readBE(chunk + 4, 4);
+            if (memcmp(chunk, "COMM", 4) == 0 && chunk_size >= 18 && pos + 8 + chunk_size <= size) {
+                format.fChannels = int16_t(readBE(chunk + 8, 2));
+                frames = int(readBE(chunk + 10, 4));
+                format.fSampleSize = (int16_t(readBE(chunk + 14, 2)) + 7) / 8;
+                format.fSampleRate = int(readExtended(chunk + 16));
+                format.fFloat = false;
+                format.fBigEndian = true;
+                format.fUnsigned = false;
+                if (aifc) {
+                    if (chunk_size < 22) return false;
+                    if (memcmp(chunk + 26, "sowt", 4) == 0) {
+                        format.fBigEndian = false;
+                    } else if (memcmp(chunk + 26, "fl32", 4) == 0 || memcmp(chunk + 26, "FL32", 4) == 0) {
+                        format.fFloat = true;
+                        format.fSampleSize = 4;
+                    } else if (memcmp(chunk + 26, "fl64", 4) == 0 || memcmp(chunk + 26, "FL64", 4) == 0) {
+                        format.fFloat = true;
+                        format.fSampleSize = 8;
+                    } else if (memcmp(chunk + 26, "NONE", 4) != 0) {
+                        // Compressed AIFC
+                        return false;
+                    }
+                }
+                comm = true;
+            } else if (memcmp(chunk, "SSND", 4) == 0 && comm && chunk_size >= 8) {
+                if (format.fChannels <= 0) return false;
+                size_t block_align = size_t(format.fChannels) * format.fSampleSize;
+                format.fDataOffset = pos + 16 + readBE(chunk + 8, 4);
+                if (format.fDataOffset > size) return false;
+                format.fLength = int(std::min<size_t>(frames, (size - format.fDataOffset) / block_align));
+                return true;
+            }
+            pos += 8 + chunk_size + (chunk_size & 1);
+        }
+        return false;
+    }
+
+    // Headerless mono float files, in the machine byte order
+    static bool parseRaw(const std::string& path_name, size_t size, MappedFormat& format)
+    {
+        size_t dot = path_name.rfind('.');
+        std::string extension = (dot == std::string::npos) ? "" : path_name.substr(dot);
+        if (extension != ".f32" && extension != ".f64") return false;
+        const uint16_t one = 1;
+        format.fChannels = 1;
+        format.fSampleRate = SAMPLE_RATE;
+        format.fSampleSize = (extension == ".f32") ? 4 : 8;
+        format.fFloat = true;
+        format.fBigEndian = (*reinterpret_cast<const unsigned char*>(&one) == 0);
+        format.fUnsigned = false;
+        format.fDataOffset = 0;
+        format.fLength = int(size / format.fSampleSize);
+        return format.fLength > 0;
+    }
+
+    static bool parseFile(const std::string& path_name, const unsigned char* data, size_t size, MappedFormat& format)
+    {
+        return (parseWAV(data, size, format) || parseAIFF(data, size, format) || parseRaw(path_name, size, format))
+            && checkFormat(format);
+    }
+
+    static bool checkFormat(const MappedFormat& format)
+    {
+        if (format.fFloat) {
+            return (format.fSampleSize == 4 || format.fSampleSize == 8);
+        } else {
+            return (format.fSampleSize >= 1 && format.fSampleSize <= 4);
+        }
+    }
+
+    // Mono files with FAUSTFLOAT samples, that are directly mapped in the channel
+    static bool isNativeFormat(const MappedFormat& format)
+    {
+        const uint16_t one = 1;
+        bool little_endian = (*reinterpret_cast<const unsigned char*>(&one) == 1);
+        return format.fChannels == 1
+            && format.fFloat
+            && format.fSampleSize == int(sizeof(FAUSTFLOAT))
+            && format.fBigEndian != little_endian
+            && format.fDataOffset % sizeof(FAUSTFLOAT) == 0;
+    }
+
+    // Frames reserved for a directly mapped part: the part has to start at the same position in a page as in the file,
+    // and its pages cannot be shared with other parts
+    static int getMappedLength(const MappedFormat& format)
+    {
+        return format.fLength + 3 * int(sysconf(_SC_PAGESIZE) / sizeof(FAUSTFLOAT));
+    }
+
+    // Map a file in memory, to be unmapped with munmap
+    static const unsigned char* mapFile(const std::string& path_name, size_t& size)
+    {
+        int fd = open(path_name.c_str(), O_RDONLY);
+        if (fd < 0) return NULL;
+        struct stat info;
+        void* data = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            size = size_t(info.st_size);
+            data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        return (data == MAP_FAILED) ? NULL : static_cast<const unsigned char*>(data);
+    }
+
+    // Returns true if the file is an uncompressed one that can be directly read
+    static bool getMappedFormat(const std::string& path_name, MappedFormat& format)
+    {
+        size_t size = 0;
+        const unsigned char* data = mapFile(path_name, size);
+        if (!data) return false;
+        bool res = parseFile(path_name, data, size, format);
+        munmap((void*)data, size);
+        return res;
+    }
+
+    static FAUSTFLOAT readSample(const unsigned char* p, const MappedFormat& format)
+    {
+        // First 32 bits of 64 bits samples
+        int bytes = std::min<int>(format.fSampleSize, 4);
+        uint32_t bits = (format.fBigEndian) ? readBE(p, bytes) : readLE(p, bytes);
+        if (format.fFloat) {
+            if (format.fSampleSize == 4) {
+                float res;
+                memcpy(&res, &bits, sizeof(float));
+                return FAUSTFLOAT(res);
+            } else {
+                uint32_t bits2 = (format.fBigEndian) ? readBE(p + 4, 4) : readLE(p + 4, 4);
+                uint64_t bits64 = (format.fBigEndian) ? ((uint64_t(bits) << 32) | bits2) : ((uint64_t(bits2) << 32) | bits);
+                double res;
+                memcpy(&res, &bits64, sizeof(double));
+                return FAUSTFLOAT(res);
+            }
+        } else if (format.fUnsigned) {
+            return FAUSTFLOAT((int(bits) - 128) / 128.);
+        } else {
+            // Left justify the sample to convert it as a 32 bits signed integer
+            int32_t res = int32_t(bits << (32 - 8 * format.fSampleSize));
+            return FAUSTFLOAT(res / 2147483648.);
+        }
+    }
+
+    bool checkFile(const std::string& path_name)
+    {
+        MappedFormat format;
+        return getMappedFormat(path_name, format) || COMPRESSED_READER::checkFile(path_name);
+    }
+
+    void getParamsFile(const std::string& path_name, int& channels, int& length)
+    {
+        MappedFormat format;
+        if (getMappedFormat(path_name, format)) {
+            channels = format.fChannels;
+            length = (isNativeFormat(format)) ? getMappedLength(format) : format.fLength;
+        } else {
+            COMPRESSED_READER::getParamsFile(path_name, channels, length);
+        }
+    }
+
+    // Map the samples of a native format file in the first channel, in place of the temporary file pages
+    bool mapNativeFile(Soundfile* soundfile, const std::string& path_name, const MappedFormat& format, int part, int offset)
+    {
+        size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+        size_t data_page = format.fDataOffset & ~(page_size - 1);
+        size_t page_offset = format.fDataOffset - data_page;
+
+        // First page after the previous part
+        uintptr_t address = (uintptr_t(&soundfile->fBuffers[0][offset]) + page_size - 1) & ~uintptr_t(page_size - 1);
+        size_t size = page_offset + size_t(format.fLength) * sizeof(FAUSTFLOAT);
+
+        int fd = open(path_name.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        void* data = mmap((void*)address, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, off_t(data_page));
+        close(fd);
+        if (data == MAP_FAILED) return false;
+
+        soundfile->fLength[part] = format.fLength;
+        soundfile->fSR[part] = format.fSampleRate;
+        soundfile->fOffset[part] = int((address + page_offset - uintptr_t(soundfile->fBuffers[0])) / sizeof(FAUSTFLOAT));
+        return true;
+    }
+
+    void readFile(Soundfile* soundfile, const std::string& path_name, int part, int& offset, int max_chan)
+    {
+        MmapMemory<COMPRESSED_READER>* memory = static_cast<MmapMemory<COMPRESSED_READER>*>(soundfile->fMemory);
+        MappedFormat format;
+        size_t size = 0;
+        const unsigned char* data = mapFile(path_name, size);
+        bool uncompressed = data && parseFile(path_name, data, size, format);
+
+        if (uncompressed && isNativeFormat(format) && mapNativeFile(soundfile, path_name, format, part, offset)) {
+            munmap((void*)data, size);
+            memory->prefault(soundfile->fOffset[part], soundfile->fLength[part], 1);
+
+            // Update offset
+            offset += getMappedLength(format);
+
+        } else if (uncompressed) {
+            soundfile->fLength[part] = format.fLength;
+            soundfile->fSR[part] = format.fSampleRate;
+            soundfile->fOffset[part] = offset;
+
+            // The file is only read once, in sequence
+            madvise((void*)data, size, MADV_SEQUENTIAL);
+            int channels = std::min<int>(max_chan, format.fChannels);
+            size_t frame_size = size_t(format.fChannels) * format.fSampleSize;
+            const unsigned char* frames = data + format.fDataOffset;
+            for (int chan = 0; chan < channels; chan++) {
+                FAUSTFLOAT* buffer = &soundfile->fBuffers[chan][offset];
+                const unsigned char* sample = frames + chan * format.fSampleSize;
+                for (int frame = 0; frame < format.fLength; frame++, sample += frame_size) {
+                    buffer[frame] = readSample(sample, format);
+                }
+            }
+            munmap((void*)data, size);
+            memory->prefault(offset, format.fLength, channels);
+
+            // Update offset
+            offset += (isNativeFormat(format)) ? getMappedLength(format) : format.fLength;
+
+        } else {
+            if (data) munmap((void*)data, size);
+
+            // Silent until decoded by the read-ahead thread, started once all parts are set
+            int channels, length;
+            COMPRESSED_READER::getParamsFile(path_name, channels, length);
+            SoundfileReader::emptyFile(soundfile, part);
+
+            typename MmapMemory<COMPRESSED_READER>::ReadJob job = { path_name, part, offset, std::min<int>(max_chan, channels) };
+            memory->pushJob(job);
+
+            // Update offset
+            offset += length;
+        }
+    }
+
+    Soundfile* createSoundfile(int cur_chan, int length, int max_chan)
+    {
+        Soundfile* soundfile = new Soundfile();
+        // Zero filled by the file creation
+        MmapMemory<COMPRESSED_READER>* memory = new MmapMemory<COMPRESSED_READER>(size_t(cur_chan) * size_t(length) * sizeof(FAUSTFLOAT),
+                                                                                  cur_chan, fLockFrames, fDirectory, this);
+        soundfile->fMemory = memory;
+        memory->fMaxChan = max_chan;
+        soundfile->fBuffers = new FAUSTFLOAT*[max_chan];
+        memory->fDecodedParams.fBuffers = new FAUSTFLOAT*[max_chan];
+        for (int chan = 0; chan < cur_chan; chan++) {
+            soundfile->fBuffers[chan] = memory->getChannel(chan);
+            memory->fDecodedParams.fBuffers[chan] = memory->getChannel(chan);
+        }
+        soundfile->fChannels = cur_chan;
+        // Silent frames shared by empty and not yet decoded parts
+        memory->prefault(0, BUFFER_SIZE, cur_chan);
+        return soundfile;
+    }
+
+    // Base class version, hidden by the previous one: also starts the decoding (SoundUI, which calls the base class one, starts it in 'addZone')
+    Soundfile* createSoundfile(const std::vector<std::string>& path_name_list, int max_chan)
+    {
+        Soundfile* soundfile = SoundfileReader::createSoundfile(path_name_list, max_chan);
+        if (soundfile) {
+            static_cast<MmapMemory<COMPRESSED_READER>*>(soundfile->fMemory)->start(soundfile);
+        }
+        return soundfile;
+    }
+
+};
+
+#endif
@@ -172,6 +172,7 @@ class OSCUI : public GUI
         
         virtual void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
         {
+            registerPassiveZone(zone);
             const char* l = tr(label);
             addalias(zone, 0, min, max, l);
             fCtrl->addnode(l, zone, FAUSTFLOAT(0), min, max, false);
@@ -179,6 +180,7 @@ class OSCUI : public GUI
         }
         virtual void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
         {
+            registerPassiveZone(zone);
             const char* l = tr(label);
             addalias(zone, 0, min, max, l);
             fCtrl->addnode(l, zone, FAUSTFLOAT(0), min, max, false);
@@ -201,6 +203,13 @@ class OSCUI : public GUI
             return true;
         }
         
+        // Called on each UI refresh: the coalesced values are sent in a single bundle (in bundle mode)
+        virtual void updateAllZones()
+        {
+            GUI::updateAllZones();
+            fCtrl->sendBundle();
+        }
+        
         void stop()			{ fCtrl->stop(); }
         void endBundle() 	{ fCtrl->endBundle(); }
         
@@ -1826,6 +1826,7 @@ public:
     
     virtual void addHorizontalBargraph(const char* label , FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
     {
+        registerPassiveZone(zone);
         openVerticalBox(label);
         if (isNumerical(zone)) {
             addNumDisplay(0, zone, min, min, max, (max-min)/1000.0);
@@ -1856,6 +1857,7 @@ public:
     
     virtual void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
     {
+        registerPassiveZone(zone);
         openVerticalBox(label);
         if (isNumerical(zone)) {
             addNumDisplay(0, zone, min, min, max, (max-min)/1000.0);
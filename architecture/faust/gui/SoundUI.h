@@ -44,6 +44,10 @@ JuceReader gReader;
 #elif defined(MEMORY_READER)
 #include "faust/gui/MemoryReader.h"
 MemoryReader gReader;
+#elif defined(MMAP_READER)
+#include "faust/gui/LibsndfileReader.h"
+#include "faust/gui/MmapReader.h"
+MmapReader<LibsndfileReader> gReader;
 #else
 #include "faust/gui/LibsndfileReader.h"
 LibsndfileReader gReader;
@@ -113,6 +117,7 @@ class SoundUI : public GenericUI
             
             // Get the soundfile
             *sf_zone = fSoundfileMap[saved_url];
+            if ((*sf_zone)->fMemory) (*sf_zone)->fMemory->addZone(sf_zone);
         }
     
         static std::string getBinaryPath(std::string folder = "")
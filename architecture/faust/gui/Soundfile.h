@@ -46,6 +46,18 @@
 #define POST_PACKED_STRUCTURE __attribute__((__packed__))
 #endif
 
+struct Soundfile;
+
+/*
+ Owner of the soundfile channels memory, when not allocated with 'new' by SoundfileReader::createSoundfile.
+ The memory is released in the subclass destructor.
+ */
+struct SoundfileMemory {
+    virtual ~SoundfileMemory() {}
+    // To be called when 'zone' is set to the soundfile, so that the parts loaded in the background can be published there
+    virtual void addZone(Soundfile** zone) {}
+};
+
 /*
  The soundfile structure to be used by the DSP code. Soundfile has a MAX_SOUNDFILE_PARTS parts 
  (even a single soundfile or an empty soundfile). 
@@ -67,18 +79,24 @@ struct Soundfile {
     int fSR[MAX_SOUNDFILE_PARTS];         // sample rate of each part
     int fOffset[MAX_SOUNDFILE_PARTS];     // offset of each part in the global buffer
     int fChannels;                        // max number of channels of all concatenated files
+    SoundfileMemory* fMemory;             // owner of the channels memory if not allocated with 'new' (not accessed by the DSP code)
 
     Soundfile()
     {
         fBuffers  = NULL;
         fChannels = -1;
+        fMemory   = NULL;
     }
 
     ~Soundfile()
     {
-        // Free the real channels only
-        for (int chan = 0; chan < fChannels; chan++) {
-            delete fBuffers[chan];
+        if (fMemory) {
+            delete fMemory;
+        } else {
+            // Free the real channels only
+            for (int chan = 0; chan < fChannels; chan++) {
+                delete [] fBuffers[chan];
+            }
         }
         delete[] fBuffers;
     }
@@ -93,16 +111,20 @@ class SoundfileReader {
     
    protected:
     
-    void emptyFile(Soundfile* soundfile, int part, int& offset)
+    // Empty parts all share the BUFFER_SIZE silent frames at the beginning of the buffers
+    void emptyFile(Soundfile* soundfile, int part)
     {
         soundfile->fLength[part] = BUFFER_SIZE;
         soundfile->fSR[part] = SAMPLE_RATE;
-        soundfile->fOffset[part] = offset;
-        // Update offset
-        offset += soundfile->fLength[part];
+        soundfile->fOffset[part] = 0;
     }
 
-    Soundfile* createSoundfile(int cur_chan, int length, int max_chan)
+    /**
+     * Allocate the soundfile with 'cur_chan' real channels of 'length' frames set to zero,
+     * the 'fBuffers' array having 'max_chan' entries. Can be redefined by subclasses
+     * to use another kind of memory (owned by the 'fMemory' field).
+     */
+    virtual Soundfile* createSoundfile(int cur_chan, int length, int max_chan)
     {
         Soundfile* soundfile = new Soundfile();
         if (!soundfile) {
@@ -187,13 +209,13 @@ class SoundfileReader {
     {
         try {
             int cur_chan = 1; // At least one buffer
-            int total_length = 0;
+            int total_length = BUFFER_SIZE; // Silent frames shared by empty parts
             
             // Compute total length and chan max of all files
             for (size_t i = 0; i < path_name_list.size(); i++) {
                 int chan, length;
                 if (path_name_list[i] == "__empty_sound__") {
-                    length = BUFFER_SIZE;
+                    length = 0;
                     chan = 1;
                 } else {
                     getParamsFile(path_name_list[i], chan, length);
@@ -202,19 +224,16 @@ class SoundfileReader {
                 total_length += length;
             }
            
-            // Complete with empty parts
-            total_length += (MAX_SOUNDFILE_PARTS - path_name_list.size()) * BUFFER_SIZE;
-            
             // Create the soundfile
             Soundfile* soundfile = createSoundfile(cur_chan, total_length, max_chan);
             
-            // Init offset
-            int offset = 0;
+            // Init offset after the silent frames
+            int offset = BUFFER_SIZE;
             
             // Read all files
             for (size_t i = 0; i < path_name_list.size(); i++) {
                 if (path_name_list[i] == "__empty_sound__") {
-                    emptyFile(soundfile, i, offset);
+                    emptyFile(soundfile, i);
                 } else {
                     readFile(soundfile, path_name_list[i], i, offset, max_chan);
                 }
@@ -222,7 +241,7 @@ class SoundfileReader {
             
             // Complete with empty parts
             for (int i = path_name_list.size(); i < MAX_SOUNDFILE_PARTS; i++) {
-                emptyFile(soundfile, i, offset);
+                emptyFile(soundfile, i);
             }
             
             // Share the same buffers for all other channels so that we have max_chan channels available
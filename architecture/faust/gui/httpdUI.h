@@ -27,6 +27,8 @@
 #include <iostream>
 #include <sstream>
 #include <cstdlib>
+#include <cstring>
+#include <vector>
 
 #include "faust/gui/HTTPDControler.h"
 #include "faust/gui/DecoratorUI.h"
@@ -197,6 +199,7 @@ class httpdClientUI : public GUI, public PathBuilder, public httpdUIAux
         std::string fServerURL;
         std::string fJSON;
         std::map<std::string, FAUSTFLOAT*> fZoneMap;
+        std::vector<FAUSTFLOAT*> fValuesZones;  // zones in the server '/values' order (empty with older servers)
         pthread_t fThread;
         int fTCPPort;
         bool fRunning;
@@ -206,11 +209,57 @@ class httpdClientUI : public GUI, public PathBuilder, public httpdUIAux
             fZoneMap[label] = zone;
         }
 
+        // Map the server parameters addresses (from '/addresses') to the zones
+        void buildValuesZones()
+        {
+            char* answer = 0;
+            std::string url = fServerURL + "/addresses";
+            int size = http_fetch(url.c_str(), &answer);
+            if (size <= 0 || !answer) return;
+            std::string addresses(answer, size);
+            // 'http_fetch' result must be deallocated
+            free(answer);
+            bool found = false;
+            // Addresses are quoted in a JSON array
+            size_t begin = addresses.find('"');
+            while (begin != std::string::npos) {
+                size_t end = addresses.find('"', begin + 1);
+                if (end == std::string::npos) break;
+                std::map<std::string, FAUSTFLOAT*>::iterator it = fZoneMap.find(fServerURL + addresses.substr(begin + 1, end - begin - 1));
+                fValuesZones.push_back((it != fZoneMap.end()) ? (*it).second : 0);
+                found |= (it != fZoneMap.end());
+                begin = addresses.find('"', end + 1);
+            }
+            if (!found) fValuesZones.clear();
+        }
+
+        // Read all the values with a single '/values' request
+        void updateValues()
+        {
+            char* answer = 0;
+            std::string url = fServerURL + "/values";
+            int size = http_fetch(url.c_str(), &answer);
+            if (size <= 0 || !answer) return;
+            std::string values(answer, size);
+            // 'http_fetch' result must be deallocated
+            free(answer);
+            const char* p = values.c_str();
+            for (size_t i = 0; i < fValuesZones.size() && (p = strpbrk(p, "[,")); i++, p++) {
+                FAUSTFLOAT v = (FAUSTFLOAT)std::strtod(p + 1, NULL);
+                if (fValuesZones[i]) *fValuesZones[i] = v;
+            }
+        }
+
         static void* UpdateUI(void* arg)
         {
             httpdClientUI* ui = static_cast<httpdClientUI*>(arg);
             std::map<std::string, FAUSTFLOAT*>::iterator it;
             while (ui->fRunning) {
+                if (ui->fValuesZones.size() > 0) {
+                    ui->updateValues();
+                    usleep(100000);
+                    continue;
+                }
                 for (it = ui->fZoneMap.begin(); it != ui->fZoneMap.end(); it++) {
                     char* answer;
                     std::string path = (*it).first;
@@ -302,10 +351,12 @@ class httpdClientUI : public GUI, public PathBuilder, public httpdUIAux
         // -- passive widgets
         virtual void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
         {
+            registerPassiveZone(zone);
             addGeneric(label, zone);
         }
         virtual void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
         {
+            registerPassiveZone(zone);
             addGeneric(label, zone);
         }
 
@@ -314,6 +365,7 @@ class httpdClientUI : public GUI, public PathBuilder, public httpdUIAux
         bool run()
         {
             if (fTCPPort > 0) {
+                buildValuesZones();
                 fRunning = true;
                 return (pthread_create(&fThread, NULL, UpdateUI, this) == 0);
             } else {
@@ -0,0 +1,190 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+
+#ifndef __mpmc_ring_buffer__
+#define __mpmc_ring_buffer__
+
+#include <stddef.h>
+#include <atomic>
+
+//--------------------------------------------------------------------------------------
+//  Lock-free bounded multiple producers / multiple consumers ring buffer of T records
+//  (D. Vyukov's algorithm).
+//
+//  - each cell carries a sequence number, telling whether it is ready to be written
+//    (seq == index) or read (seq == index + 1) at a given index
+//  - producers (and consumers) claim an index with a CAS on the write (read) index,
+//    so that no thread ever waits for another one: a thread preempted between the claim
+//    and the publication of its cell only delays the reading of the following records
+//  - a producer can claim a cell with 'write_claim', fill it in place, then publish it
+//    with 'write_commit', so that records can be built after room has been reserved
+//  - 'push' and 'write_claim' can keep 'reserve' cells free, so that some records
+//    (typically the more important ones) can still be pushed when the others cannot
+//
+//  T must be trivially copyable. The capacity is rounded up to the next power of two.
+//--------------------------------------------------------------------------------------
+
+#ifndef FAUST_CACHE_LINE_SIZE
+#define FAUST_CACHE_LINE_SIZE 64
+#endif
+
+template <typename T>
+class mpmc_ring_buffer {
+
+    private:
+
+        struct cell {
+            std::atomic<size_t> fSeq;
+            T fRecord;
+        };
+
+        // Producers side
+        std::atomic<size_t> fWrite;
+        char fPad1[FAUST_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+
+        // Consumers side
+        std::atomic<size_t> fRead;
+        char fPad2[FAUST_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+
+        // Shared and constant
+        cell* fBuffer;
+        size_t fSize;
+        size_t fMask;
+
+        mpmc_ring_buffer(const mpmc_ring_buffer&);
+        mpmc_ring_buffer& operator=(const mpmc_ring_buffer&);
+
+    public:
+
+        mpmc_ring_buffer(size_t capacity):fWrite(0), fRead(0)
+        {
+            for (fSize = 1; fSize < capacity; fSize <<= 1);
+            fMask = fSize - 1;
+            fBuffer = new cell[fSize];
+            reset();
+        }
+
+        virtual ~mpmc_ring_buffer()
+        {
+            delete [] fBuffer;
+        }
+
+        size_t capacity() const { return fSize; }
+
+        // Producers API
+
+        /*
+         Claim a cell, keeping at least 'reserve' cells free, and return its record (or 0 if the ring is full).
+         The record has to be published with 'write_commit(index)', and is not read before.
+         With a single consumer (using 'front' and 'read_advance'), when a claim without reserve fails
+         (the ring is full), the last cell has also been claimed without reserve.
+        */
+        T* write_claim(size_t& index, size_t reserve = 0)
+        {
+            size_t write = fWrite.load(std::memory_order_acquire);
+            for (;;) {
+                cell* c = &fBuffer[write & fMask];
+                ptrdiff_t diff = ptrdiff_t(c->fSeq.load(std::memory_order_acquire)) - ptrdiff_t(write);
+                if (diff == 0) {
+                    // The read index is loaded after the write index, so it is never older than the
+                    // one used by the producer of the previous cell
+                    if (reserve > 0 && write - fRead.load(std::memory_order_acquire) + reserve >= fSize) return 0;
+                    if (fWrite.compare_exchange_weak(write, write + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        index = write;
+                        return &c->fRecord;
+                    }
+                } else if (diff < 0) {
+                    return 0;
+                } else {
+                    write = fWrite.load(std::memory_order_acquire);
+                }
+            }
+        }
+
+        void write_commit(size_t index)
+        {
+            fBuffer[index & fMask].fSeq.store(index + 1, std::memory_order_release);
+        }
+
+        bool push(const T& record, size_t reserve = 0)
+        {
+            size_t index;
+            T* cell = write_claim(index, reserve);
+            if (!cell) return false;
+            *cell = record;
+            write_commit(index);
+            return true;
+        }
+
+        // Consumers API
+
+        bool pop(T& record)
+        {
+            size_t read = fRead.load(std::memory_order_relaxed);
+            for (;;) {
+                cell* c = &fBuffer[read & fMask];
+                ptrdiff_t diff = ptrdiff_t(c->fSeq.load(std::memory_order_acquire)) - ptrdiff_t(read + 1);
+                if (diff == 0) {
+                    if (fRead.compare_exchange_weak(read, read + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                        record = c->fRecord;
+                        c->fSeq.store(read + fSize, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    read = fRead.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // First available record (or null), which stays in the ring: only valid with a single consumer
+        T* front()
+        {
+            size_t read = fRead.load(std::memory_order_relaxed);
+            cell* c = &fBuffer[read & fMask];
+            return (c->fSeq.load(std::memory_order_acquire) == read + 1) ? &c->fRecord : 0;
+        }
+
+        // Release the record returned by 'front': only valid with a single consumer
+        void read_advance()
+        {
+            size_t read = fRead.load(std::memory_order_relaxed);
+            fBuffer[read & fMask].fSeq.store(read + fSize, std::memory_order_release);
+            fRead.store(read + 1, std::memory_order_release);
+        }
+
+        // Not thread safe: to be used when neither producers nor consumers are running
+        void reset()
+        {
+            for (size_t i = 0; i < fSize; i++) {
+                fBuffer[i].fSeq.store(i, std::memory_order_relaxed);
+            }
+            fWrite.store(0, std::memory_order_relaxed);
+            fRead.store(0, std::memory_order_relaxed);
+        }
+
+};
+
+#endif
@@ -0,0 +1,215 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __spsc_ring_buffer__
+#define __spsc_ring_buffer__
+
+#include <stddef.h>
+#include <atomic>
+
+//--------------------------------------------------------------------------------------
+//  Wait-free single producer / single consumer ring buffer of T records.
+//
+//  - records are pushed and popped whole, so a reader never sees a partial record
+//  - the write index is only modified by the producer, the read index by the consumer,
+//    and they are published with release stores and read with acquire loads
+//  - each side keeps a cached copy of the other side index, so the shared index is only
+//    loaded when the cached one says the ring is full (producer) or empty (consumer)
+//  - producer and consumer data are kept on separate cache lines to avoid false sharing
+//  - the consumer can access all available records at once with 'read_available'
+//    (at most two contiguous parts), then release them with a single 'read_advance'
+//
+//  T must be trivially copyable. The capacity is rounded up to the next power of two,
+//  and all of it can be used (indices are not wrapped, only their masked value is).
+//--------------------------------------------------------------------------------------
+
+#ifndef FAUST_CACHE_LINE_SIZE
+#define FAUST_CACHE_LINE_SIZE 64
+#endif
+
+template <typename T>
+class spsc_ring_buffer {
+
+    public:
+
+        // The records available for reading, as two contiguous parts
+        struct read_span {
+
+            T* fFirst;
+            size_t fFirstSize;
+            T* fSecond;
+            size_t fSecondSize;
+
+            read_span():fFirst(0), fFirstSize(0), fSecond(0), fSecondSize(0) {}
+
+            size_t size() const { return fFirstSize + fSecondSize; }
+
+            T& operator[](size_t index) const
+            {
+                return (index < fFirstSize) ? fFirst[index] : fSecond[index - fFirstSize];
+            }
+
+        };
+
+    private:
+
+        // Producer side
+        std::atomic<size_t> fWrite;
+        size_t fCachedRead;
+        char fPad1[FAUST_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+
+        // Consumer side
+        std::atomic<size_t> fRead;
+        size_t fCachedWrite;
+        char fPad2[FAUST_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+
+        // Shared and constant
+        T* fBuffer;
+        size_t fSize;
+        size_t fMask;
+        char fPad3[FAUST_CACHE_LINE_SIZE - sizeof(T*) - 2 * sizeof(size_t)];
+
+        spsc_ring_buffer(const spsc_ring_buffer&);
+        spsc_ring_buffer& operator=(const spsc_ring_buffer&);
+
+        // Producer: free space, reloading the read index only when needed
+        size_t writeSpace(size_t write, size_t needed)
+        {
+            size_t space = fSize - (write - fCachedRead);
+            if (space < needed) {
+                fCachedRead = fRead.load(std::memory_order_acquire);
+                space = fSize - (write - fCachedRead);
+            }
+            return space;
+        }
+
+        // Consumer: available records, reloading the write index only when needed
+        size_t readSpace(size_t read, size_t needed)
+        {
+            size_t space = fCachedWrite - read;
+            if (space < needed) {
+                fCachedWrite = fWrite.load(std::memory_order_acquire);
+                space = fCachedWrite - read;
+            }
+            return space;
+        }
+
+    public:
+
+        spsc_ring_buffer(size_t capacity):fWrite(0), fCachedRead(0), fRead(0), fCachedWrite(0)
+        {
+            for (fSize = 1; fSize < capacity; fSize <<= 1);
+            fMask = fSize - 1;
+            fBuffer = new T[fSize];
+        }
+
+        virtual ~spsc_ring_buffer()
+        {
+            delete [] fBuffer;
+        }
+
+        size_t capacity() const { return fSize; }
+
+        // Producer API
+
+        bool push(const T& record)
+        {
+            size_t write = fWrite.load(std::memory_order_relaxed);
+            if (writeSpace(write, 1) == 0) return false;
+            fBuffer[write & fMask] = record;
+            fWrite.store(write + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Push at most 'count' records, returns the number of pushed records
+        size_t push(const T* records, size_t count)
+        {
+            size_t write = fWrite.load(std::memory_order_relaxed);
+            size_t space = writeSpace(write, count);
+            if (count > space) count = space;
+            for (size_t i = 0; i < count; i++) {
+                fBuffer[(write + i) & fMask] = records[i];
+            }
+            fWrite.store(write + count, std::memory_order_release);
+            return count;
+        }
+
+        size_t write_available()
+        {
+            return writeSpace(fWrite.load(std::memory_order_relaxed), fSize);
+        }
+
+        // Consumer API
+
+        bool pop(T& record)
+        {
+            size_t read = fRead.load(std::memory_order_relaxed);
+            if (readSpace(read, 1) == 0) return false;
+            record = fBuffer[read & fMask];
+            fRead.store(read + 1, std::memory_order_release);
+            return true;
+        }
+
+        // First available record (or null), which stays in the ring
+        T* front()
+        {
+            size_t read = fRead.load(std::memory_order_relaxed);
+            return (readSpace(read, 1) == 0) ? 0 : &fBuffer[read & fMask];
+        }
+
+        // All records available at call time, which stay in the ring until 'read_advance'
+        read_span read_available()
+        {
+            read_span span;
+            size_t read = fRead.load(std::memory_order_relaxed);
+            size_t count = readSpace(read, fSize);
+            size_t first = read & fMask;
+            span.fFirst = &fBuffer[first];
+            span.fFirstSize = (count < fSize - first) ? count : (fSize - first);
+            span.fSecond = fBuffer;
+            span.fSecondSize = count - span.fFirstSize;
+            return span;
+        }
+
+        // Release 'count' records previously returned by 'front' or 'read_available'
+        void read_advance(size_t count)
+        {
+            fRead.store(fRead.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+        size_t read_size()
+        {
+            return readSpace(fRead.load(std::memory_order_relaxed), fSize);
+        }
+
+        // Not thread safe: to be used when neither producer nor consumer are running
+        void reset()
+        {
+            fWrite.store(0, std::memory_order_relaxed);
+            fRead.store(0, std::memory_order_relaxed);
+            fCachedRead = fCachedWrite = 0;
+        }
+
+};
+
+#endif
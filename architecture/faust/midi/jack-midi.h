@@ -29,7 +29,7 @@
 
 #include <jack/midiport.h>
 #include "faust/midi/midi.h"
-#include "faust/gui/ring-buffer.h"
+#include "faust/gui/spsc-ring-buffer.h"
 
 class MapUI;
 
@@ -41,14 +41,12 @@ class jack_midi_handler : public midi_handler {
         
     protected:
 
-        ringbuffer_t* fOutBuffer;
+        spsc_ring_buffer<DatedMessage> fOutBuffer;
 
         void writeMessage(double date, unsigned char* buffer, size_t size)
         {
-            size_t res;
-            DatedMessage dated_message(date, buffer, size);
-            if ((res = ringbuffer_write(fOutBuffer, (const char*)&dated_message, sizeof(DatedMessage))) != sizeof(DatedMessage)) {
-                std::cerr << "ringbuffer_write error DatedMessage" << std::endl;
+            if (!fOutBuffer.push(DatedMessage(date, buffer, size))) {
+                std::cerr << "ring buffer write error DatedMessage" << std::endl;
             }
         }
 
@@ -88,9 +86,10 @@ class jack_midi_handler : public midi_handler {
                 jack_midi_clear_buffer(port_buf_out);
             }
            
-            // Write each message one by one
-            DatedMessage dated_message;
-            while (ringbuffer_read(fOutBuffer, (char*)&dated_message, sizeof(DatedMessage)) == sizeof(DatedMessage)) {
+            // Write all available messages, then release them at once
+            spsc_ring_buffer<DatedMessage>::read_span messages = fOutBuffer.read_available();
+            for (size_t i = 0; i < messages.size(); i++) {
+                const DatedMessage& dated_message = messages[i];
                 jack_midi_data_t* data = jack_midi_event_reserve(port_buf_out, dated_message.fDate, dated_message.fSize);
                 if (data) {
                     memcpy(data, dated_message.fBuffer, dated_message.fSize);
@@ -98,19 +97,16 @@ class jack_midi_handler : public midi_handler {
                     std::cerr << "jack_midi_event_reserve error" << std::endl;
                 }
             }
+            fOutBuffer.read_advance(messages.size());
         }
 
     public:
 
         jack_midi_handler(const std::string& name = "JACKHandler")
-            :midi_handler(name)
-        {
-            fOutBuffer = ringbuffer_create(8192);
-        }
+            :midi_handler(name), fOutBuffer(512)
+        {}
         virtual ~jack_midi_handler()
-        {
-            ringbuffer_free(fOutBuffer);
-        }
+        {}
 
         // MIDI output API
         MapUI* keyOn(int channel, int pitch, int velocity)
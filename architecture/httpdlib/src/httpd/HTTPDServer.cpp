@@ -25,9 +25,14 @@
 #include <sstream>
 #include <fstream>
 #include <stdexcept>
+#include <algorithm>
 #include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
+#include <chrono>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 #include "HTTPDServer.h"
 #include "Message.h"
@@ -44,6 +49,7 @@ namespace httpdfaust
 {
 
 #define kPortsScanRange		1000		// scan this number of TCP ports to find a free one (in case of busy port)
+#define kKeepAlive			15000		// push channel keep alive period in milliseconds (detects closed connections)
 
 //--------------------------------------------------------------------------
 // static functions
@@ -56,6 +62,34 @@ static int _answer_to_connection (void *cls, struct MHD_Connection *connection,
 	return server->answer(connection, url, method, version, upload_data, upload_data_size, con_cls); 
 }
 
+//--------------------------------------------------------------------------
+// push channel state, one per connection
+struct PushChannel
+{
+	HTTPDServer*			fServer;
+	struct MHD_Connection*	fConnection;
+	std::vector<float>		fValues;		// the values sent to the client
+	std::string				fEvent;			// the event being sent
+	size_t					fPos;			// the current position in fEvent
+	int						fWaited;		// time since the last event, in milliseconds
+
+	PushChannel(HTTPDServer* server, struct MHD_Connection* connection)
+		: fServer(server), fConnection(connection), fPos(0), fWaited(0) {}
+};
+
+static ssize_t _push_reader (void *cls, uint64_t pos, char *buf, size_t max)
+{
+	PushChannel* channel = (PushChannel*)cls;
+	return channel->fServer->pushEvent(channel, buf, max);
+}
+
+static void _push_free (void *cls)
+{
+	PushChannel* channel = (PushChannel*)cls;
+	channel->fServer->pushClosed(channel);
+	delete channel;
+}
+
 // Convert string to float. Accepts both . and , as decimal point
 // Syntax is : [ ]*[+|-]n*(.|,)n*
 static float mystrtof(const char* str, const char** endptr)
@@ -105,18 +139,59 @@ static int _get_params (void *cls, enum MHD_ValueKind kind, const char *key, con
 //--------------------------------------------------------------------------
 // the http server
 //--------------------------------------------------------------------------
-HTTPDServer::HTTPDServer(MessageProcessor* mp)
-	: fProcessor(mp), fServer(0), fDebug(false)
+HTTPDServer::HTTPDServer(MessageProcessor* mp, int pushperiod)
+	: fProcessor(mp), fServer(0), fDebug(false), fPushPeriod(pushperiod), fStopping(false)
 {
 }
 
 HTTPDServer::~HTTPDServer() { stop(); }
 
 //--------------------------------------------------------------------------
+// the push channels waiting for changes are suspended, so that they don't block the
+// daemon thread, and resumed every fPushPeriod by the push thread
 bool HTTPDServer::start(int port)
 {
-	fServer = MHD_start_daemon (MHD_USE_SELECT_INTERNALLY, port, NULL, NULL, _answer_to_connection, this, MHD_OPTION_END);
-	return fServer != 0;
+	fStopping = false;
+	fServer = MHD_start_daemon (MHD_USE_SELECT_INTERNALLY | MHD_USE_SUSPEND_RESUME, port, NULL, NULL, _answer_to_connection, this, MHD_OPTION_END);
+	if (!fServer) return false;
+	fPushThread = std::thread (&HTTPDServer::pushLoop, this);
+	return true;
+}
+
+//--------------------------------------------------------------------------
+// the suspended connections have to be resumed before the daemon is stopped
+void HTTPDServer::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock (fPushMutex);
+		fStopping = true;			// the push channels end their stream
+		resume();
+	}
+	fPushCond.notify_all();
+	if (fPushThread.joinable()) fPushThread.join();
+	if (fServer) MHD_stop_daemon (fServer);
+	fServer = 0;
+}
+
+//--------------------------------------------------------------------------
+void HTTPDServer::pushLoop()
+{
+	std::unique_lock<std::mutex> lock (fPushMutex);
+	while (!fStopping) {
+		fPushCond.wait_for (lock, std::chrono::milliseconds(fPushPeriod));
+		resume();
+	}
+}
+
+//--------------------------------------------------------------------------
+// to be called with fPushMutex locked
+void HTTPDServer::resume()
+{
+	for (size_t i = 0; i < fSuspended.size(); i++) {
+		fSuspended[i]->fWaited += fPushPeriod;
+		MHD_resume_connection (fSuspended[i]->fConnection);
+	}
+	fSuspended.clear();
 }
 
 //--------------------------------------------------------------------------
@@ -134,6 +209,80 @@ int HTTPDServer::send (struct MHD_Connection *connection, const char *page, cons
 	return ret;
 }
 
+//--------------------------------------------------------------------------
+int HTTPDServer::send (struct MHD_Connection *connection, const RawAnswer& answer)
+{
+	const string& data = answer.data();
+	// persistent data are not copied
+	struct MHD_Response *response = MHD_create_response_from_buffer (data.size(), (void *) data.c_str(), 
+										answer.fData ? MHD_RESPMEM_PERSISTENT : MHD_RESPMEM_MUST_COPY);
+	if (!response) {
+		cerr << "MHD_create_response_from_buffer error: null response\n";
+		return MHD_NO;
+	}
+	MHD_add_response_header (response, "Content-Type", answer.fMIME.c_str());
+	MHD_add_response_header (response, "Access-Control-Allow-Origin", "*");
+	int ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
+	MHD_destroy_response (response);
+	return ret;
+}
+
+//--------------------------------------------------------------------------
+// the push channel is a server-sent events stream: the first event gives all the values,
+// then an event is sent each time values change (checked every fPushPeriod)
+int HTTPDServer::push (struct MHD_Connection *connection)
+{
+	PushChannel* channel = new PushChannel(this, connection);
+	struct MHD_Response *response = MHD_create_response_from_callback (MHD_SIZE_UNKNOWN, 1024, _push_reader, channel, _push_free);
+	if (!response) {
+		delete channel;
+		cerr << "MHD_create_response_from_callback error: null response\n";
+		return MHD_NO;
+	}
+	MHD_add_response_header (response, "Content-Type", "text/event-stream");
+	MHD_add_response_header (response, "Cache-Control", "no-cache");
+	MHD_add_response_header (response, "Access-Control-Allow-Origin", "*");
+	int ret = MHD_queue_response (connection, MHD_HTTP_OK, response);
+	MHD_destroy_response (response);
+	return ret;
+}
+
+//--------------------------------------------------------------------------
+// called by the daemon thread, never blocks: when there is nothing to send, the connection
+// is suspended until the next period
+ssize_t HTTPDServer::pushEvent (PushChannel* channel, char* buf, size_t max)
+{
+	if (channel->fPos >= channel->fEvent.size()) {
+		if (fStopping) return MHD_CONTENT_READER_END_OF_STREAM;
+		string changes;
+		fProcessor->changes(channel->fValues, changes);
+		if (changes.size())
+			channel->fEvent = "data: " + changes + "\n\n";
+		else if (channel->fWaited >= kKeepAlive)
+			channel->fEvent = ":\n\n";		// a comment line, ignored by the clients
+		else {
+			std::lock_guard<std::mutex> lock (fPushMutex);
+			if (fStopping) return MHD_CONTENT_READER_END_OF_STREAM;
+			fSuspended.push_back(channel);
+			MHD_suspend_connection (channel->fConnection);
+			return 0;
+		}
+		channel->fPos = 0;
+		channel->fWaited = 0;
+	}
+	size_t n = std::min(max, channel->fEvent.size() - channel->fPos);
+	memcpy(buf, channel->fEvent.c_str() + channel->fPos, n);
+	channel->fPos += n;
+	return n;
+}
+
+//--------------------------------------------------------------------------
+void HTTPDServer::pushClosed (PushChannel* channel)
+{
+	std::lock_guard<std::mutex> lock (fPushMutex);
+	fSuspended.erase (std::remove(fSuspended.begin(), fSuspended.end(), channel), fSuspended.end());
+}
+
 //--------------------------------------------------------------------------
 const char* HTTPDServer::getMIMEType (const string& page)
 {
@@ -228,6 +377,9 @@ int HTTPDServer::answer (struct MHD_Connection *connection, const char *url, con
 		msg.print(cout);
 		cout << endl;
 	}
+	RawAnswer raw;
+	if (fProcessor->rawAnswer (&msg, raw))
+		return raw.fPush ? push (connection) : send (connection, raw);
 	fProcessor->processMessage (&msg, outMsgs);
 	if (outMsgs.size())
 		send (connection, outMsgs);
@@ -28,6 +28,10 @@
 #include <string>
 #include <ostream>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -52,6 +56,8 @@ namespace httpdfaust
 
 class Message;
 class MessageProcessor;
+struct RawAnswer;
+struct PushChannel;
 
 //--------------------------------------------------------------------------
 /*!
@@ -62,21 +68,38 @@ class HTTPDServer
 	MessageProcessor*	fProcessor;
 	struct MHD_Daemon *	fServer;
 	bool				fDebug;
+	int					fPushPeriod;		// the push channel period, in milliseconds
+	std::atomic<bool>	fStopping;			// tells the push channels to terminate
+
+	std::vector<PushChannel*>	fSuspended;		// the push channels waiting for the next period
+	std::mutex					fPushMutex;		// protects fSuspended and the connections suspend/resume
+	std::condition_variable		fPushCond;
+	std::thread					fPushThread;	// resumes the suspended push channels every fPushPeriod
+
+	void pushLoop ();
+	void resume ();
 	
 	int send (struct MHD_Connection *connection, std::vector<Message*> msgs);
+	int send (struct MHD_Connection *connection, const RawAnswer& answer);
+	int push (struct MHD_Connection *connection);
 	int page (struct MHD_Connection *connection, const char *page);
 	const char* getMIMEType (const std::string& page);
 
 	public:
-				 HTTPDServer(MessageProcessor* mp);
+				 HTTPDServer(MessageProcessor* mp, int pushperiod = 100);
 		virtual ~HTTPDServer();
 
 		/// \brief starts the httpd server
 		bool start (int port);
-		void stop ()			{ if (fServer) MHD_stop_daemon (fServer); fServer=0; }
+		void stop ();
 		int answer (struct MHD_Connection *connection, const char *url, const char *method, const char *version, 
 					const char *upload_data, size_t *upload_data_size, void **con_cls);
 
+		/// \brief fills the push channel buffer with the next event, suspends the connection when none
+		ssize_t	pushEvent (PushChannel* channel, char* buf, size_t max);
+		/// \brief called when a push channel connection is closed
+		void	pushClosed (PushChannel* channel);
+
 		static int send (struct MHD_Connection *connection, const char *page, const char *type, int status=MHD_HTTP_OK);
 };
 
@@ -41,11 +41,11 @@ bool HTTPDSetup::running() const	{ return fServer ? true : false; }
 //bool HTTPDSetup::running() const	{ return fServer ? fServer->isRunning() : false; }
 
 //--------------------------------------------------------------------------
-bool HTTPDSetup::start(MessageProcessor* mp, int& tcpport )
+bool HTTPDSetup::start(MessageProcessor* mp, int& tcpport, int pushperiod )
 {
 	int port = tcpport;
 	bool done = false;
-	fServer = new HTTPDServer (mp);
+	fServer = new HTTPDServer (mp, pushperiod);
 	do {
 		done = fServer->start(port);
 		if (!done) {
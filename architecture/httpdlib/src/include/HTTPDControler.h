@@ -48,6 +48,7 @@ class htmlfactory;
 class HTTPDControler
 {
 	int fTCPPort;				// the tcp port number
+	int fPushPeriod;			// the push channel period, in milliseconds
 	FaustFactory*	fFactory;	// a factory to build the memory representation
 	jsonfactory*	fJson;
 	htmlfactory*	fHtml;
@@ -24,12 +24,29 @@
 #ifndef __MessageProcessor__
 #define __MessageProcessor__
 
+#include <string>
 #include <vector>
 
 namespace httpdfaust
 {
 
 class Message;
+
+//--------------------------------------------------------------------------
+/*!
+	\brief a direct answer to a request, bypassing the messages based processing
+*/
+struct RawAnswer
+{
+	const std::string*	fData;		///< persistent data (e.g. a cached description), or null
+	std::string			fBuffer;	///< data generated for the request, used when fData is null
+	std::string			fMIME;		///< the answer MIME type
+	bool				fPush;		///< true when the request opens a push channel (see MessageProcessor::changes)
+
+	RawAnswer() : fData(0), fPush(false) {}
+	const std::string& data() const		{ return fData ? *fData : fBuffer; }
+};
+
 //--------------------------------------------------------------------------
 /*!
 	\brief an abstract class for objects able to process OSC messages	
@@ -39,6 +56,19 @@ class MessageProcessor
 	public:
 		virtual		~MessageProcessor() {}
 		virtual bool processMessage( const Message* msg, std::vector<Message*>& outMsg ) = 0;
+
+		/*!
+			\brief gives a direct answer to a request, without messages allocation and formatting
+			\return false when the request has to be processed using processMessage
+		*/
+		virtual bool rawAnswer( const Message* msg, RawAnswer& answer ) { return false; }
+
+		/*!
+			\brief collects the parameters values changed since a previous call, for the push channel
+			\param values the values sent on the previous call, updated with the current ones (empty on first call)
+			\param event on output, the changed values description (empty when no value has changed)
+		*/
+		virtual void changes( std::vector<float>& values, std::string& event ) { event.clear(); }
 };
 
 } // end namespoace
@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 
+#include "faust/gui/GUI.h"
 #include "MessageDriven.h"
 #include "Message.h"
 
@@ -50,16 +51,27 @@ template <typename C> struct mapping
 	C scale (C x) { C z = (x < fMinIn) ? fMinIn : (x > fMaxIn) ? fMaxIn : x; return fMinOut + (z - fMinIn) * fScale; }
 };
 
+//--------------------------------------------------------------------------
+/*!
+	\brief a parameter value, as read by the bulk values and push handlers
+*/
+class FaustValue
+{
+	public:
+		virtual ~FaustValue() {}
+		virtual double value() const = 0;
+};
+
 //--------------------------------------------------------------------------
 /*!
 	\brief a faust node is a terminal node and represents a faust parameter controler
 */
-template <typename C> class FaustNode : public MessageDriven
+template <typename C> class FaustNode : public MessageDriven, public FaustValue
 {
 	C *	fZone;			// the parameter memory zone
 	mapping<C>	fMapping;
 	
-	bool store(C val)			{ *fZone = fMapping.scale(val); return true; }
+	bool store(C val)			{ *fZone = fMapping.scale(val); GUI::markAllGuis((FAUSTFLOAT*)fZone); return true; }
 
 	protected:
 		FaustNode(const char *name, C* zone, C min, C max, const char* prefix, bool initZone) 
@@ -111,6 +123,8 @@ template <typename C> class FaustNode : public MessageDriven
             return MessageDriven::accept(msg, outMsg);
         }
 
+		virtual double value() const { return double(*fZone); }
+
 		virtual void get(std::vector<Message*>& outMsg) const						///< handler for the 'get' message
         {
             Message * msg = new Message(getAddress());
@@ -22,16 +22,27 @@
 */
 
 #include <string>
+#include <sstream>
+#include <iomanip>
+#include <limits>
 
 #include "RootNode.h"
+#include "FaustNode.h"
 #include "Message.h"
 
+#ifndef FAUSTFLOAT
+#define FAUSTFLOAT float
+#endif
+
 using namespace std;
 
 namespace httpdfaust
 {
 
-static const char* kJSONAddr = "/JSON";
+static const char* kJSONAddr		= "/JSON";
+static const char* kValuesAddr		= "/values";		// all the values, as a JSON array or as binary floats
+static const char* kAddressesAddr	= "/addresses";		// the addresses of the values, as a JSON array
+static const char* kEventsAddr		= "/events";		// the push channel (server-sent events)
 
 
 //--------------------------------------------------------------------------
@@ -50,6 +61,105 @@ bool RootNode::processMessage(const Message* msg, vector<Message*>& outMsg)
 	return MessageDriven::processMessage(msg, outMsg);
 }
 
+//--------------------------------------------------------------------------
+void RootNode::collect(MessageDriven* node, vector<string>& addresses)
+{
+	const FaustValue* value = dynamic_cast<const FaustValue*>(node);
+	if (value) {
+		fValues.push_back(value);
+		addresses.push_back(node->getAddress());
+	}
+	for (int i = 0; i < node->size(); i++)
+		collect(node->subnode(i), addresses);
+}
+
+//--------------------------------------------------------------------------
+void RootNode::buildValuesTable()
+{
+	vector<string> addresses;
+	fValues.clear();
+	collect(this, addresses);
+	stringstream s;
+	s << "[";
+	fValuesKeys.clear();
+	for (size_t i = 0; i < addresses.size(); i++) {
+		string key = "\"" + addresses[i] + "\"";
+		s << (i ? "," : "") << key;
+		fValuesKeys.push_back(key + ":");
+	}
+	s << "]";
+	fAddresses = s.str();
+}
+
+//--------------------------------------------------------------------------
+// cached descriptions and bulk values are answered without any message allocation
+bool RootNode::rawAnswer(const Message* msg, RawAnswer& answer)
+{
+	const string& addr = msg->address();
+	if (msg->size() == 0) {
+		if (addr == kJSONAddr) {
+			answer.fData = &fJson;
+			answer.fMIME = "application/json";
+			return true;
+		}
+		if (addr == "/") {
+			answer.fData = &fHtml;
+			answer.fMIME = "text/html";
+			return true;
+		}
+		if (addr == kAddressesAddr) {
+			answer.fData = &fAddresses;
+			answer.fMIME = "application/json";
+			return true;
+		}
+		if (addr == kEventsAddr) {
+			answer.fPush = true;
+			answer.fMIME = "text/event-stream";
+			return true;
+		}
+	}
+	if (addr == kValuesAddr) {
+		string key, format;
+		if ((msg->size() == 2) && msg->param(0, key) && (key == "format") && msg->param(1, format) && (format == "binary")) {
+			// native float values, in the /addresses order
+			answer.fBuffer.resize(fValues.size() * sizeof(float));
+			float* out = (float*)&answer.fBuffer[0];
+			for (size_t i = 0; i < fValues.size(); i++) out[i] = float(fValues[i]->value());
+			answer.fMIME = "application/octet-stream";
+		}
+		else {
+			// the values are read back without loss by the clients
+			stringstream s;
+			s << setprecision(numeric_limits<FAUSTFLOAT>::max_digits10) << "[";
+			for (size_t i = 0; i < fValues.size(); i++) s << (i ? "," : "") << fValues[i]->value();
+			s << "]";
+			answer.fBuffer = s.str();
+			answer.fMIME = "application/json";
+		}
+		return true;
+	}
+	return false;
+}
+
+//--------------------------------------------------------------------------
+// the push channel events are JSON objects, associating the changed values to their address
+void RootNode::changes(vector<float>& values, string& event)
+{
+	bool all = values.size() != fValues.size();
+	if (all) values.resize(fValues.size());
+	stringstream s;
+	s << setprecision(numeric_limits<FAUSTFLOAT>::max_digits10);
+	for (size_t i = 0; i < fValues.size(); i++) {
+		double v = fValues[i]->value();
+		if (all || (float(v) != values[i])) {
+			s << ((s.tellp() > 0) ? "," : "{") << fValuesKeys[i] << v;
+			values[i] = float(v);
+		}
+	}
+	if (s.tellp() > 0) s << "}";
+	event = s.str();
+}
+
 //--------------------------------------------------------------------------
 bool RootNode::accept(const Message* msg, vector<Message*>& outMsg)
 {
@@ -26,11 +26,13 @@
 #define __RootNode__
 
 #include <string>
+#include <vector>
 #include "MessageDriven.h"
 
 namespace httpdfaust
 {
 
+class FaustValue;
 class RootNode;
 typedef class SMARTP<RootNode>	SRootNode;
 
@@ -42,6 +44,11 @@ class RootNode : public MessageDriven
 {
 	std::string fJson;
 	std::string fHtml;
+	std::string fAddresses;						///< the parameters addresses, as a JSON array
+	std::vector<const FaustValue*> fValues;		///< the parameters, in fAddresses order
+	std::vector<std::string> fValuesKeys;		///< the parameters addresses, as JSON keys
+
+	void	collect(MessageDriven* node, std::vector<std::string>& addresses);
 	
 	protected:
 				 RootNode(const char *name) : MessageDriven (name, "") {}
@@ -52,9 +59,12 @@ class RootNode : public MessageDriven
 
 		void			setJSON(const std::string& json)	{ fJson = json; }
 		void			setHtml(const std::string& html)	{ fHtml = html; }
+		void			buildValuesTable();		///< to be called once the tree is complete
 		//--------------------------------------------------------------------------
 		bool			processMessage(const Message* msg, std::vector<Message*>& outMsg);
 		virtual bool	accept(const Message* msg, std::vector<Message*>& outMsg);
+		virtual bool	rawAnswer(const Message* msg, RawAnswer& answer);
+		virtual void	changes(std::vector<float>& values, std::string& event);
 };
 
 } // end namespoace
@@ -2528,6 +2528,7 @@ public:
     
     virtual void addHorizontalBargraph(const char* label, float* zone, float min, float max)
     {
+        registerPassiveZone(zone);
         if (!fBuildUI) {
             return;
         }
@@ -2565,6 +2566,7 @@ public:
     
     virtual void addVerticalBargraph(const char* label, float* zone, float min, float max)
     {
+        registerPassiveZone(zone);
         if (!fBuildUI) {
             return;
         }
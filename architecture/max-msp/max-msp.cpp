@@ -212,7 +212,7 @@ public:
     mspUIObject(const string& label, FAUSTFLOAT* zone):fLabel(label),fZone(zone) {}
     virtual ~mspUIObject() {}
     
-    virtual void setValue(FAUSTFLOAT f) { *fZone = range(0.0, 1.0, f); }
+    virtual void setValue(FAUSTFLOAT f) { *fZone = range(0.0, 1.0, f); GUI::markAllGuis(fZone); }
     virtual FAUSTFLOAT getValue() { return *fZone; }
     virtual void toString(char* buffer) {}
     virtual string getName() { return fLabel; }
@@ -271,7 +271,7 @@ class mspSlider : public mspUIObject {
             snprintf(buffer, STR_SIZE, "%s", res.c_str());
         }
         
-        void setValue(FAUSTFLOAT f) { *fZone = range(fMin, fMax, f); }
+        void setValue(FAUSTFLOAT f) { *fZone = range(fMin, fMax, f); GUI::markAllGuis(fZone); }
 };
 
 /*--------------------------------------------------------------------------*/
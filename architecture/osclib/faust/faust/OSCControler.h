@@ -58,6 +58,9 @@ class OSCControler
 	FaustFactory*	fFactory;			// a factory to build the memory representation
 
     bool            fInit;
+    double          fBundlePeriod;      // the minimum time between two bundles (in seconds)
+    double          fLastBundle;        // the time of the last bundle (in seconds)
+    bool            fBlockSync;         // true when the incoming bundles values are stored by endBundle
     
 	public:
 		/*
@@ -89,7 +92,8 @@ class OSCControler
 	   
 		//--------------------------------------------------------------------------
 		void run();				// starts the network services
-		void endBundle();		// when bundle mode is on, close and send the current bundle (if any)
+		void endBundle();		// to be called at audio block boundaries: stores the received bundles values (-blocksync mode)
+		void sendBundle();		// to be called by the UI refresh thread: when bundle mode is on, close and send the current bundle (if any)
 		void stop();			// stop the network services
 		std::string getInfos() const; // gives information about the current environment (version, port numbers,...)
 
@@ -51,7 +51,7 @@ template <typename C> struct mapping
 /*!
 	\brief a faust node is a terminal node and represents a faust parameter controler
 */
-template <typename C> class FaustNode : public MessageDriven, public uiTypedItem<C>
+template <typename C> class FaustNode : public MessageDriven, public uiTypedItem<C>, public OSCEmitter
 {
 	mapping<C>	fMapping;
     RootNode* fRoot;
@@ -63,8 +63,17 @@ template <typename C> class FaustNode : public MessageDriven, public uiTypedItem
 	// only known at execution time. When the library is compiled, fZone is
 	// uniquely defined by FAUSTFLOAT.
 	//---------------------------------------------------------------------
-	bool	store(C val) { *(C *)this->fZone = fMapping.clip(val); return true; }
-	void	sendOSC() const;
+	bool	store(C val)
+	{
+		C v = fMapping.clip(val);
+		// Captured (timestamped) values are marked when applied by timed_dsp
+		if (!fRoot->capture((C *)this->fZone, v)) {
+			*(C *)this->fZone = v;
+			GUI::markAllGuis((FAUSTFLOAT*)this->fZone);
+		}
+		return true;
+	}
+	void	sendOSC() const;	// emits the value now, or defers it to the next bundle in bundle mode
 
 	protected:
 		FaustNode(RootNode* root, const char *name, C* zone, C init, C min, C max, const char* prefix, GUI* ui, bool initZone, bool input) 
@@ -92,6 +101,7 @@ template <typename C> class FaustNode : public MessageDriven, public uiTypedItem
     
 		bool accept(const Message* msg);
 		void get(unsigned long ipdest) const;		///< handler for the 'get' message
+		void emit() const;							///< emits the current value (and its aliases)
 		virtual void reflectZone() { sendOSC(); this->fCache = *this->fZone; }
 };
 
@@ -26,6 +26,8 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <atomic>
 
 #include "faust/osc/MessageProcessor.h"
 #include "faust/osc/smartpointer.h"
@@ -49,15 +51,27 @@ typedef class SMARTP<MessageDriven>	SMessageDriven;
 	The principle of the dispatch is the following:
 	- first the processMessage() method should be called on the top level node
 	- next processMessage call propose 
+	
+	Addresses without OSC wildcards are directly dispatched using a table of the full
+	addresses of the tree nodes, built by the top level node on the first message following
+	a change in the tree. Only addresses with wildcards go through propose.
 */
 class MessageDriven : public MessageProcessor, public smartable
 {
+	typedef std::unordered_map<std::string, std::vector<MessageDriven*> > TAddressTable;
+
 	std::string						fName;			///< the node name
 	std::string						fOSCPrefix;		///< the node OSC address prefix (OSCAddress = fOSCPrefix + '/' + fName)
 	std::vector<SMessageDriven>		fSubNodes;		///< the subnodes of the current node
+	TAddressTable					fAddressTable;	///< the full address => nodes table (on the top level node)
+	int								fTableVersion;	///< the tree version of the address table
+
+	static std::atomic<int>			fTreeVersion;	///< incremented at each tree change
+
+	void			buildAddressTable(MessageDriven* node, const std::string& address);
 
 	protected:
-				 MessageDriven(const char *name, const char *oscprefix) : fName (name), fOSCPrefix(oscprefix) {}
+				 MessageDriven(const char *name, const char *oscprefix) : fName (name), fOSCPrefix(oscprefix), fTableVersion(-1) {}
 		virtual ~MessageDriven() {}
 
 	public:
@@ -117,7 +131,7 @@ class MessageDriven : public MessageProcessor, public smartable
 		*/
 		virtual void	get (unsigned long ipdest, const std::string & what) const {}
 
-		void			add(SMessageDriven node)	{ fSubNodes.push_back (node); }
+		void			add(SMessageDriven node)	{ fSubNodes.push_back (node); fTreeVersion++; }
 		const char*		getName() const				{ return fName.c_str(); }
 		std::string		getOSCAddress() const;
 		int				size() const				{ return (int)fSubNodes.size (); }
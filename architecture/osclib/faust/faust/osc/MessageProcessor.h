@@ -24,10 +24,26 @@
 #ifndef __MessageProcessor__
 #define __MessageProcessor__
 
+#include <vector>
+
 namespace oscfaust
 {
 
 class Message;
+
+//--------------------------------------------------------------------------
+/*!
+	\brief a zone and the value to be stored in it
+*/
+struct ZoneValue
+{
+	void*	fZone;
+	double	fValue;
+	bool	fDouble;		///< the zone type (double or float)
+
+	void store() const	{ if (fDouble) *static_cast<double*>(fZone) = fValue; else *static_cast<float*>(fZone) = float(fValue); }
+};
+
 //--------------------------------------------------------------------------
 /*!
 	\brief an abstract class for objects able to process OSC messages	
@@ -37,6 +53,8 @@ class MessageProcessor
 	public:
 		virtual		~MessageProcessor() {}
 		virtual void processMessage( const Message* msg ) = 0;
+		/// when 'values' is not null, the values of the processed messages are added to 'values' instead of being stored in their zones
+		virtual void captureValues( std::vector<ZoneValue>* values ) {}
 };
 
 } // end namespoace
@@ -25,6 +25,7 @@
 #define __RootNode__
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -94,6 +95,25 @@ struct aliastarget
     }
 };
 
+//--------------------------------------------------------------------------
+/*!
+	\brief an object emitting its value on the OSC output
+
+	In bundle mode, emissions are deferred to the next bundle: an emitter is queued
+	once whatever the number of its updates, and emits its value at the time the bundle is built.
+*/
+class OSCEmitter
+{
+	friend class RootNode;
+	mutable bool fDeferred;		// true when queued for the next bundle
+
+	public:
+				 OSCEmitter() : fDeferred(false) {}
+		virtual ~OSCEmitter() {}
+
+		virtual void emit() const = 0;
+};
+
 //--------------------------------------------------------------------------
 /*!
 	\brief a faust root node
@@ -110,19 +130,25 @@ class RootNode : public MessageDriven
 	typedef std::map<std::string, std::vector<aliastarget> > TAliasMap;
 	TAliasMap fAliases;
 
+	std::mutex					fDeferredMutex;
+	std::vector<const OSCEmitter*>	fDeferred;		// emitters waiting for the next bundle
+
+	std::vector<ZoneValue>*		fCapture;		// when set, receives the values instead of the zones (listener thread only)
+
 	void processAlias(const std::string& address, float val);
 	void eraseAliases(const std::string& target);
 	void eraseAlias(const std::string& target, const std::string& alias);
 	bool aliasError(const Message* msg);
 
 	protected:
-				 RootNode(const char *name, JSONUI* json, OSCIO* io = NULL) : MessageDriven(name, ""), fUPDIn(0), fUDPOut(0), fUDPErr(0), fJSON(json), fIO(io) {}
+				 RootNode(const char *name, JSONUI* json, OSCIO* io = NULL) : MessageDriven(name, ""), fUPDIn(0), fUDPOut(0), fUDPErr(0), fJSON(json), fIO(io), fCapture(0) {}
 		virtual ~RootNode() {}
 
 	public:
 		static SRootNode create(const char* name, JSONUI* json, OSCIO* io = NULL) { return new RootNode(name, json, io); }
 
 		virtual void processMessage(const Message* msg);
+		virtual void captureValues(std::vector<ZoneValue>* values)	{ fCapture = values; }
 		virtual bool accept(const Message* msg);
 		virtual void get(unsigned long ipdest) const;
 		virtual void get(unsigned long ipdest, const std::string& what) const;
@@ -134,6 +160,18 @@ class RootNode : public MessageDriven
         void setPorts(int* in, int* out, int* err);
         
         std::vector<std::pair<std::string, double> > getAliases(const std::string& address, double value);
+
+        /// adds the value to the captured values, returns false when the values are not captured
+        template <typename C> bool capture(C* zone, C value)
+        {
+            if (!fCapture) return false;
+            ZoneValue zv = { zone, double(value), sizeof(C) == sizeof(double) };
+            fCapture->push_back(zv);
+            return true;
+        }
+
+        void defer(const OSCEmitter* emitter);                 ///< queues an emitter for the next bundle
+        void emitDeferred();                                ///< emits the queued emitters values in the current bundle
 };
 
 } // end namespoace
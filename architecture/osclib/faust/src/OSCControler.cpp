@@ -24,6 +24,7 @@
 */
 
 #include <stdlib.h>
+#include <chrono>
 #include <iostream>
 #include <sstream>
 
@@ -45,14 +46,16 @@ using namespace std;
 namespace oscfaust
 {
 
-#define kVersion     1.21f
-#define kVersionStr "1.21"
+#define kVersion     1.22f
+#define kVersionStr "1.22"
 
 static const char* kUDPPortOpt	= "-port";
 static const char* kUDPOutOpt	= "-outport";
 static const char* kUDPErrOpt	= "-errport";
 static const char* kUDPDestOpt	= "-desthost";
 static const char* kBundleOpt	= "-bundle";
+static const char* kBundleRateOpt = "-bundlerate";
+static const char* kBlockSyncOpt = "-blocksync";
 static const char* kXmitOpt		= "-xmit";
 static const char* kXmitFilterOpt = "-xmitfilter";
 static const char* kReuseOpt 	= "-reuse";
@@ -79,6 +82,8 @@ static void osc_usage()
 	cout << "\t" << kUDPDestOpt  	<< " [ip|hostname] (default: localhost)" << endl;
 	cout << "\t" << kReuseOpt  		<< " [0|1] \t\t(default: 0)" << endl;
 	cout << "\t" << kBundleOpt  	<< " [0|1] \t\t(default: 0)" << endl;
+	cout << "\t" << kBundleRateOpt	<< " num \t\t(max bundles per second, default: 0 = no limit)" << endl;
+	cout << "\t" << kBlockSyncOpt	<< " [0|1] \t\t(store the incoming bundles values at audio block boundaries, default: 0)" << endl;
 	cout << "\t" << kXmitOpt  		<< " [0|1|2] \t\t(default: 0)" << endl;
 	cout << "\t" << kXmitFilterOpt  << " <filtered paths list>" << endl;
 }
@@ -142,7 +147,7 @@ static void treatXmitFilterOption(int argc, char *argv[], const std::string& opt
 
 //--------------------------------------------------------------------------
 OSCControler::OSCControler(int argc, char* argv[], GUI* ui, JSONUI* json, OSCIO* io, ErrorCallback errCallback, void* arg, bool init)
-	: fUDPPort(kUDPBasePort), fUDPOut(kUDPBasePort+1), fUPDErr(kUDPBasePort+2), fIO(io), fInit(init)
+	: fUDPPort(kUDPBasePort), fUDPOut(kUDPBasePort+1), fUPDErr(kUDPBasePort+2), fIO(io), fInit(init), fBundlePeriod(0.), fLastBundle(0.), fBlockSync(false)
 {
 	checkHelp(argc, argv, kHelp);
 	fUDPPort = getPortOption(argc, argv, kUDPPortOpt, fUDPPort);
@@ -151,6 +156,9 @@ OSCControler::OSCControler(int argc, char* argv[], GUI* ui, JSONUI* json, OSCIO*
 	fDestAddress = getDestOption (argc, argv, kUDPDestOpt, "localhost");
 	gXmit   = getIntOption(argc, argv, kXmitOpt, kNoXmit);
 	gBundle = getIntOption(argc, argv, kBundleOpt, 0);
+	int rate = getIntOption(argc, argv, kBundleRateOpt, 0);
+	if (rate > 0) fBundlePeriod = 1. / rate;
+	fBlockSync = getIntOption(argc, argv, kBlockSyncOpt, 0);
 
 	if (getIntOption(argc, argv, kReuseOpt, 0)) {
 		fBindAddress = kMulticastAddress;
@@ -193,6 +201,7 @@ string OSCControler::getInfos() const
     sstr << "Faust OSC version " << versionstr() << " - " << quote(rootnode->getName()) << " is running on UDP ports "
     << fUDPPort << ", " << fUDPOut << ", " << fUPDErr << ", sending on " << fDestAddress;
     if (gXmit > 0) sstr << ", with xmit mode = " << gXmit;
+    if (fBlockSync) sstr << ", with block sync";
     if (gBundle) sstr << ", with bundle mode ON.";
     if (!fBindAddress.empty())
         sstr << " Listening is bound to " << fBindAddress << ".";
@@ -212,6 +221,7 @@ void OSCControler::run()
 		
         // starts the network services
 		fOsc->start (rootnode, fUDPPort, fUDPOut, fUPDErr, gBundle, getDestAddress(), fBindAddress.empty() ? 0 : fBindAddress.c_str() );
+		fOsc->blockSync(fBlockSync);
 
 		string infos = getInfos();
 		// and outputs a message on the osc output port
@@ -224,7 +234,27 @@ void OSCControler::run()
 }
 
 //--------------------------------------------------------------------------
-void OSCControler::endBundle() { if (gBundle && fOsc) fOsc->endBundle(); }
+// In block sync mode, the values of the received bundles are stored before the next audio block.
+void OSCControler::endBundle()
+{
+	if (fOsc && fBlockSync) fOsc->applyBundles();
+}
+
+//--------------------------------------------------------------------------
+// In bundle mode, all the updates of a parameter since the previous bundle are coalesced into a single message,
+// and the bundle is sent at most every fBundlePeriod: the values are emitted when the bundle is built.
+void OSCControler::sendBundle()
+{
+	if (!fOsc) return;
+	if (gBundle) {
+		double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		if (now - fLastBundle < fBundlePeriod) return;
+		fLastBundle = now;
+		SRootNode rootnode = fFactory->root();
+		if (rootnode) rootnode->emitDeferred();
+		fOsc->endBundle();
+	}
+}
 
 //--------------------------------------------------------------------------
 const char*	OSCControler::getRootName() const { return fFactory->root()->getName(); }
@@ -34,7 +34,7 @@ namespace oscfaust
 static const char* kAliasMsg      		= "alias";
 
 //--------------------------------------------------------------------------
-template<> void FaustNode<float>::sendOSC() const 
+template<> void FaustNode<float>::emit() const
 {
     if (OSCControler::gXmit != kNoXmit && !OSCControler::isPathFiltered(getOSCAddress())) {
         try {
@@ -60,7 +60,18 @@ template<> void FaustNode<float>::sendOSC() const
 }
 
 //--------------------------------------------------------------------------
-template<> void FaustNode<double>::sendOSC() const 
+template<> void FaustNode<float>::sendOSC() const
+{
+    if (OSCControler::gXmit == kNoXmit) return;
+    if (oscout.bundleMode()) {
+        fRoot->defer(this);     // coalesced with the other updates until the bundle is built
+    } else {
+        emit();
+    }
+}
+
+//--------------------------------------------------------------------------
+template<> void FaustNode<double>::emit() const
 {
     if (OSCControler::gXmit != kNoXmit && !OSCControler::isPathFiltered(getOSCAddress())) {
         try {
@@ -85,6 +96,17 @@ template<> void FaustNode<double>::sendOSC() const
     }
 }
 
+//--------------------------------------------------------------------------
+template<> void FaustNode<double>::sendOSC() const
+{
+    if (OSCControler::gXmit == kNoXmit) return;
+    if (oscout.bundleMode()) {
+        fRoot->defer(this);     // coalesced with the other updates until the bundle is built
+    } else {
+        emit();
+    }
+}
+
 //--------------------------------------------------------------------------
 template<> void FaustNode<float>::get(unsigned long ipdest) const		///< handler for the 'get' message
 {
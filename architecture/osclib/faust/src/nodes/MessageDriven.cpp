@@ -35,16 +35,46 @@ namespace oscfaust
 {
 
 static const char * kGetMsg = "get";
+static const char * kOSCWildcards = "*?[]{}";
+
+std::atomic<int> MessageDriven::fTreeVersion(0);
 
 //--------------------------------------------------------------------------
-void MessageDriven::processMessage(const Message* msg)
+// collects the full addresses of a node and of its subnodes
+void MessageDriven::buildAddressTable(MessageDriven* node, const string& address)
 {
-	const string addr = msg->address();
+	string node_address = address + "/" + node->name();
+	fAddressTable[node_address].push_back(node);
+	for (vector<SMessageDriven>::iterator i = node->fSubNodes.begin(); i != node->fSubNodes.end(); i++) {
+		buildAddressTable(*i, node_address);
+	}
+}
 
-	// create a regular expression
-	OSCRegexp r(OSCAddress::addressFirst(addr).c_str());
-	// and call propose with this regexp and with the dest osc address tail
-	propose(msg, &r, OSCAddress::addressTail(addr));
+//--------------------------------------------------------------------------
+void MessageDriven::processMessage(const Message* msg)
+{
+	const string& addr = msg->address();
+
+	if (addr.find_first_of(kOSCWildcards) == string::npos) {
+		// no wildcard: the address exactly designates the destination nodes
+		int version = fTreeVersion.load(std::memory_order_acquire);
+		if (fTableVersion != version) {
+			fAddressTable.clear();
+			buildAddressTable(this, "");
+			fTableVersion = version;
+		}
+		TAddressTable::const_iterator nodes = fAddressTable.find(addr);
+		if (nodes != fAddressTable.end()) {
+			for (vector<MessageDriven*>::const_iterator i = nodes->second.begin(); i != nodes->second.end(); i++) {
+				(*i)->accept(msg);
+			}
+		}
+	} else {
+		// create a regular expression
+		OSCRegexp r(OSCAddress::addressFirst(addr).c_str());
+		// and call propose with this regexp and with the dest osc address tail
+		propose(msg, &r, OSCAddress::addressTail(addr));
+	}
 }
 
 //--------------------------------------------------------------------------
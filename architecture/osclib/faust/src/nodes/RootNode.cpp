@@ -138,7 +138,7 @@ void RootNode::get(unsigned long ipdest) const		///< handler for the 'get' messa
 
 	std::map<std::string, std::vector<aliastarget> >::const_iterator i = fAliases.begin();
 	while (i != fAliases.end()) {
-		vector<aliastarget> targets = i->second;
+		const vector<aliastarget>& targets = i->second;
 		for (size_t n = 0; n < targets.size(); n++) {
 			// send a alias message for each target
 			const aliastarget& t = targets[n];
@@ -156,7 +156,9 @@ void RootNode::get(unsigned long ipdest) const		///< handler for the 'get' messa
 //--------------------------------------------------------------------------
 void RootNode::processAlias(const string& address, float val)
 {
- 	vector<aliastarget> targets = fAliases[address];	// retrieve the address aliases
+	map<string, vector<aliastarget> >::const_iterator it = fAliases.find(address);
+	if (it == fAliases.end()) return;					// not an alias
+ 	const vector<aliastarget>& targets = it->second;	// retrieve the address aliases
 	size_t n = targets.size();							// that could point to an arbitraty number of targets
 	for (size_t i = 0; i < n; i++) {					// for each target
 		Message m(targets[i].fTarget, address);			// create a new message with the target address and the alias
@@ -170,7 +172,7 @@ std::vector<std::pair<std::string, double> > RootNode::getAliases(const std::str
     std::map<std::string, std::vector<aliastarget> >::iterator it;
     std::vector<std::pair<std::string, double> > res;
     for (it = fAliases.begin(); it != fAliases.end(); it++) {
-        vector<aliastarget> targets = (*it).second;
+        const vector<aliastarget>& targets = (*it).second;
         for (size_t i = 0; i < targets.size(); i++) {
             if (targets[i].fTarget == address) {
                 res.push_back(std::make_pair((*it).first, targets[i].invscale( float(value) )));
@@ -180,6 +182,34 @@ std::vector<std::pair<std::string, double> > RootNode::getAliases(const std::str
     return res;
 }
 
+//--------------------------------------------------------------------------
+// deferred emission (bundle mode)
+//--------------------------------------------------------------------------
+void RootNode::defer(const OSCEmitter* emitter)
+{
+	std::lock_guard<std::mutex> lock(fDeferredMutex);
+	if (!emitter->fDeferred) {			// an emitter is queued once, whatever the number of its updates
+		emitter->fDeferred = true;
+		fDeferred.push_back(emitter);
+	}
+}
+
+// bundles are split to remain readable by oscpack based listeners, that read at most 4098 bytes per packet
+#define kBundleSplitSize	3072
+
+void RootNode::emitDeferred()
+{
+	// called by the UI refresh thread, or by the listener thread when the bundle mode changes
+	std::lock_guard<std::mutex> lock(fDeferredMutex);
+	for (size_t i = 0; i < fDeferred.size(); i++) {
+		if (oscout.state() && (oscout.stream().Size() > kBundleSplitSize))
+			oscout.endBundle();			// the bundle is full: send it and start a new one
+		fDeferred[i]->fDeferred = false;
+		fDeferred[i]->emit();
+	}
+	fDeferred.clear();
+}
+
 //--------------------------------------------------------------------------
 // specific processMessage at RootNode: intended to handle aliases
 //--------------------------------------------------------------------------
@@ -329,6 +359,8 @@ bool RootNode::accept(const Message* msg)
 			*fUDPErr = num;
 			oscerr.setPort(num);
 		} else if ((val == kBundleMsg) && (msg->param(1, num))) {
+			emitDeferred();					// flush the deferred values before changing mode
+			oscout.endBundle();
 			OSCControler::gBundle = num;
 			oscout.setBundle(num);
 		} else if ((val == kXmitMsg) && (msg->param(1, num))) {
@@ -344,6 +376,7 @@ bool RootNode::accept(const Message* msg)
             OSCControler::resetFilteredPaths();
         }
         if (val == kBundleMsg) {
+            emitDeferred();
             oscout.endBundle();
 		}
     } else if (fIO) {						// when still not handled and if a IO controler is set
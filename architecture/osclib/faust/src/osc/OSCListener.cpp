@@ -42,7 +42,7 @@ namespace oscfaust
 //--------------------------------------------------------------------------
 OSCListener::OSCListener(MessageProcessor* mp, int port, const char* bindAddress)
 		: fSocket(0), fMsgHandler(mp), 
-		  fRunning(false), fSetDest(true), fPort(port)
+		  fRunning(false), fSetDest(true), fPort(port), fBlockSync(false)
 {
 	if (bindAddress)
 		fSocket = new UdpListeningReceiveSocket( IpEndpointName(bindAddress, fPort), this);
@@ -76,9 +76,8 @@ void OSCListener::run()
 }
 
 //--------------------------------------------------------------------------
-void OSCListener::ProcessMessage(const osc::ReceivedMessage& m, const IpEndpointName& src)
+void OSCListener::decode(const osc::ReceivedMessage& m, const IpEndpointName& src, Message& msg)
 {
- 	Message msg = Message(m.AddressPattern());
 	msg.setSrcIP(src.address);
 	if (fSetDest && (src.address != kLocalhost)) {
 		oscout.setAddress(src.address);
@@ -97,7 +96,78 @@ void OSCListener::ProcessMessage(const osc::ReceivedMessage& m, const IpEndpoint
 		}
 		i++;
 	}
-	fMsgHandler->processMessage(&msg);
+}
+
+//--------------------------------------------------------------------------
+void OSCListener::process(const osc::ReceivedBundle& b, const IpEndpointName& src)
+{
+	for (ReceivedBundle::const_iterator i = b.ElementsBegin(); i != b.ElementsEnd(); ++i) {
+		if (i->IsBundle()) {
+			process(ReceivedBundle(*i), src);
+		} else {
+			ReceivedMessage m(*i);
+			Message msg = Message(m.AddressPattern());
+			decode(m, src, msg);
+			fMsgHandler->processMessage(&msg);
+		}
+	}
+}
+
+//--------------------------------------------------------------------------
+// queues the decoded values for the next audio block
+void OSCListener::pushDecoded()
+{
+	std::lock_guard<std::mutex> lock(fMutex);
+	fPending.insert(fPending.end(), fDecoded.begin(), fDecoded.end());
+	fDecoded.clear();
+}
+
+//--------------------------------------------------------------------------
+void OSCListener::ProcessMessage(const osc::ReceivedMessage& m, const IpEndpointName& src)
+{
+ 	Message msg = Message(m.AddressPattern());
+	decode(m, src, msg);
+	bool pending = false;
+	if (fBlockSync) {
+		std::lock_guard<std::mutex> lock(fMutex);
+		pending = fPending.size() > 0;
+	}
+	if (pending) {
+		// a message received after a pending bundle must not be applied before it
+		fMsgHandler->captureValues(&fDecoded);
+		fMsgHandler->processMessage(&msg);
+		fMsgHandler->captureValues(0);
+		pushDecoded();
+	} else {
+		fMsgHandler->processMessage(&msg);
+	}
+}
+
+//--------------------------------------------------------------------------
+void OSCListener::ProcessBundle(const osc::ReceivedBundle& b, const IpEndpointName& src)
+{
+	if (fBlockSync) {
+		// everything but the zones values is handled here, by the listener thread
+		fMsgHandler->captureValues(&fDecoded);
+		process(b, src);
+		fMsgHandler->captureValues(0);
+		pushDecoded();
+	} else {
+		process(b, src);
+	}
+}
+
+//--------------------------------------------------------------------------
+void OSCListener::applyBundles()
+{
+	// never wait for the listener thread: the pending values are stored at the next call
+	std::unique_lock<std::mutex> lock(fMutex, std::try_to_lock);
+	if (lock.owns_lock()) {
+		for (size_t i = 0; i < fPending.size(); i++) {
+			fPending[i].store();
+		}
+		fPending.clear();
+	}
 }
 
 } // end namespoace
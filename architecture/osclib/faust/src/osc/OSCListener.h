@@ -25,6 +25,10 @@
 #ifndef __OSCListener__
 #define __OSCListener__
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 #include "faust/osc/smartpointer.h"
 #include "faust/osc/MessageProcessor.h"
 
@@ -37,6 +41,8 @@ typedef void (*ErrorCallback)(void*);
 namespace oscfaust
 {
 
+class Message;
+
 //--------------------------------------------------------------------------
 /*!
 	\brief an OSC listener that converts OSC input to Messages
@@ -53,6 +59,15 @@ class OSCListener : public osc::OscPacketListener, public smartable
 	bool	fSetDest;
 	int		fPort;
 
+	std::atomic<bool>		fBlockSync;	///< true when the bundles values are stored at audio block boundaries
+	std::mutex				fMutex;		///< protects fPending
+	std::vector<ZoneValue>	fPending;	///< values waiting for the next audio block
+	std::vector<ZoneValue>	fDecoded;	///< values of the message or bundle being decoded (listener thread only)
+
+	void	decode(const osc::ReceivedMessage& m, const IpEndpointName& src, Message& msg);
+	void	process(const osc::ReceivedBundle& b, const IpEndpointName& src);
+	void	pushDecoded();
+
 	public:
 		static SMARTP<OSCListener> create(MessageProcessor* mp, int port, const char* bindAddress=0)
 			{ return new OSCListener(mp, port, bindAddress); }
@@ -64,6 +79,24 @@ class OSCListener : public osc::OscPacketListener, public smartable
 			\param remoteEndpoint the sender IP address
 		*/
 		virtual void ProcessMessage(const osc::ReceivedMessage& m, const IpEndpointName& remoteEndpoint);
+
+		/*!
+			\brief process OSC bundles
+
+			In block sync mode, the messages of a bundle are processed by the listener thread,
+			but the values to be stored in the zones are only stored at the next applyBundles()
+			call (by the audio thread), so that a whole bundle is applied before the next audio block.
+			Otherwise the bundle messages are processed like single messages.
+			\param b the OSC bundle
+			\param remoteEndpoint the sender IP address
+		*/
+		virtual void ProcessBundle(const osc::ReceivedBundle& b, const IpEndpointName& remoteEndpoint);
+
+		/*!
+			\brief stores the values of the pending bundles, to be called at audio block boundaries in block sync mode
+		*/
+		virtual void applyBundles();
+		virtual void setBlockSync(bool state)	{ fBlockSync = state; }
 		virtual void run();
 		virtual void stop()				{ fRunning = false; if (fSocket) fSocket->AsynchronousBreak(); }
 		virtual void setPort(int port)	{ fPort = port; }
@@ -109,6 +109,8 @@ bool OSCSetup::start(MessageProcessor* mp, int& inPort, int outPort, int errPort
 //--------------------------------------------------------------------------
 void OSCSetup::endBundle()			{ oscout.endBundle(); }
 void OSCSetup::bundle(bool state)	{ oscout.setBundle(state); }
+void OSCSetup::applyBundles()		{ if (fOSCThread) fOSCThread->listener()->applyBundles(); }
+void OSCSetup::blockSync(bool state)	{ if (fOSCThread) fOSCThread->listener()->setBlockSync(state); }
 
 //--------------------------------------------------------------------------
 void OSCSetup::stop()
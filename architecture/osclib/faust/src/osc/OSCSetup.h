@@ -56,6 +56,8 @@ class OSCSetup
         void stop();
         void endBundle();
         void bundle(bool state);
+        void applyBundles();    // stores the received bundles values, to be called at audio block boundaries
+        void blockSync(bool state);
 
 		bool running() const;
 };
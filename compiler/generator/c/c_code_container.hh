@@ -55,6 +55,11 @@ class CCodeContainer : public virtual CodeContainer {
             addIncludeFile("<math.h>");
         }
 
+        // For explicit SIMD loops
+        if (gGlobal->gExplicitSIMD) {
+            addIncludeFile("\"faust/dsp/simd-vector.h\"");
+        }
+
         // For malloc/free
         addIncludeFile("<stdlib.h>");
     }
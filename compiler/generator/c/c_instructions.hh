@@ -23,6 +23,7 @@
 #define _C_INSTRUCTIONS_H
 
 #include <string>
+#include "simd_instructions.hh"
 #include "text_instructions.hh"
 
 using namespace std;
@@ -344,6 +345,13 @@ class CInstVisitor : public TextInstVisitor {
             c99_declare_inst->accept(this);
         }
 
+        // Explicit SIMD loop, the scalar loop then computes the remaining frames
+        SIMDInstVisitor simd(this, fTab);
+        bool            simd_loop = c99_declare_inst && gGlobal->gExplicitSIMD && !inst->fIsRecursive && simd.generate(inst);
+        if (simd_loop) {
+            *fOut << simd.getCode(false);
+        }
+
         if (gGlobal->gClang && !inst->fIsRecursive) {
             *fOut << "#pragma clang loop vectorize(enable) interleave(enable)";
             tab(fTab, *fOut);
@@ -351,7 +359,9 @@ class CInstVisitor : public TextInstVisitor {
 
         *fOut << "for (";
         fFinishLine = false;
-        if (c99_declare_inst) {
+        if (simd_loop) {
+            // Index already set by the SIMD loop
+        } else if (c99_declare_inst) {
             // C99 loop initialized here
             c99_init_inst->accept(this);
         } else {
@@ -441,7 +441,7 @@ BlockInst* CodeContainer::flattenFIR(void)
     return global_block;
 }
 
-void CodeContainer::generateMetaData(JSONUI* json)
+void CodeContainer::generateMetaData(Meta* meta)
 {
     // Add global metadata
     for (MetaDataSet::iterator i = gGlobal->gMetaDataSet.begin(); i != gGlobal->gMetaDataSet.end(); i++) {
@@ -451,7 +451,7 @@ void CodeContainer::generateMetaData(JSONUI* json)
             str2 << **(i->second.begin());
             string res1 = str1.str();
             string res2 = unquote(str2.str());
-            json->declare(res1.c_str(), res2.c_str());
+            meta->declare(res1.c_str(), res2.c_str());
         } else {
             for (set<Tree>::iterator j = i->second.begin(); j != i->second.end(); j++) {
                 if (j == i->second.begin()) {
@@ -460,12 +460,12 @@ void CodeContainer::generateMetaData(JSONUI* json)
                     str2 << **j;
                     string res1 = str1.str();
                     string res2 = unquote(str2.str());
-                    json->declare(res1.c_str(), res2.c_str());
+                    meta->declare(res1.c_str(), res2.c_str());
                 } else {
                     stringstream str2;
                     str2 << **j;
                     string res2 = unquote(str2.str());
-                    json->declare("contributor", res2.c_str());
+                    meta->declare("contributor", res2.c_str());
                 }
             }
         }
@@ -494,6 +494,29 @@ void CodeContainer::generateJSON(JSONInstVisitor* visitor)
     generateMetaData(visitor);
 }
 
+void CodeContainer::generateBinaryFile()
+{
+    BinaryInstVisitor binary_visitor;
+    generateBinary(&binary_visitor);
+    ofstream xout(subst("$0.fbd", gGlobal->makeDrawPath()).c_str(), ios::binary);
+    string binary = binary_visitor.binary();
+    xout.write(binary.data(), binary.size());
+}
+
+void CodeContainer::generateBinary(BinaryInstVisitor* visitor)
+{
+    // Prepare compilation options
+    stringstream compile_options;
+    gGlobal->printCompilationOptions(compile_options);
+
+    // "name", "filename" found in medata
+    visitor->init("", "", fNumInputs, fNumOutputs, -1, "", "", FAUSTVERSION, compile_options.str(),
+                  gGlobal->gReader.listLibraryFiles(), gGlobal->gImportDirList, "", std::map<std::string, int>());
+
+    generateUserInterface(visitor);
+    generateMetaData(visitor);
+}
+
 BlockInst* CodeContainer::inlineSubcontainersFunCalls(BlockInst* block)
 {
     // Rename 'sig' in 'dsp' and remove 'dsp' allocation
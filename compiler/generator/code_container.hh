@@ -290,8 +290,10 @@ class CodeContainer : public virtual Garbageable {
     void generateDAGLoop(BlockInst* loop_code, DeclareVarInst* count);
 
     void generateJSONFile();
-    void generateMetaData(JSONUI* json);
+    void generateMetaData(Meta* meta);
     void generateJSON(JSONInstVisitor* visitor);
+    void generateBinaryFile();
+    void generateBinary(BinaryInstVisitor* visitor);
 
     DeclareFunInst* generateCalloc();
     DeclareFunInst* generateFree();
@@ -490,7 +490,11 @@ void CPPCodeContainer::produceClass()
     }
 
     // Compute
-    generateCompute(n);
+    if (gGlobal->gMultiTargets.size() > 0) {
+        generateMultiTargetCompute(n);
+    } else {
+        generateCompute(n);
+    }
     tab(n, *fOut);
     tab(n, *fOut);
     *fOut << "};" << endl;
@@ -505,6 +509,41 @@ void CPPCodeContainer::produceClass()
     printMacros(*fOut, n);
 }
 
+/*
+ Generates one version of 'compute' for each target ISA (compiled with the corresponding
+ 'target' function attribute), a default version, and the 'compute' method choosing
+ the best one for the running CPU.
+ */
+void CPPCodeContainer::generateMultiTargetCompute(int n)
+{
+    for (auto& it : gGlobal->gMultiTargets) {
+        fComputeName = subst("FAUST_TARGET(\"$0\") void compute_$1", gGlobal->getTargetAttribute(it), replaceChar(it, '.', '_'));
+        generateCompute(n);
+    }
+    fComputeName = "void compute_default";
+    generateCompute(n);
+    fComputeName = "virtual void compute";
+
+    tab(n + 1, *fOut);
+    tab(n + 1, *fOut);
+    *fOut << subst("virtual void compute(int $0, $1** inputs, $1** outputs) {", fFullCount, xfloat());
+    tab(n + 2, *fOut);
+    for (auto& it : gGlobal->gMultiTargets) {
+        *fOut << "if (" << gGlobal->getTargetCondition(it) << ") {";
+        tab(n + 3, *fOut);
+        *fOut << subst("compute_$0($1, inputs, outputs);", replaceChar(it, '.', '_'), fFullCount);
+        tab(n + 2, *fOut);
+        *fOut << "} else ";
+    }
+    *fOut << "{";
+    tab(n + 3, *fOut);
+    *fOut << subst("compute_default($0, inputs, outputs);", fFullCount);
+    tab(n + 2, *fOut);
+    *fOut << "}";
+    tab(n + 1, *fOut);
+    *fOut << "}";
+}
+
 // Scalar
 CPPScalarCodeContainer::CPPScalarCodeContainer(const string& name, const string& super, int numInputs, int numOutputs,
                                                std::ostream* out, int sub_container_type)
@@ -525,7 +564,7 @@ void CPPScalarCodeContainer::generateCompute(int n)
     if (gGlobal->gOneSample) {
         *fOut << subst("virtual void compute($0* inputs, $0* outputs, int* icontrol, $0* fcontrol) {", xfloat());
     } else {
-        *fOut << subst("virtual void compute(int $0, $1** inputs, $1** outputs) {", fFullCount, xfloat());
+        *fOut << subst("$0(int $1, $2** inputs, $2** outputs) {", fComputeName, fFullCount, xfloat());
     }
     tab(n + 2, *fOut);
     fCodeProducer.Tab(n + 2);
@@ -575,7 +614,7 @@ void CPPVectorCodeContainer::generateCompute(int n)
 
     // Generates declaration
     tab(n + 1, *fOut);
-    *fOut << subst("virtual void compute(int $0, $1** inputs, $1** outputs) {", fFullCount, xfloat());
+    *fOut << subst("$0(int $1, $2** inputs, $2** outputs) {", fComputeName, fFullCount, xfloat());
     tab(n + 2, *fOut);
     fCodeProducer.Tab(n + 2);
 
@@ -609,7 +648,7 @@ void CPPOpenMPCodeContainer::generateCompute(int n)
 
     // Generates declaration
     tab(n + 1, *fOut);
-    *fOut << subst("virtual void compute(int $0, $1** inputs, $1** outputs) {", fFullCount, xfloat());
+    *fOut << subst("$0(int $1, $2** inputs, $2** outputs) {", fComputeName, fFullCount, xfloat());
     tab(n + 2, *fOut);
     fCodeProducer.Tab(n + 2);
 
@@ -658,7 +697,7 @@ void CPPWorkStealingCodeContainer::generateCompute(int n)
 
     // Generates declaration
     tab(n + 1, *fOut);
-    *fOut << subst("virtual void compute(int $0, $1** inputs, $1** outputs) {", fFullCount, xfloat());
+    *fOut << subst("$0(int $1, $2** inputs, $2** outputs) {", fComputeName, fFullCount, xfloat());
     tab(n + 2, *fOut);
     fCodeProducer.Tab(n + 2);
 
@@ -41,13 +41,15 @@ class CPPCodeContainer : public virtual CodeContainer {
     CPPInstVisitor fCodeProducer;
     std::ostream*  fOut;
     string         fSuperKlassName;
+    string         fComputeName;  // Changed when ISA specific versions of 'compute' are generated
 
     void produceMetadata(int tabs);
+    void generateMultiTargetCompute(int tabs);
     void produceInit(int tabs);
 
    public:
     CPPCodeContainer(const string& name, const string& super, int numInputs, int numOutputs, std::ostream* out)
-        : fCodeProducer(out), fOut(out), fSuperKlassName(super)
+        : fCodeProducer(out), fOut(out), fSuperKlassName(super), fComputeName("virtual void compute")
     {
         initialize(numInputs, numOutputs);
         fKlassName = name;
@@ -60,6 +62,16 @@ class CPPCodeContainer : public virtual CodeContainer {
             addIncludeFile("<cmath>");
             addIncludeFile("<algorithm>");
         }
+
+        // For explicit SIMD loops
+        if (gGlobal->gExplicitSIMD) {
+            addIncludeFile("\"faust/dsp/simd-vector.h\"");
+        }
+
+        // For runtime CPU dispatch
+        if (gGlobal->gMultiTargets.size() > 0) {
+            addIncludeFile("\"faust/dsp/cpu-dispatch.h\"");
+        }
     }
 
     virtual ~CPPCodeContainer() {}
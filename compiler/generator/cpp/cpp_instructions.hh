@@ -24,6 +24,7 @@
 
 using namespace std;
 
+#include "simd_instructions.hh"
 #include "text_instructions.hh"
 #include "type_manager.hh"
 
@@ -408,6 +409,29 @@ class CPPInstVisitor : public TextInstVisitor {
         // Don't generate empty loops...
         if (inst->fCode->size() == 0) return;
 
+        // Explicit SIMD loop, followed by a scalar loop for the remaining frames
+        if (gGlobal->gExplicitSIMD && !inst->fIsRecursive) {
+            SIMDInstVisitor simd(this, fTab);
+            if (simd.generate(inst)) {
+                *fOut << simd.getCode(true);
+                *fOut << "for (int " << simd.getIndex() << " = FAUST_SIMD_FLOOR(" << simd.getBound() << "); ";
+                fFinishLine = false;
+                inst->fEnd->accept(this);
+                *fOut << "; ";
+                inst->fIncrement->accept(this);
+                fFinishLine = true;
+                *fOut << ") {";
+                fTab++;
+                tab(fTab, *fOut);
+                inst->fCode->accept(this);
+                fTab--;
+                tab(fTab, *fOut);
+                *fOut << "}";
+                tab(fTab, *fOut);
+                return;
+            }
+        }
+
         if (gGlobal->gClang && !inst->fIsRecursive) {
             *fOut << "#pragma clang loop vectorize(enable) interleave(enable)";
             tab(fTab, *fOut);
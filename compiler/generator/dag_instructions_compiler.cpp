@@ -130,6 +130,11 @@ void DAGInstructionsCompiler::compileMultiSignal(Tree L)
     if (gGlobal->gPrintJSONSwitch) {
         fContainer->generateJSONFile();
     }
+
+    // Generate binary description
+    if (gGlobal->gPrintBinarySwitch) {
+        fContainer->generateBinaryFile();
+    }
 }
 
 /**
@@ -35,6 +35,9 @@
 #include "recursivness.hh"
 #include "sigConstantPropagation.hh"
 #include "sigPromotion.hh"
+#include "sigControlRate.hh"
+#include "sigLookupTable.hh"
+#include "sigRecLookAhead.hh"
 #include "sigToGraph.hh"
 #include "sigprint.hh"
 #include "sigtyperules.hh"
@@ -166,6 +169,37 @@ Tree InstructionsCompiler::prepare(Tree LS)
     Tree L4 = SK.mapself(L3);
     endTiming("Constant propagation");
 
+    if (gGlobal->gControlRate > 0) {
+        startTiming("Control rate");
+        typeAnnotation(L4, gGlobal->gLocalCausalityCheck);  // Needed to check signals variability
+        SignalControlRate CR(gGlobal->gControlRate);
+        // CR.trace(true, "ControlRate");
+        L4 = CR.mapself(L4);
+        // New recursions may have been added inside existing (in place modified) ones
+        gGlobal->gSymListProp->clear(L4);
+        endTiming("Control rate");
+    }
+
+    if (gGlobal->gLUTAccuracy > 0) {
+        startTiming("Lookup tables");
+        typeAnnotation(L4, gGlobal->gLocalCausalityCheck);  // Needed to get arguments intervals
+        SignalLookupTable LT(gGlobal->gLUTAccuracy);
+        // LT.trace(true, "LookupTable");
+        L4 = LT.mapself(L4);
+        gGlobal->gSymListProp->clear(L4);
+        if (gGlobal->gDetailsSwitch) LT.print(cout);
+        endTiming("Lookup tables");
+    }
+
+    if (gGlobal->gRecLookAhead > 0) {
+        startTiming("Recursion look-ahead");
+        typeAnnotation(L4, gGlobal->gLocalCausalityCheck);  // Needed to check coefficients variability
+        SignalRecLookAhead LA(gGlobal->gRecLookAhead);
+        // LA.trace(true, "LookAhead");
+        L4 = LA.mapself(L4);
+        endTiming("Recursion look-ahead");
+    }
+
     Tree L5 = privatise(L4);  // Un-share tables with multiple writers
 
     // dump normal form
@@ -414,6 +448,11 @@ void InstructionsCompiler::compileMultiSignal(Tree L)
         fContainer->generateJSONFile();
     }
 
+    // Generate binary description
+    if (gGlobal->gPrintBinarySwitch) {
+        fContainer->generateBinaryFile();
+    }
+
     endTiming("compileMultiSignal");
 }
 
@@ -24,6 +24,7 @@
 
 #include <string>
 
+#include "faust/gui/BinaryUI.h"
 #include "faust/gui/JSONUI.h"
 #include "instructions.hh"
 
@@ -34,43 +35,44 @@ using namespace std;
 #endif
 
 /*
- FIR visitor to prepare the JSON representation.
+ FIR visitor to prepare the UI description, with the JSONUI or BinaryUI builder.
 */
 
-struct JSONInstVisitor : public DispatchVisitor, public JSONUI {
+template <class UI_BUILDER>
+struct UIInstVisitor : public DispatchVisitor, public UI_BUILDER {
     map<string, string> fPathTable;  // Table : field_name, complete path
 
     using DispatchVisitor::visit;
 
-    JSONInstVisitor(const std::string& name, const std::string& filename, int inputs, int outputs, int sr_index,
-                    const std::string& sha_key, const std::string& dsp_code, const std::string& version,
-                    const std::string& compile_options, const std::vector<std::string>& library_list,
-                    const std::vector<std::string>& include_pathnames, const std::string& size,
-                    const std::map<std::string, int>& path_table)
-        : JSONUI(name, filename, inputs, outputs, sr_index, sha_key, dsp_code, version, compile_options, library_list,
-                 include_pathnames, size, path_table)
+    UIInstVisitor(const std::string& name, const std::string& filename, int inputs, int outputs, int sr_index,
+                  const std::string& sha_key, const std::string& dsp_code, const std::string& version,
+                  const std::string& compile_options, const std::vector<std::string>& library_list,
+                  const std::vector<std::string>& include_pathnames, const std::string& size,
+                  const std::map<std::string, int>& path_table)
+        : UI_BUILDER(name, filename, inputs, outputs, sr_index, sha_key, dsp_code, version, compile_options,
+                     library_list, include_pathnames, size, path_table)
     {
     }
 
-    JSONInstVisitor(int inputs, int outputs) : JSONUI(inputs, outputs) {}
+    UIInstVisitor(int inputs, int outputs) : UI_BUILDER(inputs, outputs) {}
 
-    JSONInstVisitor() : JSONUI() {}
+    UIInstVisitor() : UI_BUILDER() {}
 
-    virtual ~JSONInstVisitor() {}
+    virtual ~UIInstVisitor() {}
 
-    virtual void visit(AddMetaDeclareInst* inst) { declare(NULL, inst->fKey.c_str(), inst->fValue.c_str()); }
+    virtual void visit(AddMetaDeclareInst* inst) { this->declare(NULL, inst->fKey.c_str(), inst->fValue.c_str()); }
 
     virtual void visit(OpenboxInst* inst)
     {
         switch (inst->fOrient) {
             case 0:
-                openVerticalBox(inst->fName.c_str());
+                this->openVerticalBox(inst->fName.c_str());
                 break;
             case 1:
-                openHorizontalBox(inst->fName.c_str());
+                this->openHorizontalBox(inst->fName.c_str());
                 break;
             case 2:
-                openTabBox(inst->fName.c_str());
+                this->openTabBox(inst->fName.c_str());
                 break;
             default:
                 faustassert(false);
@@ -78,64 +80,95 @@ struct JSONInstVisitor : public DispatchVisitor, public JSONUI {
         }
     }
 
-    virtual void visit(CloseboxInst* inst) { closeBox(); }
+    virtual void visit(CloseboxInst* inst) { this->closeBox(); }
 
     virtual void visit(AddButtonInst* inst)
     {
         if (inst->fType == AddButtonInst::kDefaultButton) {
-            addButton(inst->fLabel.c_str(), nullptr);
+            this->addButton(inst->fLabel.c_str(), nullptr);
         } else {
-            addCheckButton(inst->fLabel.c_str(), nullptr);
+            this->addCheckButton(inst->fLabel.c_str(), nullptr);
         }
 
-        fPathTable[inst->fZone] = buildPath(inst->fLabel);
+        fPathTable[inst->fZone] = this->buildPath(inst->fLabel);
     }
 
     virtual void visit(AddSliderInst* inst)
     {
         switch (inst->fType) {
             case AddSliderInst::kHorizontal:
-                addHorizontalSlider(inst->fLabel.c_str(), nullptr, inst->fInit, inst->fMin, inst->fMax, inst->fStep);
+                this->addHorizontalSlider(inst->fLabel.c_str(), nullptr, inst->fInit, inst->fMin, inst->fMax, inst->fStep);
                 break;
             case AddSliderInst::kVertical:
-                addVerticalSlider(inst->fLabel.c_str(), nullptr, inst->fInit, inst->fMin, inst->fMax, inst->fStep);
+                this->addVerticalSlider(inst->fLabel.c_str(), nullptr, inst->fInit, inst->fMin, inst->fMax, inst->fStep);
                 break;
             case AddSliderInst::kNumEntry:
-                addNumEntry(inst->fLabel.c_str(), nullptr, inst->fInit, inst->fMin, inst->fMax, inst->fStep);
+                this->addNumEntry(inst->fLabel.c_str(), nullptr, inst->fInit, inst->fMin, inst->fMax, inst->fStep);
                 break;
             default:
                 faustassert(false);
                 break;
         }
 
-        fPathTable[inst->fZone] = buildPath(inst->fLabel);
+        fPathTable[inst->fZone] = this->buildPath(inst->fLabel);
     }
 
     virtual void visit(AddBargraphInst* inst)
     {
         switch (inst->fType) {
             case AddBargraphInst::kHorizontal:
-                addHorizontalBargraph(inst->fLabel.c_str(), nullptr, inst->fMin, inst->fMax);
+                this->addHorizontalBargraph(inst->fLabel.c_str(), nullptr, inst->fMin, inst->fMax);
                 break;
             case AddBargraphInst::kVertical:
-                addVerticalBargraph(inst->fLabel.c_str(), nullptr, inst->fMin, inst->fMax);
+                this->addVerticalBargraph(inst->fLabel.c_str(), nullptr, inst->fMin, inst->fMax);
                 break;
             default:
                 faustassert(false);
                 break;
         }
 
-        fPathTable[inst->fZone] = buildPath(inst->fLabel);
+        fPathTable[inst->fZone] = this->buildPath(inst->fLabel);
     }
 
     virtual void visit(AddSoundfileInst* inst)
     {
-        addSoundfile(inst->fLabel.c_str(), inst->fURL.c_str(), nullptr);
-        fPathTable[inst->fSFZone] = buildPath(inst->fLabel);
+        this->addSoundfile(inst->fLabel.c_str(), inst->fURL.c_str(), nullptr);
+        fPathTable[inst->fSFZone] = this->buildPath(inst->fLabel);
     }
+};
+
+/*
+ FIR visitor to prepare the JSON representation.
+*/
+
+struct JSONInstVisitor : public UIInstVisitor<JSONUI> {
+
+    JSONInstVisitor(const std::string& name, const std::string& filename, int inputs, int outputs, int sr_index,
+                    const std::string& sha_key, const std::string& dsp_code, const std::string& version,
+                    const std::string& compile_options, const std::vector<std::string>& library_list,
+                    const std::vector<std::string>& include_pathnames, const std::string& size,
+                    const std::map<std::string, int>& path_table)
+        : UIInstVisitor<JSONUI>(name, filename, inputs, outputs, sr_index, sha_key, dsp_code, version,
+                                compile_options, library_list, include_pathnames, size, path_table)
+    {
+    }
+
+    JSONInstVisitor(int inputs, int outputs) : UIInstVisitor<JSONUI>(inputs, outputs) {}
+
+    JSONInstVisitor() : UIInstVisitor<JSONUI>() {}
+
+    virtual ~JSONInstVisitor() {}
+};
+
+/*
+ FIR visitor to prepare the binary representation (see BinaryUI.h).
+*/
+
+struct BinaryInstVisitor : public UIInstVisitor<BinaryUI> {
+
+    BinaryInstVisitor() : UIInstVisitor<BinaryUI>() {}
 
-    void setInputs(int input) { fInputs = input; }
-    void setOutputs(int output) { fOutputs = output; }
+    virtual ~BinaryInstVisitor() {}
 };
 
 #endif
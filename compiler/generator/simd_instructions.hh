@@ -0,0 +1,610 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2019 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef _SIMD_INSTRUCTIONS_H
+#define _SIMD_INSTRUCTIONS_H
+
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include "text_instructions.hh"
+#include "typing_instructions.hh"
+
+using namespace std;
+
+/*
+ Explicit SIMD code generation for the non-recursive loops of the vector mode ('-simd' option).
+
+ The loop body is translated in calls to the functions defined in 'faust/dsp/simd-vector.h',
+ processing FAUST_SIMD_SIZE frames at a time. Loop invariant sub-expressions are printed
+ with the backend scalar visitor and broadcasted with 'simd_set1_f/simd_set1_i'.
+
+ The translation fails (and the backend then generates the usual scalar loop) when the loop body
+ contains something that cannot be vectorized: loop carried dependencies, struct fields writes,
+ unknown functions, 64 bits or double types...
+*/
+
+class SIMDInstVisitor : public InstVisitor {
+   public:
+    enum SIMDKind { kSIMDFloat, kSIMDInt };
+
+   private:
+    // Vector version of math functions: name, arity and argument kind
+    struct SIMDFun {
+        string   fName;
+        int      fArity;
+        SIMDKind fKind;
+    };
+
+    // Checks that a value does not depend on the loop
+    struct SIMDInvariantVisitor : public DispatchVisitor {
+        const set<string>& fVariants;
+        bool               fInvariant;
+
+        SIMDInvariantVisitor(const set<string>& variants) : fVariants(variants), fInvariant(true) {}
+
+        virtual void visit(NamedAddress* named)
+        {
+            if (fVariants.find(named->fName) != fVariants.end()) fInvariant = false;
+        }
+
+        virtual void visit(LoadVarAddressInst* inst) { fInvariant = false; }
+        virtual void visit(TeeVarInst* inst) { fInvariant = false; }
+
+        virtual void visit(FunCallInst* inst)
+        {
+            // Only pure functions with a known type
+            if (isSIMDFun(inst->fName) && gGlobal->hasVarType(inst->fName)) {
+                DispatchVisitor::visit(inst);
+            } else {
+                fInvariant = false;
+            }
+        }
+    };
+
+    TextInstVisitor*  fScalar;  // Backend visitor to print scalar (loop invariant) values
+    int               fTab;
+    string            fIndex;   // Loop index name
+    string            fBound;   // Loop bound as a scalar expression
+    map<string, SIMDKind> fLocals;  // Loop local variables, generated as vectors
+    set<string>       fVariants;    // Names of all variables depending on the loop
+    map<string, set<string> > fStores;  // Array name ==> written index
+    map<string, set<string> > fLoads;   // Array name ==> read index
+    int               fGathers;     // Number of generated gathers
+    std::stringstream fCode;
+
+    // Result of the last visited value
+    string   fCurValue;
+    SIMDKind fCurKind;
+    bool     fError;
+
+    static map<string, SIMDFun>& getFunTable()
+    {
+        static map<string, SIMDFun> gSIMDFunTable;
+        if (gSIMDFunTable.size() > 0) return gSIMDFunTable;
+
+        gSIMDFunTable["fabsf"]      = {"simd_abs_f", 1, kSIMDFloat};
+        gSIMDFunTable["sqrtf"]      = {"simd_sqrt_f", 1, kSIMDFloat};
+        gSIMDFunTable["floorf"]     = {"simd_floor_f", 1, kSIMDFloat};
+        gSIMDFunTable["ceilf"]      = {"simd_ceil_f", 1, kSIMDFloat};
+        gSIMDFunTable["roundf"]     = {"simd_round_f", 1, kSIMDFloat};
+        gSIMDFunTable["rintf"]      = {"simd_rint_f", 1, kSIMDFloat};
+        gSIMDFunTable["expf"]       = {"simd_exp_f", 1, kSIMDFloat};
+        gSIMDFunTable["exp2f"]      = {"simd_exp2_f", 1, kSIMDFloat};
+        gSIMDFunTable["exp10f"]     = {"simd_exp10_f", 1, kSIMDFloat};
+        gSIMDFunTable["logf"]       = {"simd_log_f", 1, kSIMDFloat};
+        gSIMDFunTable["log2f"]      = {"simd_log2_f", 1, kSIMDFloat};
+        gSIMDFunTable["log10f"]     = {"simd_log10_f", 1, kSIMDFloat};
+        gSIMDFunTable["sinf"]       = {"simd_sin_f", 1, kSIMDFloat};
+        gSIMDFunTable["cosf"]       = {"simd_cos_f", 1, kSIMDFloat};
+        gSIMDFunTable["tanf"]       = {"simd_tan_f", 1, kSIMDFloat};
+        gSIMDFunTable["atanf"]      = {"simd_atan_f", 1, kSIMDFloat};
+        gSIMDFunTable["atan2f"]     = {"simd_atan2_f", 2, kSIMDFloat};
+        gSIMDFunTable["powf"]       = {"simd_pow_f", 2, kSIMDFloat};
+        gSIMDFunTable["fmodf"]      = {"simd_fmod_f", 2, kSIMDFloat};
+        gSIMDFunTable["remainderf"] = {"simd_remainder_f", 2, kSIMDFloat};
+        gSIMDFunTable["min_f"]      = {"simd_min_f", 2, kSIMDFloat};
+        gSIMDFunTable["max_f"]      = {"simd_max_f", 2, kSIMDFloat};
+        gSIMDFunTable["abs"]        = {"simd_abs_i", 1, kSIMDInt};
+        gSIMDFunTable["min_i"]      = {"simd_min_i", 2, kSIMDInt};
+        gSIMDFunTable["max_i"]      = {"simd_max_i", 2, kSIMDInt};
+        return gSIMDFunTable;
+    }
+
+    // Integer power functions are generated as 'xxx_faustpowerN_f' or 'xxx_faustpowerN_i'
+    static bool isFaustPower(const string& name, int& power, SIMDKind& kind)
+    {
+        size_t pos = name.rfind("_faustpower");
+        if (pos == string::npos || name.size() < 3) return false;
+        string suffix = name.substr(name.size() - 2);
+        if (suffix != "_f" && suffix != "_i") return false;
+        string num = name.substr(pos + 11, name.size() - pos - 13);
+        if (num.empty() || num.find_first_not_of("0123456789") != string::npos) return false;
+        power = std::atoi(num.c_str());
+        kind  = (suffix == "_f") ? kSIMDFloat : kSIMDInt;
+        return true;
+    }
+
+    static bool isSIMDFun(const string& name)
+    {
+        int      power;
+        SIMDKind kind;
+        return (getFunTable().find(name) != getFunTable().end()) || isFaustPower(name, power, kind);
+    }
+
+    string scalar(ValueInst* inst)
+    {
+        std::stringstream str;
+        std::ostream*     out = fScalar->getOutput();
+        fScalar->setOutput(&str);
+        inst->accept(fScalar);
+        fScalar->setOutput(out);
+        return str.str();
+    }
+
+    string scalar(Address* address)
+    {
+        std::stringstream str;
+        std::ostream*     out = fScalar->getOutput();
+        fScalar->setOutput(&str);
+        address->accept(fScalar);
+        fScalar->setOutput(out);
+        return str.str();
+    }
+
+    bool isInvariant(ValueInst* inst)
+    {
+        SIMDInvariantVisitor invariant(fVariants);
+        inst->accept(&invariant);
+        return invariant.fInvariant;
+    }
+
+    bool isIndex(ValueInst* inst)
+    {
+        LoadVarInst* load = dynamic_cast<LoadVarInst*>(inst);
+        return load && dynamic_cast<NamedAddress*>(load->fAddress) && load->getName() == fIndex;
+    }
+
+    // Index of the form 'i', 'i + k' or 'i - k' with a loop invariant 'k': consecutive frames are contiguous
+    bool isContiguousIndex(ValueInst* index)
+    {
+        if (isIndex(index)) return true;
+        BinopInst* binop = dynamic_cast<BinopInst*>(index);
+        if (!binop) return false;
+        if (binop->fOpcode == kAdd) {
+            return (isIndex(binop->fInst1) && isInvariant(binop->fInst2)) ||
+                   (isIndex(binop->fInst2) && isInvariant(binop->fInst1));
+        } else if (binop->fOpcode == kSub) {
+            return isIndex(binop->fInst1) && isInvariant(binop->fInst2);
+        } else {
+            return false;
+        }
+    }
+
+    // Element type of an array, as 'f' (float), 'ff' (FAUSTFLOAT) or 'i' (int)
+    bool getArrayType(const string& name, string& type, SIMDKind& kind)
+    {
+        if (!gGlobal->hasVarType(name)) return false;
+        switch (Typed::getTypeFromPtr(gGlobal->getVarType(name))) {
+            case Typed::kFloat:
+                type = "f";
+                kind = kSIMDFloat;
+                return true;
+            case Typed::kFloatMacro:
+                type = "ff";
+                kind = kSIMDFloat;
+                return true;
+            case Typed::kInt32:
+                type = "i";
+                kind = kSIMDInt;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static string convert(const string& value, SIMDKind from, SIMDKind to)
+    {
+        if (from == to) {
+            return value;
+        } else if (to == kSIMDFloat) {
+            return "simd_cvt_i2f(" + value + ")";
+        } else {
+            return "simd_cvt_f2i(" + value + ")";
+        }
+    }
+
+    static string kindName(SIMDKind kind) { return (kind == kSIMDFloat) ? "simd_float" : "simd_int"; }
+
+    // Visit a value and returns its vector version converted to 'kind'
+    bool genValue(ValueInst* inst, string& value, SIMDKind& kind)
+    {
+        fCurValue = "";
+        if (fError) return false;
+
+        if (isInvariant(inst)) {
+            TypingVisitor typing;
+            inst->accept(&typing);
+            if (isRealType(typing.fCurType)) {
+                fCurValue = "simd_set1_f(" + scalar(inst) + ")";
+                fCurKind  = kSIMDFloat;
+            } else if (typing.fCurType == Typed::kInt32 || typing.fCurType == Typed::kBool) {
+                fCurValue = "simd_set1_i(" + scalar(inst) + ")";
+                fCurKind  = kSIMDInt;
+            }
+        } else {
+            inst->accept(this);
+        }
+
+        if (fCurValue == "") {
+            fError = true;
+            return false;
+        }
+        value = fCurValue;
+        kind  = fCurKind;
+        // So that a visitor failing after sub-values have been generated does not return the last one
+        fCurValue = "";
+        return true;
+    }
+
+    bool genValue(ValueInst* inst, string& value, SIMDKind& kind, SIMDKind expected)
+    {
+        if (!genValue(inst, value, kind)) return false;
+        value = convert(value, kind, expected);
+        kind  = expected;
+        return true;
+    }
+
+    void setValue(const string& value, SIMDKind kind)
+    {
+        fCurValue = value;
+        fCurKind  = kind;
+    }
+
+    void fail() { fError = true; }
+
+    void genStatement(const string& code)
+    {
+        tab(fTab + 1, fCode);
+        fCode << code;
+    }
+
+    // Collect all variables written in the loop
+    bool collectVariants(BlockInst* block)
+    {
+        for (auto& it : block->fCode) {
+            if (DeclareVarInst* dec = dynamic_cast<DeclareVarInst*>(it)) {
+                fVariants.insert(dec->getName());
+            } else if (StoreVarInst* store = dynamic_cast<StoreVarInst*>(it)) {
+                fVariants.insert(store->getName());
+            } else if (!dynamic_cast<LabelInst*>(it)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+   public:
+    using InstVisitor::visit;
+
+    SIMDInstVisitor(TextInstVisitor* scalar, int tab)
+        : fScalar(scalar), fTab(tab), fGathers(0), fCurKind(kSIMDFloat), fError(false)
+    {
+    }
+
+    virtual ~SIMDInstVisitor() {}
+
+    // Statements
+
+    virtual void visit(LabelInst* inst)
+    {
+        if (inst->fLabel != "") genStatement(inst->fLabel);
+    }
+
+    virtual void visit(DeclareVarInst* inst)
+    {
+        // Only scalar stack variables
+        if (!(inst->getAccess() & Address::kStack) || !dynamic_cast<BasicTyped*>(inst->fType)) return fail();
+
+        SIMDKind kind;
+        if (isRealType(inst->fType->getType())) {
+            kind = kSIMDFloat;
+        } else if (inst->fType->getType() == Typed::kInt32) {
+            kind = kSIMDInt;
+        } else {
+            return fail();
+        }
+
+        string name = inst->getName();
+        if (inst->fValue) {
+            string   value;
+            SIMDKind value_kind;
+            if (!genValue(inst->fValue, value, value_kind, kind)) return;
+            genStatement(kindName(kind) + " " + name + " = " + value + ";");
+        } else {
+            genStatement(kindName(kind) + " " + name + ";");
+        }
+        fLocals[name] = kind;
+    }
+
+    virtual void visit(StoreVarInst* inst)
+    {
+        string   value;
+        SIMDKind kind;
+
+        if (NamedAddress* named = dynamic_cast<NamedAddress*>(inst->fAddress)) {
+            // Only loop local variables
+            if (fLocals.find(named->fName) == fLocals.end()) return fail();
+            if (!genValue(inst->fValue, value, kind, fLocals[named->fName])) return;
+            genStatement(named->fName + " = " + value + ";");
+
+        } else if (IndexedAddress* indexed = dynamic_cast<IndexedAddress*>(inst->fAddress)) {
+            string   type;
+            SIMDKind elem_kind;
+            if (isStructType(indexed->getName()) || !isContiguousIndex(indexed->fIndex) ||
+                !getArrayType(indexed->getName(), type, elem_kind)) {
+                return fail();
+            }
+            if (!genValue(inst->fValue, value, kind, elem_kind)) return;
+            fStores[indexed->getName()].insert(scalar(indexed->fIndex));
+            genStatement("simd_store_" + type + "(&" + scalar(indexed) + ", " + value + ");");
+
+        } else {
+            fail();
+        }
+    }
+
+    virtual void visit(BlockInst* inst)
+    {
+        for (auto& it : inst->fCode) {
+            if (fError) return;
+            it->accept(this);
+        }
+    }
+
+    // Values
+
+    virtual void visit(LoadVarInst* inst)
+    {
+        if (isIndex(inst)) {
+            setValue("simd_index_i(" + fIndex + ")", kSIMDInt);
+
+        } else if (NamedAddress* named = dynamic_cast<NamedAddress*>(inst->fAddress)) {
+            if (fLocals.find(named->fName) != fLocals.end()) {
+                setValue(named->fName, fLocals[named->fName]);
+            }
+
+        } else if (IndexedAddress* indexed = dynamic_cast<IndexedAddress*>(inst->fAddress)) {
+            string   type;
+            SIMDKind kind;
+            if (isStructType(indexed->getName()) || !getArrayType(indexed->getName(), type, kind)) return;
+
+            if (isContiguousIndex(indexed->fIndex)) {
+                fLoads[indexed->getName()].insert(scalar(indexed->fIndex));
+                setValue("simd_load_" + type + "(&" + scalar(indexed) + ")", kind);
+            } else if (type != "ff") {
+                // Non contiguous read (like a table or a delay line access)
+                string   index;
+                SIMDKind index_kind;
+                if (!genValue(indexed->fIndex, index, index_kind, kSIMDInt)) return;
+                // Never matches a written index, so writing the same array in the loop is refused
+                fLoads[indexed->getName()].insert("");
+                fGathers++;
+                setValue("simd_gather_" + type + "(" + scalar(indexed->fAddress) + ", " + index + ")", kind);
+            }
+        }
+    }
+
+    virtual void visit(BinopInst* inst)
+    {
+        string   v1, v2;
+        SIMDKind k1, k2;
+        if (!genValue(inst->fInst1, v1, k1) || !genValue(inst->fInst2, v2, k2)) return;
+
+        // Mixed int/float operations are done on floats
+        SIMDKind kind = (k1 == kSIMDFloat || k2 == kSIMDFloat) ? kSIMDFloat : kSIMDInt;
+        v1            = convert(v1, k1, kind);
+        v2            = convert(v2, k2, kind);
+        string suffix = (kind == kSIMDFloat) ? "_f(" : "_i(";
+        string args   = v1 + ", " + v2 + ")";
+
+        switch (inst->fOpcode) {
+            case kAdd:
+                return setValue("simd_add" + suffix + args, kind);
+            case kSub:
+                return setValue("simd_sub" + suffix + args, kind);
+            case kMul:
+                return setValue("simd_mul" + suffix + args, kind);
+            case kDiv:
+                return setValue("simd_div" + suffix + args, kind);
+            case kRem:
+                return setValue(((kind == kSIMDFloat) ? "simd_fmod_f(" : "simd_rem_i(") + args, kind);
+            case kGT:
+                return setValue("simd_cmpgt" + suffix + args, kSIMDInt);
+            case kLT:
+                return setValue("simd_cmplt" + suffix + args, kSIMDInt);
+            case kGE:
+                return setValue("simd_cmpge" + suffix + args, kSIMDInt);
+            case kLE:
+                return setValue("simd_cmple" + suffix + args, kSIMDInt);
+            case kEQ:
+                return setValue("simd_cmpeq" + suffix + args, kSIMDInt);
+            case kNE:
+                return setValue("simd_cmpne" + suffix + args, kSIMDInt);
+            default:
+                break;
+        }
+
+        // Bitwise operations on integers only
+        if (kind != kSIMDInt) return;
+        switch (inst->fOpcode) {
+            case kAND:
+                return setValue("simd_and_i(" + args, kind);
+            case kOR:
+                return setValue("simd_or_i(" + args, kind);
+            case kXOR:
+                return setValue("simd_xor_i(" + args, kind);
+            case kLsh:
+                return setValue("simd_shl_i(" + args, kind);
+            case kRsh:
+                return setValue("simd_shr_i(" + args, kind);
+            default:
+                break;
+        }
+    }
+
+    virtual void visit(::CastInst* inst)
+    {
+        string   value;
+        SIMDKind kind;
+        switch (inst->fType->getType()) {
+            case Typed::kFloat:
+            case Typed::kFloatMacro:
+                if (genValue(inst->fInst, value, kind, kSIMDFloat)) setValue(value, kSIMDFloat);
+                break;
+            case Typed::kInt32:
+                if (genValue(inst->fInst, value, kind, kSIMDInt)) setValue(value, kSIMDInt);
+                break;
+            default:
+                break;
+        }
+    }
+
+    virtual void visit(BitcastInst* inst)
+    {
+        string   value;
+        SIMDKind kind;
+        if (!genValue(inst->fInst, value, kind)) return;
+        if (inst->fType->getType() == Typed::kInt32 && kind == kSIMDFloat) {
+            setValue("simd_as_i(" + value + ")", kSIMDInt);
+        } else if (inst->fType->getType() == Typed::kFloat && kind == kSIMDInt) {
+            setValue("simd_as_f(" + value + ")", kSIMDFloat);
+        }
+    }
+
+    // Both branches are computed on all lanes, so a select whose branches read a table
+    // (that the condition may guard against an out of bounds index) is not vectorized
+    virtual void visit(Select2Inst* inst)
+    {
+        string   cond, v1, v2;
+        SIMDKind k1, k2;
+        if (!genValue(inst->fCond, cond, k1, kSIMDInt)) return;
+        int gathers = fGathers;
+        if (!genValue(inst->fThen, v1, k1) || !genValue(inst->fElse, v2, k2)) return;
+        if (fGathers != gathers) return;
+        SIMDKind kind = (k1 == kSIMDFloat || k2 == kSIMDFloat) ? kSIMDFloat : kSIMDInt;
+        setValue(string((kind == kSIMDFloat) ? "simd_select_f(" : "simd_select_i(") + cond + ", " +
+                     convert(v1, k1, kind) + ", " + convert(v2, k2, kind) + ")",
+                 kind);
+    }
+
+    virtual void visit(FunCallInst* inst)
+    {
+        int      power;
+        SIMDKind kind;
+        if (isFaustPower(inst->fName, power, kind)) {
+            string   value;
+            SIMDKind value_kind;
+            if (inst->fArgs.size() == 1 && genValue(inst->fArgs.front(), value, value_kind, kind)) {
+                setValue(string((kind == kSIMDFloat) ? "simd_faustpower_f(" : "simd_faustpower_i(") + value +
+                             ", " + std::to_string(power) + ")",
+                         kind);
+            }
+            return;
+        }
+
+        auto fun = getFunTable().find(inst->fName);
+        if (fun == getFunTable().end() || int(inst->fArgs.size()) != fun->second.fArity) return;
+
+        string args;
+        for (auto& it : inst->fArgs) {
+            string   value;
+            SIMDKind value_kind;
+            if (!genValue(it, value, value_kind, fun->second.fKind)) return;
+            args += ((args == "") ? "" : ", ") + value;
+        }
+        setValue(fun->second.fName + "(" + args + ")", fun->second.fKind);
+    }
+
+    /*
+     Generates the vector loop of a 'for (int i = 0; i < bound; i = i + 1)' loop,
+     computing the frames [0, FAUST_SIMD_FLOOR(bound)[. Returns false if the loop cannot be vectorized.
+     */
+    bool generate(ForLoopInst* inst)
+    {
+        // Loop shape
+        DeclareVarInst* init      = dynamic_cast<DeclareVarInst*>(inst->fInit);
+        BinopInst*      end       = dynamic_cast<BinopInst*>(inst->fEnd);
+        StoreVarInst*   increment = dynamic_cast<StoreVarInst*>(inst->fIncrement);
+        if (!init || !end || !increment || !init->fValue || end->fOpcode != kLT) return false;
+
+        Int32NumInst* start = dynamic_cast<Int32NumInst*>(init->fValue);
+        BinopInst*    step  = dynamic_cast<BinopInst*>(increment->fValue);
+        fIndex              = init->getName();
+        if (!start || start->fNum != 0 || !step || step->fOpcode != kAdd || !isIndex(end->fInst1) ||
+            !isIndex(step->fInst1) || increment->getName() != fIndex) {
+            return false;
+        }
+        Int32NumInst* one = dynamic_cast<Int32NumInst*>(step->fInst2);
+        if (!one || one->fNum != 1) return false;
+
+        // Loops with a constant (and usually small) number of iterations are kept scalar
+        if (dynamic_cast<Int32NumInst*>(end->fInst2)) return false;
+
+        fVariants.insert(fIndex);
+        if (!collectVariants(inst->fCode) || !isInvariant(end->fInst2)) return false;
+        fBound = scalar(end->fInst2);
+
+        inst->fCode->accept(this);
+        if (fError) return false;
+
+        // Written arrays can only be read at the same index
+        for (auto& it : fStores) {
+            if (it.second.size() > 1) return false;
+            for (auto& index : fLoads[it.first]) {
+                if (it.second.find(index) == it.second.end()) return false;
+            }
+        }
+
+        return true;
+    }
+
+    string getIndex() { return fIndex; }
+    string getBound() { return fBound; }
+
+    // Generated vector loop
+    string getCode(bool declare_index)
+    {
+        std::stringstream loop;
+        loop << "for (" << (declare_index ? "int " : "") << fIndex << " = 0; (" << fIndex << " < FAUST_SIMD_FLOOR("
+             << fBound << ")); " << fIndex << " = (" << fIndex << " + FAUST_SIMD_SIZE)) {";
+        loop << fCode.str();
+        tab(fTab, loop);
+        loop << "}";
+        tab(fTab, loop);
+        return loop.str();
+    }
+};
+
+#endif
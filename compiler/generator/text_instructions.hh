@@ -75,6 +75,9 @@ class TextInstVisitor : public InstVisitor {
 
     void Tab(int n) { fTab = n; }
 
+    std::ostream* getOutput() { return fOut; }
+    void          setOutput(std::ostream* out) { fOut = out; }
+
     virtual void visit(LabelInst* inst)
     {
         *fOut << inst->fLabel;
@@ -119,6 +119,10 @@ global::global() : TABBER(1), gLoopDetector(1024, 400), gStackOverflowDetector(M
     gDeepFirstSwitch   = false;
     gVecSize           = 32;
     gVectorLoopVariant = 0;
+    gExplicitSIMD      = false;
+    gRecLookAhead      = 0;
+    gControlRate       = 0;
+    gLUTAccuracy       = 0;
 
     gOpenMPSwitch    = false;
     gOpenMPLoop      = false;
@@ -211,6 +215,12 @@ global::global() : TABBER(1), gLoopDetector(1024, 400), gStackOverflowDetector(M
     gFastMathLibTable["sqrt"]      = "fast_sqrt";
     gFastMathLibTable["tan"]       = "fast_tan";
 
+    // Target ISA for the '-mt' option (FMA is available on all AVX2 and AVX-512 CPUs)
+    gTargetISATable["sse4.2"]  = make_pair("sse4.2", "FAUST_CPU_SUPPORTS(\"sse4.2\")");
+    gTargetISATable["avx"]     = make_pair("avx", "FAUST_CPU_SUPPORTS(\"avx\")");
+    gTargetISATable["avx2"]    = make_pair("avx2,fma", "FAUST_CPU_SUPPORTS(\"avx2\") && FAUST_CPU_SUPPORTS(\"fma\")");
+    gTargetISATable["avx512f"] = make_pair("avx512f,fma", "FAUST_CPU_SUPPORTS(\"avx512f\")");
+
     gLstDependenciesSwitch = true;  ///< mdoc listing management.
     gLstMdocTagsSwitch     = true;  ///< mdoc listing management.
     gLstDistributedSwitch  = true;  ///< mdoc listing management.
@@ -413,6 +423,7 @@ global::global() : TABBER(1), gLoopDetector(1024, 400), gStackOverflowDetector(M
     gDrawSVGSwitch    = false;
     gPrintXMLSwitch   = false;
     gPrintJSONSwitch  = false;
+    gPrintBinarySwitch = false;
     gPrintDocSwitch   = false;
     gBalancedSwitch   = 0;
     gArchFile         = "";
@@ -608,6 +619,9 @@ void global::printCompilationOptions(ostream& dst, bool backend)
 #endif
     }
     if (gInPlace) dst << "-inpl ";
+    if (gRecLookAhead > 0) dst << "-rla " << gRecLookAhead << " ";
+    if (gControlRate > 0) dst << "-cr " << gControlRate << " ";
+    if (gLUTAccuracy > 0) dst << "-lut " << gLUTAccuracy << " ";
     if (gSchedulerSwitch) {
         dst << "-sch"
             << " -vs " << gVecSize << ((gFunTaskSwitch) ? " -fun" : "") << ((gGroupTaskSwitch) ? " -g" : "")
@@ -616,8 +630,8 @@ void global::printCompilationOptions(ostream& dst, bool backend)
             << gGlobal->gMaxCopyDelay << ((gMemoryManager) ? " -mem" : "");
     } else if (gVectorSwitch) {
         dst << "-vec"
-            << " -lv " << gVectorLoopVariant << " -vs " << gVecSize << ((gFunTaskSwitch) ? " -fun" : "")
-            << ((gGroupTaskSwitch) ? " -g" : "") << ((gDeepFirstSwitch) ? " -dfs" : "")
+            << " -lv " << gVectorLoopVariant << " -vs " << gVecSize << ((gExplicitSIMD) ? " -simd" : "")
+            << ((gFunTaskSwitch) ? " -fun" : "") << ((gGroupTaskSwitch) ? " -g" : "") << ((gDeepFirstSwitch) ? " -dfs" : "")
             << ((gFloatSize == 2) ? " -double" : (gFloatSize == 3) ? " -quad" : "") << " -ftz " << gFTZMode << " -mcd "
             << gGlobal->gMaxCopyDelay << ((gMemoryManager) ? " -mem" : "");
     } else if (gOpenMPSwitch) {
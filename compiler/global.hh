@@ -117,10 +117,14 @@ struct global {
     int    gMaxCopyDelay;
     string gOutputFile;
 
-    bool gVectorSwitch;
-    bool gDeepFirstSwitch;
-    int  gVecSize;
-    int  gVectorLoopVariant;
+    bool   gVectorSwitch;
+    bool   gDeepFirstSwitch;
+    int    gVecSize;
+    int    gVectorLoopVariant;
+    bool   gExplicitSIMD;  // generate explicit SIMD code (using 'faust/dsp/simd-vector.h') for non-recursive vector loops
+    int    gRecLookAhead;  // look-ahead (in samples) used to parallelize first and second-order linear recursions (0 = off)
+    int    gControlRate;   // rate (in samples) used to compute expensive functions of smoothed controls (0 = off)
+    double gLUTAccuracy;   // maximum error of the interpolated tables replacing math functions (0 = off)
 
     bool gOpenMPSwitch;
     bool gOpenMPLoop;
@@ -168,6 +172,9 @@ struct global {
     string gFastMathLib;           // The fastmath code mapping file
 
     map<string, string> gFastMathLibTable;      // Mapping table for fastmath functions
+
+    vector<string> gMultiTargets;  // ISA specific versions of 'compute' with runtime CPU dispatch (most specific first)
+    map<string, pair<string, string> > gTargetISATable;  // ISA ==> 'target' function attribute and CPU features check
     map<string, bool>   gMathForeignFunctions;  // Map of math foreign functions
 
     dsp_factory_base* gDSPFactory;
@@ -508,6 +515,7 @@ struct global {
     bool   gDrawSVGSwitch;
     bool   gPrintXMLSwitch;
     bool   gPrintJSONSwitch;
+    bool   gPrintBinarySwitch;
     bool   gPrintDocSwitch;
     int    gBalancedSwitch;
     string gArchFile;
@@ -552,6 +560,9 @@ struct global {
         }
     }
 
+    string getTargetAttribute(const string& isa) { return gTargetISATable[isa].first; }
+    string getTargetCondition(const string& isa) { return gTargetISATable[isa].second; }
+
     bool hasVarType(const string& name) { return gVarTypeTable.find(name) != gVarTypeTable.end(); }
 
     Typed::VarType getVarType(const string& name) { return gVarTypeTable[name]->getType(); }
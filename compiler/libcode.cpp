@@ -27,6 +27,7 @@
 #include <limits.h>
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -263,6 +264,7 @@ static bool processCmdline(int argc, const char* argv[])
     int          err = 0;
     stringstream parse_error;
     bool         float_size = false;
+    vector<string> multi_targets;
 
     /*
     for (int i = 0; i < argc; i++) {
@@ -332,6 +334,10 @@ static bool processCmdline(int argc, const char* argv[])
             gGlobal->gPrintJSONSwitch = true;
             i += 1;
 
+        } else if (isCmd(argv[i], "-bdesc", "--binary-description")) {
+            gGlobal->gPrintBinarySwitch = true;
+            i += 1;
+
         } else if (isCmd(argv[i], "-tg", "--task-graph")) {
             gGlobal->gGraphSwitch = true;
             i += 1;
@@ -416,6 +422,38 @@ static bool processCmdline(int argc, const char* argv[])
             gGlobal->gVectorLoopVariant = std::atoi(argv[i + 1]);
             i += 2;
 
+        } else if (isCmd(argv[i], "-rla", "--rec-look-ahead") && (i + 1 < argc)) {
+            gGlobal->gRecLookAhead = std::atoi(argv[i + 1]);
+            i += 2;
+
+        } else if (isCmd(argv[i], "-cr", "--control-rate") && (i + 1 < argc)) {
+            gGlobal->gControlRate = std::atoi(argv[i + 1]);
+            i += 2;
+
+        } else if (isCmd(argv[i], "-lut", "--lookup-tables") && (i + 1 < argc)) {
+            gGlobal->gLUTAccuracy = std::atof(argv[i + 1]);
+            i += 2;
+
+        } else if (isCmd(argv[i], "-simd", "--explicit-simd")) {
+            gGlobal->gExplicitSIMD = true;
+            i += 1;
+
+        } else if (isCmd(argv[i], "-mt", "--multi-target") && (i + 1 < argc)) {
+            stringstream isa_list(argv[i + 1]);
+            string       isa;
+            while (std::getline(isa_list, isa, ',')) {
+                if (gGlobal->gTargetISATable.find(isa) == gGlobal->gTargetISATable.end()) {
+                    stringstream error;
+                    error << "ERROR : unknown target ISA [-mt " << argv[i + 1] << "] : " << isa
+                          << " (should be sse4.2, avx, avx2 or avx512f)" << endl;
+                    throw faustexception(error.str());
+                }
+                if (find(multi_targets.begin(), multi_targets.end(), isa) == multi_targets.end()) {
+                    multi_targets.push_back(isa);
+                }
+            }
+            i += 2;
+
         } else if (isCmd(argv[i], "-omp", "--openmp")) {
             gGlobal->gOpenMPSwitch = true;
             i += 1;
@@ -630,8 +668,16 @@ static bool processCmdline(int argc, const char* argv[])
         }
     }
 
+    // Dispatch from the most specific ISA
+    const char* isa_order[] = {"avx512f", "avx2", "avx", "sse4.2"};
+    for (auto& isa : isa_order) {
+        if (find(multi_targets.begin(), multi_targets.end(), isa) != multi_targets.end()) {
+            gGlobal->gMultiTargets.push_back(isa);
+        }
+    }
+
     // Adjust related options
-    if (gGlobal->gOpenMPSwitch || gGlobal->gSchedulerSwitch) gGlobal->gVectorSwitch = true;
+    if (gGlobal->gOpenMPSwitch || gGlobal->gSchedulerSwitch || gGlobal->gExplicitSIMD) gGlobal->gVectorSwitch = true;
 
     // Check options coherency
     if (gGlobal->gInPlace && gGlobal->gVectorSwitch) {
@@ -642,6 +688,10 @@ static bool processCmdline(int argc, const char* argv[])
         throw faustexception("ERROR : 'ocpp' backend can only be used in scalar mode\n");
     }
 
+    if (gGlobal->gOutputLang == "ocpp" && gGlobal->gPrintBinarySwitch) {
+        throw faustexception("ERROR : '-bdesc' option cannot be used with 'ocpp' backend\n");
+    }
+
     if (gGlobal->gOneSample && gGlobal->gOutputLang != "cpp" && gGlobal->gOutputLang != "c" &&
         startWith(gGlobal->gOutputLang, "soul") && gGlobal->gOutputLang != "fir") {
         throw faustexception("ERROR : '-os' option cannot only be used with 'cpp', 'c', 'fir' or 'soul' backends\n");
@@ -651,12 +701,60 @@ static bool processCmdline(int argc, const char* argv[])
         throw faustexception("ERROR : '-os' option cannot only be used in scalar mode\n");
     }
 
+    if (gGlobal->gExplicitSIMD) {
+        if (gGlobal->gOutputLang != "c" && gGlobal->gOutputLang != "cpp") {
+            throw faustexception("ERROR : '-simd' option can only be used with 'c' or 'cpp' backends\n");
+        }
+        if (gGlobal->gFloatSize != 1) {
+            throw faustexception("ERROR : '-simd' option can only be used with single precision samples\n");
+        }
+        if (gGlobal->gOpenMPSwitch || gGlobal->gSchedulerSwitch || gGlobal->gOpenCLSwitch || gGlobal->gCUDASwitch) {
+            throw faustexception("ERROR : '-simd' option cannot be used with '-omp', '-sch', '-ocl' or '-cuda'\n");
+        }
+    }
+
+    if (gGlobal->gMultiTargets.size() > 0) {
+        if (gGlobal->gOutputLang != "cpp") {
+            throw faustexception("ERROR : '-mt' option can only be used with 'cpp' backend\n");
+        }
+        if (gGlobal->gExplicitSIMD) {
+            throw faustexception("ERROR : '-mt' option cannot be used with '-simd' (SIMD code is compiled for one ISA)\n");
+        }
+        if (gGlobal->gOneSample || gGlobal->gOpenMPSwitch || gGlobal->gSchedulerSwitch || gGlobal->gFunTaskSwitch) {
+            throw faustexception("ERROR : '-mt' option cannot be used with '-os', '-omp', '-sch' or '-fun'\n");
+        }
+    }
+
     if (gGlobal->gVectorLoopVariant < 0 || gGlobal->gVectorLoopVariant > 1) {
         stringstream error;
         error << "ERROR : invalid loop variant [-lv = " << gGlobal->gVectorLoopVariant << "] should be 0 or 1" << endl;
         throw faustexception(error.str());
     }
 
+    if (gGlobal->gRecLookAhead != 0 &&
+        (gGlobal->gRecLookAhead < 2 || gGlobal->gRecLookAhead > 64 ||
+         (gGlobal->gRecLookAhead & (gGlobal->gRecLookAhead - 1)) != 0)) {
+        stringstream error;
+        error << "ERROR : invalid look-ahead [-rla = " << gGlobal->gRecLookAhead
+              << "] should be a power of 2 between 2 and 64" << endl;
+        throw faustexception(error.str());
+    }
+
+    if (gGlobal->gControlRate != 0 && (gGlobal->gControlRate < 2 || gGlobal->gControlRate > 4096 ||
+                                       (gGlobal->gControlRate & (gGlobal->gControlRate - 1)) != 0)) {
+        stringstream error;
+        error << "ERROR : invalid control rate [-cr = " << gGlobal->gControlRate
+              << "] should be a power of 2 between 2 and 4096" << endl;
+        throw faustexception(error.str());
+    }
+
+    if (gGlobal->gLUTAccuracy < 0 || gGlobal->gLUTAccuracy >= 1) {
+        stringstream error;
+        error << "ERROR : invalid lookup table accuracy [-lut = " << gGlobal->gLUTAccuracy
+              << "] should be between 0 and 1" << endl;
+        throw faustexception(error.str());
+    }
+
     if (gGlobal->gVecSize < 4) {
         stringstream error;
         error << "ERROR : invalid vector size [-vs = " << gGlobal->gVecSize << "] should be at least 4" << endl;
@@ -759,6 +857,7 @@ static void printHelp()
          << endl;
     cout << tab << "-xml                                    generate an XML description file." << endl;
     cout << tab << "-json                                   generate a JSON description file." << endl;
+    cout << tab << "-bdesc    --binary-description          generate a binary description file (.fbd), with the same content as the JSON one." << endl;
     cout << tab
          << "-O <dir>  --output-dir <dir>            specify the relative directory of the generated output code and "
             "of additional generated files (SVG, XML...)."
@@ -825,6 +924,26 @@ static void printHelp()
     cout << tab << "-vec       --vectorize                  generate easier to vectorize code." << endl;
     cout << tab << "-vs <n>    --vec-size <n>               size of the vector (default 32 samples)." << endl;
     cout << tab << "-lv <n>    --loop-variant <n>           [0:fastest (default), 1:simple]." << endl;
+    cout << tab
+         << "-rla <n>   --rec-look-ahead <n>         parallelize first and second-order linear recursions with a "
+            "look-ahead of <n> samples (power of 2)."
+         << endl;
+    cout << tab
+         << "-cr <n>    --control-rate <n>           compute expensive functions of smoothed controls every <n> samples "
+            "(power of 2) and interpolate them."
+         << endl;
+    cout << tab
+         << "-lut <e>   --lookup-tables <e>          replace sin, cos, exp, pow and tanh of bounded signals by "
+            "interpolated tables with a maximum error <e>."
+         << endl;
+    cout << tab
+         << "-simd      --explicit-simd              generate explicit SIMD code for non-recursive loops (c and cpp "
+            "backends, single precision), activates --vectorize option."
+         << endl;
+    cout << tab
+         << "-mt <l>    --multi-target <l>           generate 'compute' for each ISA in the comma separated list <l> "
+            "(among sse4.2, avx, avx2, avx512f) with a runtime CPU dispatch (cpp backend)."
+         << endl;
     cout << tab << "-omp       --openmp                     generate OpenMP pragmas, activates --vectorize option."
          << endl;
     cout << tab << "-pl        --par-loop                   generate parallel loops in --openmp mode." << endl;
@@ -0,0 +1,176 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#include "sigControlRate.hh"
+#include <iostream>
+#include <set>
+#include "global.hh"
+#include "ppsig.hh"
+#include "sigLinearRec.hh"
+#include "sigtyperules.hh"
+#include "signals.hh"
+#include "tlib.hh"
+#include "xtended.hh"
+
+// Math functions that are continuous on their domain, so that they can be decimated and interpolated
+// (tan has poles, and pow is discontinuous for negative bases with non integer exponents)
+static bool isContinuousFun(const string& name)
+{
+    static set<string> funs = {"abs", "acos", "asin", "atan", "atan2", "cos", "exp",
+                               "exp10", "log", "log10", "max", "min", "sin", "sqrt"};
+    return funs.find(name) != funs.end();
+}
+
+// Return the type of a signal, or nullptr if it has not been typed
+static Type getOptionalSigType(Tree sig)
+{
+    return (AudioType*)sig->getType();
+}
+
+// Delayed value of a single definition recursion, in the normalized form
+// expected after simplification (@0 for the current value)
+static Tree recDelay(Tree var, int d)
+{
+    return sigFixDelay(sigProj(0, ref(var)), sigInt(d));
+}
+
+static bool isBlockConstant(Tree sig)
+{
+    Type ty = getOptionalSigType(sig);
+    return ty && ty->variability() <= kBlock;
+}
+
+/**
+ * A smoother is a real recursion y = x + c*y' where x and c are
+ * block constant and c is known to be in [0,1[.
+ */
+bool SignalControlRate::isSmoother(Tree rec)
+{
+    auto it = fSmoother.find(rec);
+    if (it != fSmoother.end()) return it->second;
+
+    Tree x, c1, c2;
+    bool res = LinearRecursion(rec).decompose(x, c1, c2) && x && c1 && !c2 && isBlockConstant(x) &&
+               isBlockConstant(c1);
+    if (res) {
+        interval i = getOptionalSigType(c1)->getInterval();
+        res        = i.valid && i.lo >= 0 && i.hi < 1;
+    }
+
+    fSmoother[rec] = res;
+    return res;
+}
+
+int SignalControlRate::kind(Tree sig)
+{
+    auto it = fKind.find(sig);
+    if (it != fKind.end()) return it->second;
+    int k      = kindAux(sig);
+    fKind[sig] = k;
+    return k;
+}
+
+int SignalControlRate::kindAux(Tree sig)
+{
+    Type ty = getOptionalSigType(sig);
+    if (!ty) return kOther;
+    if (ty->variability() <= kBlock) return kControl;
+    if (ty->nature() != kReal) return kOther;
+
+    int  i, op;
+    Tree r, x, y;
+
+    if (isProj(sig, &i, r)) {
+        Tree var, le;
+        return (i == 0 && isRec(r, var, le) && !isNil(le) && isSmoother(r)) ? kSlow : kOther;
+
+    } else if (isSigFixDelay(sig, x, y) && isZero(y)) {
+        return kind(x);
+
+    } else if (isSigFloatCast(sig, x)) {
+        return kind(x);
+
+    } else if (isSigBinOp(sig, &op, x, y) && (op == kAdd || op == kSub || op == kMul || op == kDiv)) {
+        return (kind(x) == kOther || kind(y) == kOther) ? kOther : kSlow;
+
+    } else if (getUserData(sig)) {
+        xtended* xt = (xtended*)getUserData(sig);
+        if (!isContinuousFun(xt->name())) return kOther;
+        for (Tree b : sig->branches()) {
+            if (kind(b) == kOther) return kOther;
+        }
+        return kSlow;
+
+    } else {
+        return kOther;
+    }
+}
+
+/**
+ * Number of samples since the last update, between 0 and N-1 :
+ *      c = (c' + 1) & (N - 1)
+ *      phase = (c + N - 1) & (N - 1)
+ */
+Tree SignalControlRate::phase()
+{
+    if (!fPhase) {
+        Tree var = tree(unique("W"));
+        rec(var, list1(sigAND(sigAdd(recDelay(var, 1), sigInt(1)), sigInt(fRate - 1))));
+        fPhase = sigAND(sigAdd(recDelay(var, 0), sigInt(fRate - 1)), sigInt(fRate - 1));
+    }
+    return fPhase;
+}
+
+/**
+ * Compute sig every N samples and interpolate between the two last values :
+ *      cur = (phase == 0) ? sig : cur'
+ *      old = (phase == 0) ? (first sample ? cur : cur') : old'
+ *      out = old + (cur - old) * phase / N
+ */
+Tree SignalControlRate::interpolate(Tree sig)
+{
+    Tree update = sigEQ(phase(), sigInt(0));
+    Tree first  = sigSub(sigInt(1), sigFixDelay(sigInt(1), sigInt(1)));
+
+    Tree cvar = tree(unique("W"));
+    rec(cvar, list1(sigSelect2(update, recDelay(cvar, 1), sig)));
+    Tree cur = recDelay(cvar, 0);
+
+    Tree ovar = tree(unique("W"));
+    rec(ovar, list1(sigSelect2(update, recDelay(ovar, 1), sigSelect2(first, recDelay(cvar, 1), cur))));
+    Tree old = recDelay(ovar, 0);
+
+    Tree ramp = sigMul(sigFloatCast(phase()), sigReal(1.0 / fRate));
+    return sigAdd(old, sigMul(sigSub(cur, old), ramp));
+}
+
+Tree SignalControlRate::transformation(Tree sig)
+{
+    if (getUserData(sig) && kind(sig) == kSlow) {
+        if (gGlobal->gDetailsSwitch) {
+            cout << "Control rate (" << fRate << " samples) : " << ppsig(sig) << endl;
+        }
+        // arguments are slow, hence left untouched
+        return interpolate(sig);
+    } else {
+        return SignalIdentity::transformation(sig);
+    }
+}
@@ -0,0 +1,63 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __SIGCONTROLRATE__
+#define __SIGCONTROLRATE__
+
+#include <map>
+#include "sigIdentity.hh"
+
+//-------------------------SignalControlRate----------------------------
+// Compute 'slow' signals at a reduced rate. A slow signal is a continuous
+// function (arithmetic operations and math functions) of block constant
+// signals and smoothed controls, that is first-order recursions :
+//
+//      y = x + c*y'   (x, c block constant and 0 <= c < 1)
+//
+// Math functions of slow signals are computed once every N samples, and
+// linearly interpolated in between, the arithmetic being kept at audio
+// rate. The interpolated signals are delayed by N samples. Signals must
+// have been typed before.
+//----------------------------------------------------------------------
+
+class SignalControlRate : public SignalIdentity {
+    enum { kOther, kControl, kSlow };
+
+    int             fRate;      // computation rate in samples (a power of 2)
+    Tree            fPhase;     // shared phase in the sub-rate period
+    map<Tree, int>  fKind;      // memoized result of kind()
+    map<Tree, bool> fSmoother;  // memoized result of isSmoother()
+
+   public:
+    SignalControlRate(int rate) : fRate(rate), fPhase(nullptr) {}
+
+   protected:
+    virtual Tree transformation(Tree sig);
+
+   private:
+    int  kind(Tree sig);
+    int  kindAux(Tree sig);
+    bool isSmoother(Tree rec);
+    Tree phase();
+    Tree interpolate(Tree sig);
+};
+
+#endif
@@ -0,0 +1,192 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#include "sigLinearRec.hh"
+#include "signals.hh"
+#include "sigtyperules.hh"
+#include "tlib.hh"
+
+// Arithmetic on optional terms, a null term being the zero signal
+
+Tree addTerm(Tree x, Tree y)
+{
+    return (!x) ? y : ((!y) ? x : sigAdd(x, y));
+}
+
+Tree subTerm(Tree x, Tree y)
+{
+    return (!y) ? x : ((!x) ? sigSub(sigReal(0.0), y) : sigSub(x, y));
+}
+
+Tree mulTerm(Tree x, Tree y)
+{
+    double r;
+    if (!x || !y) return nullptr;
+    if (isSigReal(x, &r) && r == 1.0) return y;
+    if (isSigReal(y, &r) && r == 1.0) return x;
+    return sigMul(x, y);
+}
+
+Tree divTerm(Tree x, Tree y)
+{
+    return (!x) ? nullptr : sigDiv(x, y);
+}
+
+/**
+ * Test if a signal depends on the analyzed recursive group,
+ * possibly through other recursive groups.
+ */
+bool LinearRecursion::dependsOnRec(Tree sig)
+{
+    if (fDepends.find(sig) == fDepends.end()) {
+        set<Tree> visited;
+        fDepends[sig] = dependsOnRecAux(sig, visited);
+    }
+    return fDepends[sig];
+}
+
+// A 'false' result may be partial when a cycle is cut, so only the 'true' ones are memoized here
+bool LinearRecursion::dependsOnRecAux(Tree sig, set<Tree>& visited)
+{
+    if (sig == fRec) return true;
+    if (visited.find(sig) != visited.end()) return false;
+    auto it = fDepends.find(sig);
+    if (it != fDepends.end() && it->second) return true;
+    visited.insert(sig);
+
+    Tree var, le;
+    if (isRec(sig, var, le)) {
+        if (dependsOnRecAux(le, visited)) {
+            fDepends[sig] = true;
+            return true;
+        }
+    } else {
+        for (Tree b : sig->branches()) {
+            if (dependsOnRecAux(b, visited)) {
+                fDepends[sig] = true;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Test if a signal is a delayed projection of the analyzed recursive group.
+ */
+bool LinearRecursion::isRecDelay(Tree sig, int& delay)
+{
+    int  i, d;
+    Tree x, y, r;
+    if (isProj(sig, &i, r)) {
+        delay = 0;
+        return (r == fRec) && (i == 0);
+    } else if (isSigDelay1(sig, x)) {
+        if (!isRecDelay(x, delay)) return false;
+        delay += 1;
+        return true;
+    } else if (isSigFixDelay(sig, x, y) && isSigInt(y, &d)) {
+        if (!isRecDelay(x, delay)) return false;
+        delay += d;
+        return true;
+    } else {
+        return false;
+    }
+}
+
+bool LinearRecursion::isBlockConstant(Tree sig)
+{
+    ::Type ty = getCertifiedSigType(sig);
+    return (ty->variability() <= kBlock) && (ty->nature() == kReal);
+}
+
+/**
+ * Decompose a signal as x + c1*y' + c2*y'' where y is the analyzed recursive
+ * group, x does not depend on y, and c1, c2 are block constant (null terms are zero).
+ * @return false if the signal is not linear in y' and y''
+ */
+bool LinearRecursion::linearize(Tree sig, Tree& x, Tree& c1, Tree& c2)
+{
+    int  op, delay;
+    Tree t1, t2;
+
+    x = c1 = c2 = nullptr;
+
+    if (!dependsOnRec(sig)) {
+        x = sig;
+        return true;
+
+    } else if (isRecDelay(sig, delay)) {
+        if (delay == 1) {
+            c1 = sigReal(1.0);
+        } else if (delay == 2) {
+            c2 = sigReal(1.0);
+        } else {
+            return false;
+        }
+        return true;
+
+    } else if (isSigBinOp(sig, &op, t1, t2)) {
+        Tree x1, a1, b1, x2, a2, b2;
+        if (op == kAdd || op == kSub) {
+            if (!linearize(t1, x1, a1, b1) || !linearize(t2, x2, a2, b2)) return false;
+            if (op == kAdd) {
+                x  = addTerm(x1, x2);
+                c1 = addTerm(a1, a2);
+                c2 = addTerm(b1, b2);
+            } else {
+                x  = subTerm(x1, x2);
+                c1 = subTerm(a1, a2);
+                c2 = subTerm(b1, b2);
+            }
+            return true;
+        } else if (op == kMul) {
+            if (dependsOnRec(t1)) std::swap(t1, t2);
+            if (dependsOnRec(t1) || !isBlockConstant(t1)) return false;
+            if (!linearize(t2, x2, a2, b2)) return false;
+            Tree k = t1;
+            x      = mulTerm(k, x2);
+            c1     = mulTerm(k, a2);
+            c2     = mulTerm(k, b2);
+            return true;
+        } else if (op == kDiv) {
+            if (dependsOnRec(t2) || !isBlockConstant(t2)) return false;
+            if (!linearize(t1, x1, a1, b1)) return false;
+            Tree k = t2;
+            x      = divTerm(x1, k);
+            c1     = divTerm(a1, k);
+            c2     = divTerm(b1, k);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool LinearRecursion::decompose(Tree& x, Tree& c1, Tree& c2)
+{
+    Tree var, le;
+    if (isRec(fRec, var, le) && !isNil(le) && isNil(tl(le)) && getCertifiedSigType(hd(le))->nature() == kReal) {
+        return linearize(hd(le), x, c1, c2) && (c1 || c2);
+    } else {
+        return false;
+    }
+}
@@ -0,0 +1,64 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __SIGLINEARREC__
+#define __SIGLINEARREC__
+
+#include <map>
+#include <set>
+#include "tree.hh"
+
+//-------------------------LinearRecursion------------------------------
+// Analyze a real valued recursive group with a single definition, and
+// decompose it (when possible) as :
+//
+//      y = x + c1*y' + c2*y''
+//
+// where x does not depend on y, and c1, c2 are block constant. Signals
+// must have been typed before. Null terms stand for the zero signal.
+//----------------------------------------------------------------------
+
+class LinearRecursion {
+    Tree            fRec;      // the analyzed recursive group
+    map<Tree, bool> fDepends;  // memoized result of dependsOnRec()
+
+    bool dependsOnRecAux(Tree sig, set<Tree>& visited);
+    bool isRecDelay(Tree sig, int& delay);
+    bool isBlockConstant(Tree sig);
+    bool linearize(Tree sig, Tree& x, Tree& c1, Tree& c2);
+
+   public:
+    LinearRecursion(Tree rec) : fRec(rec) {}
+
+    // Return false if the recursive group is not linear in y' and y''
+    bool decompose(Tree& x, Tree& c1, Tree& c2);
+
+    // Test if a signal depends on the recursive group, possibly through other recursive groups
+    bool dependsOnRec(Tree sig);
+};
+
+// Arithmetic on optional terms, a null term being the zero signal
+Tree addTerm(Tree x, Tree y);
+Tree subTerm(Tree x, Tree y);
+Tree mulTerm(Tree x, Tree y);
+Tree divTerm(Tree x, Tree y);
+
+#endif
@@ -0,0 +1,142 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#include "sigLookupTable.hh"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "global.hh"
+#include "ppsig.hh"
+#include "prim2.hh"
+#include "signals.hh"
+#include "sigtyperules.hh"
+#include "tlib.hh"
+#include "xtended.hh"
+
+#define LUT_MAX_SIZE 65536  // bigger tables are not worth it (cache misses)
+#define LUT_CYCLES 12       // estimated cost of an interpolated table read
+
+// Sample rate signal with a known (finite) interval
+static bool isBounded(Tree x, interval& i)
+{
+    Type ty = getCertifiedSigType(x);
+    i       = ty->getInterval();
+    return ty->variability() == kSamp && i.valid && i.lo < i.hi && std::isfinite(i.lo) && std::isfinite(i.hi);
+}
+
+// Foreign tanh function (tanhf, tanh or tanhl depending of the precision)
+static bool isTanh(Tree ff)
+{
+    return string(ffname(ff)).compare(0, 4, "tanh") == 0;
+}
+
+// Rebuild the function call 'sig' with a new argument at position 'arg'
+static Tree applyFun(Tree sig, int arg, Tree x)
+{
+    Tree ff, largs;
+    if (isSigFFun(sig, ff, largs)) {
+        return sigFFun(ff, list1(x));
+    } else {
+        vector<Tree> args = sig->branches();
+        args[arg]         = x;
+        return tree(sig->node(), args);
+    }
+}
+
+/**
+ * Replace the function call 'sig' of argument 'x' (at position 'arg') in [lo,hi] by an interpolated
+ * table. d2max bounds |f''| on [lo,hi] and cycles is the estimated cost of the function.
+ */
+Tree SignalLookupTable::lookup(Tree sig, int arg, Tree x, double lo, double hi, double d2max, int cycles)
+{
+    if (!std::isfinite(lo) || !std::isfinite(hi) || !std::isfinite(d2max)) return SignalIdentity::transformation(sig);
+    // Checked as a double, since the size may not fit in an int for large ranges
+    double points = std::ceil((hi - lo) * std::sqrt(d2max / (8 * fAccuracy)));
+    if (!(points <= LUT_MAX_SIZE)) return SignalIdentity::transformation(sig);
+    int size  = std::max(int(points), 2);
+    double h  = (hi - lo) / size;
+    int bytes = (size + 1) * ((gGlobal->gFloatSize == 1) ? 4 : 8);
+
+    // Table content : fun(lo + k*h), k = 0..size
+    Tree var = tree(unique("W"));
+    rec(var, list1(sigAdd(sigFixDelay(sigProj(0, ref(var)), sigInt(1)), sigInt(1))));
+    Tree k   = sigSub(sigFixDelay(sigProj(0, ref(var)), sigInt(0)), sigInt(1));
+    Tree gen = sigAdd(sigReal(lo), sigMul(sigFloatCast(k), sigReal(h)));
+
+    // Interpolated read
+    Tree pos  = sigMul(sigSub(sigFloatCast(self(x)), sigReal(lo)), sigReal(1.0 / h));
+    Tree idx  = gGlobal->gMaxPrim->computeSigOutput({sigIntCast(pos), sigInt(0)});
+    idx       = gGlobal->gMinPrim->computeSigOutput({idx, sigInt(size - 1)});
+    Tree frac = sigSub(pos, sigFloatCast(idx));
+    Tree y0   = sigReadOnlyTable(sigInt(size + 1), applyFun(sig, arg, gen), idx);
+    Tree y1   = sigReadOnlyTable(sigInt(size + 1), applyFun(sig, arg, gen), sigAdd(idx, sigInt(1)));
+
+    fTables++;
+    fBytes += bytes;
+    fCycles += cycles - LUT_CYCLES;
+    if (gGlobal->gDetailsSwitch) {
+        cout << "Lookup table : " << size + 1 << " points on [" << lo << ", " << hi << "] (" << bytes
+             << " bytes) for " << ppsig(sig) << endl;
+    }
+    return sigAdd(y0, sigMul(sigSub(y1, y0), frac));
+}
+
+Tree SignalLookupTable::transformation(Tree sig)
+{
+    Tree ff, largs;
+    xtended* xt = (xtended*)getUserData(sig);
+
+    // Functions and bounds of their second derivative
+    if (xt && (xt == gGlobal->gSinPrim || xt == gGlobal->gCosPrim)) {
+        Tree     x = sig->branch(0);
+        interval i;
+        if (isBounded(x, i)) return lookup(sig, 0, x, i.lo, i.hi, 1.0, 40);
+
+    } else if (xt && xt == gGlobal->gExpPrim) {
+        Tree     x = sig->branch(0);
+        interval i;
+        if (isBounded(x, i)) return lookup(sig, 0, x, i.lo, i.hi, std::exp(i.hi), 30);
+
+    } else if (xt && xt == gGlobal->gPowPrim) {
+        // pow(b, x) with a constant base b > 0
+        Tree     x = sig->branch(1);
+        interval i;
+        double   b;
+        if (isBounded(x, i) && isNum(sig->branch(0)) && (b = tree2float(sig->branch(0))) > 0) {
+            double d2max = std::pow(std::log(b), 2) * std::max(std::pow(b, i.lo), std::pow(b, i.hi));
+            return lookup(sig, 1, x, i.lo, i.hi, d2max, 60);
+        }
+
+    } else if (isSigFFun(sig, ff, largs) && isTanh(ff) && len(largs) == 1) {
+        // |tanh''| <= 4/(3*sqrt(3))
+        Tree     x = hd(largs);
+        interval i;
+        if (isBounded(x, i)) return lookup(sig, 0, x, i.lo, i.hi, 0.77, 50);
+    }
+
+    return SignalIdentity::transformation(sig);
+}
+
+void SignalLookupTable::print(ostream& dst)
+{
+    dst << "Lookup tables : " << fTables << " table(s) using " << fBytes << " bytes, saving about " << fCycles
+        << " cycles per sample" << endl;
+}
@@ -0,0 +1,58 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __SIGLOOKUPTABLE__
+#define __SIGLOOKUPTABLE__
+
+#include <ostream>
+#include "sigIdentity.hh"
+
+//-------------------------SignalLookupTable----------------------------
+// Replace sin, cos, exp, pow (with a constant base) and tanh applied to
+// sample rate signals with a known bounded interval, by a linearly
+// interpolated table computed in classInit. The table size is chosen so
+// that the interpolation error stays below the requested accuracy :
+//
+//      |error| <= h^2/8 * max|f''|   (h = table step)
+//
+// Signals must have been typed before.
+//----------------------------------------------------------------------
+
+class SignalLookupTable : public SignalIdentity {
+    double fAccuracy;  // maximum absolute error
+    int    fTables;    // number of generated tables
+    int    fBytes;     // memory used by the tables
+    int    fCycles;    // estimated cycles saved per sample
+
+   public:
+    SignalLookupTable(double accuracy) : fAccuracy(accuracy), fTables(0), fBytes(0), fCycles(0) {}
+
+    // Print the memory used by the tables vs the estimated gain
+    void print(std::ostream& dst);
+
+   protected:
+    virtual Tree transformation(Tree sig);
+
+   private:
+    Tree lookup(Tree sig, int arg, Tree x, double lo, double hi, double d2max, int cycles);
+};
+
+#endif
@@ -0,0 +1,62 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#include "sigRecLookAhead.hh"
+#include "global.hh"
+#include "normalize.hh"
+#include "sigLinearRec.hh"
+#include "signals.hh"
+#include "tlib.hh"
+
+/**
+ * Build the look-ahead version of y = x + c1*y' + c2*y''. At each step
+ * y = w + c1*y@s + c2*y@2s is multiplied by 1 + c1*z^-s - c2*z^-2s, which gives :
+ *      w' = w + c1*w@s - c2*w@2s
+ *      y  = w' + (c1*c1 + 2*c2)*y@2s - (c2*c2)*y@4s
+ */
+Tree SignalRecLookAhead::lookAhead(Tree rec, Tree x, Tree c1, Tree c2)
+{
+    Tree w = x;
+    for (int s = 1; s < fLookAhead; s *= 2) {
+        Tree w1 = normalizeFixedDelayTerm(w, sigInt(s));
+        Tree w2 = normalizeFixedDelayTerm(w, sigInt(2 * s));
+        w       = subTerm(addTerm(w, mulTerm(c1, w1)), mulTerm(c2, w2));
+        Tree d1 = addTerm(mulTerm(c1, c1), mulTerm(sigReal(2.0), c2));
+        Tree d2 = subTerm(nullptr, mulTerm(c2, c2));
+        c1      = d1;
+        c2      = d2;
+    }
+    Tree y = sigProj(0, rec);
+    return addTerm(addTerm(w, mulTerm(c1, sigFixDelay(y, sigInt(fLookAhead)))),
+                   mulTerm(c2, sigFixDelay(y, sigInt(2 * fLookAhead))));
+}
+
+Tree SignalRecLookAhead::transformation(Tree sig)
+{
+    Tree var, le, x, c1, c2;
+
+    if (isRec(sig, var, le) && !isNil(le) && LinearRecursion(sig).decompose(x, c1, c2) && x) {
+        rec(var, gGlobal->nil);  // to avoid infinite recursions
+        return rec(var, cons(lookAhead(sig, self(x), selfTerm(c1), selfTerm(c2)), gGlobal->nil));
+    } else {
+        return SignalIdentity::transformation(sig);
+    }
+}
@@ -0,0 +1,57 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __SIGRECLOOKAHEAD__
+#define __SIGRECLOOKAHEAD__
+
+#include "sigIdentity.hh"
+
+//-------------------------SignalRecLookAhead---------------------------
+// Rewrite first and second-order linear recursions :
+//
+//      y = x + c1*y' + c2*y''   (c1, c2 block constant)
+//
+// using a scattered look-ahead of K = 2^m samples. The recursion is
+// multiplied m times by its 'mirrored' polynomial, giving :
+//
+//      w = N(x)   (non-recursive FIR part, computed in parallel)
+//      y = w + C1*y@K + C2*y@2K
+//
+// so that K consecutive samples no longer depend on each other. The
+// added poles have the same modulus as the original ones, therefore
+// the stability of the filter is preserved.
+//----------------------------------------------------------------------
+
+class SignalRecLookAhead : public SignalIdentity {
+    int fLookAhead;  // look-ahead in samples (a power of 2)
+
+   public:
+    SignalRecLookAhead(int look_ahead) : fLookAhead(look_ahead) {}
+
+   protected:
+    virtual Tree transformation(Tree sig);
+
+   private:
+    Tree selfTerm(Tree sig) { return (sig) ? self(sig) : nullptr; }
+    Tree lookAhead(Tree rec, Tree x, Tree c1, Tree c2);
+};
+
+#endif
@@ -0,0 +1,356 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+/*
+ Binary description round-trip test:
+
+ - a DSP object is described with BinaryUI, and the decoded description has to build the same UI as the DSP itself
+ - a JSON description with a memory layout is converted to a binary one, and both have to build the same UI
+   on a memory block, and to give the same DSP size, sample rate index, lists and compile options
+ - invalid descriptions have to be rejected
+ - for each <file>.dsp given on the command line, the <file>.dsp.json and <file>.dsp.fbd files generated
+   by 'faust -json -bdesc' have to describe the same UI
+
+ binaryui-test [<file>.dsp ...]
+*/
+
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "faust/dsp/dsp.h"
+#include "faust/gui/BinaryUIDecoder.h"
+#include "faust/gui/JSONUI.h"
+
+// Records the UI calls, zones being numbered in their order of appearance, and the global metadata
+struct TraceUI : public UI, public Meta {
+
+    std::stringstream fTrace;
+    std::vector<void*> fZones;
+    std::map<std::string, std::string> fMeta;
+
+    int zone(void* zone)
+    {
+        if (!zone) return -1;
+        std::vector<void*>::iterator it = std::find(fZones.begin(), fZones.end(), zone);
+        if (it != fZones.end()) return int(it - fZones.begin());
+        fZones.push_back(zone);
+        return int(fZones.size() - 1);
+    }
+
+    void add(const char* type, const char* label, FAUSTFLOAT* z, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+    {
+        fTrace << type << " " << label << " " << zone(z) << " " << init << " " << min << " " << max << " " << step << "\n";
+    }
+
+    virtual void openTabBox(const char* label) { fTrace << "tgroup " << label << "\n"; }
+    virtual void openHorizontalBox(const char* label) { fTrace << "hgroup " << label << "\n"; }
+    virtual void openVerticalBox(const char* label) { fTrace << "vgroup " << label << "\n"; }
+    virtual void closeBox() { fTrace << "close\n"; }
+
+    virtual void addButton(const char* label, FAUSTFLOAT* z) { add("button", label, z, 0, 0, 0, 0); }
+    virtual void addCheckButton(const char* label, FAUSTFLOAT* z) { add("checkbox", label, z, 0, 0, 0, 0); }
+    virtual void addVerticalSlider(const char* label, FAUSTFLOAT* z, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+    {
+        add("vslider", label, z, init, min, max, step);
+    }
+    virtual void addHorizontalSlider(const char* label, FAUSTFLOAT* z, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+    {
+        add("hslider", label, z, init, min, max, step);
+    }
+    virtual void addNumEntry(const char* label, FAUSTFLOAT* z, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+    {
+        add("nentry", label, z, init, min, max, step);
+    }
+    virtual void addHorizontalBargraph(const char* label, FAUSTFLOAT* z, FAUSTFLOAT min, FAUSTFLOAT max) { add("hbargraph", label, z, 0, min, max, 0); }
+    virtual void addVerticalBargraph(const char* label, FAUSTFLOAT* z, FAUSTFLOAT min, FAUSTFLOAT max) { add("vbargraph", label, z, 0, min, max, 0); }
+    virtual void addSoundfile(const char* label, const char* url, Soundfile** sf_zone)
+    {
+        fTrace << "soundfile " << label << " " << url << " " << zone(sf_zone) << "\n";
+    }
+
+    virtual void declare(FAUSTFLOAT* z, const char* key, const char* val) { fTrace << "declare " << zone(z) << " " << key << " " << val << "\n"; }
+    virtual void declare(const char* key, const char* val) { fMeta[key] = val; }
+
+    std::string trace()
+    {
+        std::stringstream res;
+        res << fTrace.str();
+        for (std::map<std::string, std::string>::iterator it = fMeta.begin(); it != fMeta.end(); it++) {
+            res << "meta " << (*it).first << " " << (*it).second << "\n";
+        }
+        return res.str();
+    }
+
+};
+
+// A DSP with controls of all types, with metadata
+class ui_dsp : public dsp {
+
+    private:
+
+        FAUSTFLOAT fControls[8];
+        Soundfile* fSoundfile;
+
+    public:
+
+        ui_dsp():fSoundfile(0)
+        {
+            memset(fControls, 0, sizeof(fControls));
+        }
+
+        virtual int getNumInputs() { return 1; }
+        virtual int getNumOutputs() { return 2; }
+
+        virtual void buildUserInterface(UI* ui_interface)
+        {
+            ui_interface->openTabBox("ui");
+            ui_interface->declare(0, "tooltip", "oscillator");
+            ui_interface->openHorizontalBox("osc");
+            ui_interface->declare(&fControls[0], "unit", "Hz");
+            ui_interface->declare(&fControls[0], "scale", "log");
+            ui_interface->addVerticalSlider("freq", &fControls[0], FAUSTFLOAT(440), FAUSTFLOAT(20), FAUSTFLOAT(20000), FAUSTFLOAT(0.01));
+            ui_interface->addHorizontalSlider("gain", &fControls[1], FAUSTFLOAT(0.5), FAUSTFLOAT(0), FAUSTFLOAT(1), FAUSTFLOAT(0.001));
+            ui_interface->addNumEntry("voices", &fControls[2], FAUSTFLOAT(1), FAUSTFLOAT(1), FAUSTFLOAT(16), FAUSTFLOAT(1));
+            ui_interface->closeBox();
+            ui_interface->openVerticalBox("gates");
+            ui_interface->addButton("gate", &fControls[3]);
+            ui_interface->addCheckButton("mute", &fControls[4]);
+            ui_interface->closeBox();
+            ui_interface->openVerticalBox("meters");
+            ui_interface->declare(&fControls[5], "unit", "dB");
+            ui_interface->addHorizontalBargraph("level", &fControls[5], FAUSTFLOAT(-70), FAUSTFLOAT(6));
+            ui_interface->addVerticalBargraph("peak", &fControls[6], FAUSTFLOAT(0), FAUSTFLOAT(1));
+            ui_interface->closeBox();
+            ui_interface->addSoundfile("sample", "{'a.wav';'b.wav'}", &fSoundfile);
+            ui_interface->closeBox();
+        }
+
+        virtual int getSampleRate() { return 44100; }
+        virtual void init(int sample_rate) {}
+        virtual void instanceInit(int sample_rate) {}
+        virtual void instanceConstants(int sample_rate) {}
+        virtual void instanceResetUserInterface() {}
+        virtual void instanceClear() {}
+        virtual ui_dsp* clone() { return new ui_dsp(); }
+
+        virtual void metadata(Meta* m)
+        {
+            m->declare("name", "ui");
+            m->declare("author", "GRAME");
+            m->declare("version", "1.0");
+        }
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) {}
+
+};
+
+static int gFailures = 0;
+
+static void check(bool test, const std::string& name)
+{
+    std::cout << (test ? "OK   " : "FAIL ") << name << std::endl;
+    if (!test) gFailures++;
+}
+
+template <typename DECODER>
+static std::string trace(DECODER& decoder)
+{
+    TraceUI ui;
+    decoder.metadata(&ui);
+    decoder.buildUserInterface(&ui);
+    ui.fTrace << decoder.fNumInputs << " " << decoder.fNumOutputs << "\n";
+    return ui.trace();
+}
+
+template <typename DECODER>
+static std::string trace(DECODER& decoder, char* memory_block)
+{
+    TraceUI ui;
+    decoder.buildUserInterface(&ui, memory_block);
+    for (size_t i = 0; i < ui.fZones.size(); i++) {
+        ui.fTrace << "zone " << i << " " << (static_cast<char*>(ui.fZones[i]) - memory_block) << "\n";
+    }
+    return ui.trace();
+}
+
+static std::string readFile(const std::string& filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// The DSP UI and its binary description UI
+static void testDSP()
+{
+    ui_dsp dsp;
+    TraceUI dsp_ui;
+    dsp.metadata(&dsp_ui);
+    dsp.buildUserInterface(&dsp_ui);
+    dsp_ui.fTrace << dsp.getNumInputs() << " " << dsp.getNumOutputs() << "\n";
+
+    BinaryUI binary(dsp.getNumInputs(), dsp.getNumOutputs());
+    dsp.metadata(&binary);
+    dsp.buildUserInterface(&binary);
+    std::string description = binary.binary();
+    BinaryUIDecoder decoder(description);
+    check(trace(decoder) == dsp_ui.trace(), "DSP UI");
+    check(decoder.fDSPSize == -1 && decoder.fSRIndex == -1, "DSP unknown memory layout");
+    check(decoder.getName() == "ui", "DSP name");
+
+    // Controls are reset to their init values
+    TraceUI ui;
+    decoder.buildUserInterface(&ui);
+    *static_cast<FAUSTFLOAT*>(ui.fZones[0]) = FAUSTFLOAT(1000);
+    decoder.resetUserInterface();
+    check(*static_cast<FAUSTFLOAT*>(ui.fZones[0]) == FAUSTFLOAT(440), "DSP reset");
+
+    // Init may be called again
+    binary.init("", "", 1, 2, -1, "", "", "", "", std::vector<std::string>(), std::vector<std::string>(), "", std::map<std::string, int>());
+    dsp.metadata(&binary);
+    dsp.buildUserInterface(&binary);
+    check(binary.binary() == description, "DSP init");
+}
+
+// A JSON description with a memory layout, and its binary conversion
+static void testJSON()
+{
+    ui_dsp dsp;
+    std::map<std::string, int> path_table;
+    path_table["/ui/osc/freq"] = 16;
+    path_table["/ui/osc/gain"] = 20;
+    path_table["/ui/osc/voices"] = 24;
+    path_table["/ui/gates/gate"] = 28;
+    path_table["/ui/gates/mute"] = 32;
+    path_table["/ui/meters/level"] = 36;
+    path_table["/ui/meters/peak"] = 40;
+    path_table["/ui/sample"] = 48;
+    std::vector<std::string> library_list;
+    library_list.push_back("stdfaust.lib");
+    library_list.push_back("oscillators.lib");
+    std::vector<std::string> include_pathnames;
+    include_pathnames.push_back("/usr/local/share/faust");
+    JSONUI json_ui("ui", "ui.dsp", dsp.getNumInputs(), dsp.getNumOutputs(), 8, "", "", "2.20.2", "-lang cpp -double -ftz 0",
+                   library_list, include_pathnames, "56", path_table);
+    dsp.metadata(&json_ui);
+    dsp.buildUserInterface(&json_ui);
+    std::string json = json_ui.JSON();
+
+    std::string description = createBinaryDescription(json);
+    JSONUIDecoder json_decoder(json);
+    BinaryUIDecoder decoder(description);
+    check(trace(decoder) == trace(json_decoder), "JSON UI");
+
+    char memory_block1[64];
+    char memory_block2[64];
+    memset(memory_block1, 0, sizeof(memory_block1));
+    memset(memory_block2, 0, sizeof(memory_block2));
+    check(trace(decoder, memory_block1) == trace(json_decoder, memory_block2), "JSON UI on memory block");
+    check(memcmp(memory_block1, memory_block2, sizeof(memory_block1)) == 0, "JSON init values on memory block");
+
+    *reinterpret_cast<int*>(&memory_block1[8]) = 48000;
+    check(decoder.fDSPSize == 56 && decoder.getSampleRate(memory_block1) == 48000, "JSON memory layout");
+    check(decoder.getLibraryList() == library_list && decoder.getIncludePathnames() == include_pathnames, "JSON lists");
+    check(decoder.hasCompileOption("-double") && decoder.hasCompileOption("-ftz") && !decoder.hasCompileOption("-dou"), "JSON compile options");
+
+    Soundfile* defaultsound = reinterpret_cast<Soundfile*>(memory_block1);
+    memset(memory_block1, 0, sizeof(memory_block1));
+    decoder.resetUserInterface(memory_block1, defaultsound);
+    check(*reinterpret_cast<FAUSTFLOAT*>(&memory_block1[16]) == FAUSTFLOAT(440)
+          && *reinterpret_cast<Soundfile**>(&memory_block1[48]) == defaultsound, "JSON reset on memory block");
+
+    JSONUITemplatedDecoder* templated = createBinaryUIDecoder(description.data(), description.size());
+    check(dynamic_cast<BinaryUIDoubleDecoder*>(templated) != 0 && templated->getDSPSize() == 56, "JSON double decoder");
+    delete templated;
+}
+
+static bool rejected(const std::string& description)
+{
+    try {
+        BinaryUIDecoder decoder(description);
+        return false;
+    } catch (std::bad_alloc&) {
+        return true;
+    }
+}
+
+// Invalid descriptions are rejected
+static void testInvalid()
+{
+    ui_dsp dsp;
+    BinaryUI binary(dsp.getNumInputs(), dsp.getNumOutputs());
+    dsp.buildUserInterface(&binary);
+    std::string description = binary.binary();
+    BinaryUIFormat::Header header;
+    memcpy(&header, description.data(), sizeof(header));
+
+    check(rejected(description.substr(0, description.size() - 1)), "truncated description");
+    std::string bad = description;
+    bad[0] = 'X';
+    check(rejected(bad), "bad magic number");
+    bad = description;
+    reinterpret_cast<BinaryUIFormat::Item*>(&bad[header.fItems])->fLabel = header.fStringsSize;
+    check(rejected(bad), "bad string offset");
+    bad = description;
+    reinterpret_cast<BinaryUIFormat::Item*>(&bad[header.fItems])->fMetaSize = header.fMetasSize + 1;
+    check(rejected(bad), "bad metadata range");
+    bad = description;
+    bad[header.fStrings + header.fStringsSize - 1] = 'X';
+    check(rejected(bad), "unterminated strings table");
+}
+
+// JSON and binary descriptions generated by the compiler
+static void testCompiler(const std::string& filename)
+{
+    std::string json = readFile(filename + ".json");
+    std::string description = readFile(filename + ".fbd");
+    if (json == "" || description == "") {
+        check(false, filename + " descriptions (use 'faust -json -bdesc')");
+        return;
+    }
+    JSONUIDecoder json_decoder(json);
+    BinaryUIDecoder decoder(description);
+    check(trace(decoder) == trace(json_decoder), filename + " UI");
+    check(decoder.getCompileOptions() == json_decoder.fCompileOptions, filename + " compile options");
+}
+
+int main(int argc, char* argv[])
+{
+    testDSP();
+    testJSON();
+    testInvalid();
+    for (int i = 1; i < argc; i++) {
+        testCompiler(argv[i]);
+    }
+    std::cout << ((gFailures == 0) ? "All tests passed" : "Some tests failed") << std::endl;
+    return (gFailures == 0) ? 0 : 1;
+}
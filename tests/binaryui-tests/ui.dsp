@@ -0,0 +1,14 @@
+declare name "ui";
+declare author "GRAME";
+declare version "1.0";
+
+freq = vslider("h:Oscillator/[1]freq [unit:Hz] [scale:log]", 440, 20, 20000, 0.01);
+gain = hslider("h:Oscillator/[2]gain", 0.5, 0, 1, 0.001);
+voices = nentry("v:Settings/voices [style:menu{'one':1;'two':2}]", 1, 1, 2, 1);
+gate = button("v:Settings/t:Modes/gate");
+mute = checkbox("v:Settings/t:Modes/mute");
+meter = hbargraph("v:Meters/level [unit:dB]", -70, 6);
+peak = vbargraph("v:Meters/peak", 0, 1);
+sample = 0, 0 : soundfile("sample [url:{'a.wav';'b.wav'}]", 1) : !, !, _;
+
+process = _ * (freq * gain * voices * (gate + mute) * sample) <: meter, peak;
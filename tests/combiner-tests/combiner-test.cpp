@@ -0,0 +1,361 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+/*
+ DSP combiners test (see architecture/faust/dsp/dsp-combiner.h):
+
+ - trees of sequencers, parallelizers, splitters and mergers of small stateful DSP are computed on blocks
+   larger than their buffer size (so by chunks), and their outputs have to be the ones of the same
+   signal graph computed without combiners, each DSP processing the whole block at once
+ - recursive trees computed by chunks have to give the same outputs as with a single chunk
+ - the DSP of a tree never get outputs shared with their inputs, and a chain of sequencers only
+   allocates two sets of intermediate channels
+ - combiners written before the chunked computation (only implementing 'compute') still work in a tree
+
+ combiner-test
+*/
+
+#include <math.h>
+#include <string.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "faust/dsp/dsp-combiner.h"
+
+typedef std::vector<std::vector<FAUSTFLOAT> > signals;
+
+static bool gAliased = false;
+
+// A small stateful DSP: each output is a one pole filter of a weighted sum of the inputs
+class test_dsp : public dsp {
+
+    private:
+
+        int fInputs;
+        int fOutputs;
+        int fSeed;
+        int fSampleRate;
+        std::vector<double> fState;
+
+    public:
+
+        test_dsp(int inputs, int outputs, int seed)
+        :fInputs(inputs), fOutputs(outputs), fSeed(seed), fSampleRate(0), fState(outputs, 0.)
+        {}
+
+        virtual int getNumInputs() { return fInputs; }
+        virtual int getNumOutputs() { return fOutputs; }
+        virtual void buildUserInterface(UI* ui_interface) {}
+        virtual int getSampleRate() { return fSampleRate; }
+        virtual void init(int sample_rate) { instanceInit(sample_rate); }
+        virtual void instanceInit(int sample_rate)
+        {
+            instanceConstants(sample_rate);
+            instanceResetUserInterface();
+            instanceClear();
+        }
+        virtual void instanceConstants(int sample_rate) { fSampleRate = sample_rate; }
+        virtual void instanceResetUserInterface() {}
+        virtual void instanceClear() { std::fill(fState.begin(), fState.end(), 0.); }
+        virtual test_dsp* clone() { return new test_dsp(fInputs, fOutputs, fSeed); }
+        virtual void metadata(Meta* m) {}
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            for (int out = 0; out < fOutputs; out++) {
+                for (int in = 0; in < fInputs; in++) {
+                    gAliased |= (outputs[out] == inputs[in]);
+                }
+            }
+            for (int frame = 0; frame < count; frame++) {
+                for (int out = 0; out < fOutputs; out++) {
+                    double sum = (fInputs == 0) ? sin(0.01 * (fSeed + out + 1) * fState.size() + frame) : 0.;
+                    for (int in = 0; in < fInputs; in++) {
+                        sum += inputs[in][frame] * (1 + ((fSeed + in + out) % 5)) * 0.1;
+                    }
+                    fState[out] = sum + fState[out] * (0.5 + 0.05 * (fSeed % 9));
+                }
+                // Outputs are written once all inputs have been read, as generated code does
+                for (int out = 0; out < fOutputs; out++) {
+                    outputs[out][frame] = FAUSTFLOAT(fState[out]);
+                }
+            }
+        }
+
+        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            compute(count, inputs, outputs);
+        }
+
+};
+
+// A signal graph, built with combiners or computed directly
+
+struct graph {
+
+    char fOp;       // 'd' (DSP), ':' (sequence), ',' (parallel), '<' (split), '>' (merge), '~' (recursion)
+    graph* fG1;
+    graph* fG2;
+    int fInputs;
+    int fOutputs;
+    int fSeed;
+
+    graph(int inputs, int outputs, int seed)
+    :fOp('d'), fG1(0), fG2(0), fInputs(inputs), fOutputs(outputs), fSeed(seed)
+    {}
+
+    graph(char op, graph* g1, graph* g2):fOp(op), fG1(g1), fG2(g2), fSeed(0)
+    {
+        switch (op) {
+            case ',':
+                fInputs = g1->fInputs + g2->fInputs;
+                fOutputs = g1->fOutputs + g2->fOutputs;
+                break;
+            case '~':
+                fInputs = g1->fInputs - g2->fOutputs;
+                fOutputs = g1->fOutputs;
+                break;
+            default:
+                fInputs = g1->fInputs;
+                fOutputs = g2->fOutputs;
+                break;
+        }
+    }
+
+    ~graph()
+    {
+        delete fG1;
+        delete fG2;
+    }
+
+    dsp* build(int buffer_size)
+    {
+        switch (fOp) {
+            case ':': return new dsp_sequencer(fG1->build(buffer_size), fG2->build(buffer_size), buffer_size);
+            case ',': return new dsp_parallelizer(fG1->build(buffer_size), fG2->build(buffer_size), buffer_size);
+            case '<': return new dsp_splitter(fG1->build(buffer_size), fG2->build(buffer_size), buffer_size);
+            case '>': return new dsp_merger(fG1->build(buffer_size), fG2->build(buffer_size), buffer_size);
+            case '~': return new dsp_recursiver(fG1->build(buffer_size), fG2->build(buffer_size), buffer_size);
+            default: return new test_dsp(fInputs, fOutputs, fSeed);
+        }
+    }
+
+    // Computes the whole block at once, without combiners (recursions are not supported)
+    signals eval(const signals& inputs, int count)
+    {
+        signals outputs(fOutputs, std::vector<FAUSTFLOAT>(count, FAUSTFLOAT(0)));
+        switch (fOp) {
+            case ':':
+                outputs = fG2->eval(fG1->eval(inputs, count), count);
+                break;
+            case ',': {
+                signals inputs1(inputs.begin(), inputs.begin() + fG1->fInputs);
+                signals inputs2(inputs.begin() + fG1->fInputs, inputs.end());
+                signals outputs1 = fG1->eval(inputs1, count);
+                signals outputs2 = fG2->eval(inputs2, count);
+                outputs = outputs1;
+                outputs.insert(outputs.end(), outputs2.begin(), outputs2.end());
+                break;
+            }
+            case '<': {
+                signals outputs1 = fG1->eval(inputs, count);
+                signals inputs2;
+                for (int chan = 0; chan < fG2->fInputs; chan++) {
+                    inputs2.push_back(outputs1[chan % fG1->fOutputs]);
+                }
+                outputs = fG2->eval(inputs2, count);
+                break;
+            }
+            case '>': {
+                signals outputs1 = fG1->eval(inputs, count);
+                signals inputs2(fG2->fInputs, std::vector<FAUSTFLOAT>(count, FAUSTFLOAT(0)));
+                for (int chan = 0; chan < fG1->fOutputs; chan++) {
+                    for (int frame = 0; frame < count; frame++) {
+                        inputs2[chan % fG2->fInputs][frame] += outputs1[chan][frame];
+                    }
+                }
+                outputs = fG2->eval(inputs2, count);
+                break;
+            }
+            default: {
+                test_dsp dsp(fInputs, fOutputs, fSeed);
+                std::vector<FAUSTFLOAT*> in, out;
+                for (int chan = 0; chan < fInputs; chan++) in.push_back(const_cast<FAUSTFLOAT*>(inputs[chan].data()));
+                for (int chan = 0; chan < fOutputs; chan++) out.push_back(outputs[chan].data());
+                dsp.init(44100);
+                dsp.compute(count, in.data(), out.data());
+                break;
+            }
+        }
+        return outputs;
+    }
+
+};
+
+// A combiner only implementing 'compute', with its own buffers, as written before 'computeBlock'
+class legacy_sequencer : public dsp_binary_combiner {
+
+    private:
+
+        std::vector<std::vector<FAUSTFLOAT> > fChannels;
+        std::vector<FAUSTFLOAT*> fLegacyBuffers;
+
+    public:
+
+        legacy_sequencer(dsp* dsp1, dsp* dsp2):dsp_binary_combiner(dsp1, dsp2)
+        {}
+
+        virtual int getNumInputs() { return fDSP1->getNumInputs(); }
+        virtual int getNumOutputs() { return fDSP2->getNumOutputs(); }
+        virtual void buildUserInterface(UI* ui_interface) {}
+        virtual dsp* clone() { return new legacy_sequencer(fDSP1->clone(), fDSP2->clone()); }
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            fChannels.assign(fDSP1->getNumOutputs(), std::vector<FAUSTFLOAT>(count));
+            fLegacyBuffers.clear();
+            for (size_t chan = 0; chan < fChannels.size(); chan++) fLegacyBuffers.push_back(fChannels[chan].data());
+            fDSP1->compute(count, inputs, fLegacyBuffers.data());
+            fDSP2->compute(count, fLegacyBuffers.data(), outputs);
+        }
+
+};
+
+static graph* D(int inputs, int outputs)
+{
+    static int seed = 0;
+    return new graph(inputs, outputs, ++seed);
+}
+
+static graph* S(graph* g1, graph* g2) { return new graph(':', g1, g2); }
+static graph* P(graph* g1, graph* g2) { return new graph(',', g1, g2); }
+static graph* SP(graph* g1, graph* g2) { return new graph('<', g1, g2); }
+static graph* M(graph* g1, graph* g2) { return new graph('>', g1, g2); }
+static graph* R(graph* g1, graph* g2) { return new graph('~', g1, g2); }
+
+static signals makeInputs(int channels, int count)
+{
+    signals inputs(channels, std::vector<FAUSTFLOAT>(count));
+    for (int chan = 0; chan < channels; chan++) {
+        for (int frame = 0; frame < count; frame++) {
+            inputs[chan][frame] = FAUSTFLOAT(sin(0.05 * (chan + 1) * frame));
+        }
+    }
+    return inputs;
+}
+
+// Computes 'count' frames with the combiners, in a single 'compute' call
+static signals compute(dsp* dsp, const signals& inputs, int count, int& allocated)
+{
+    signals outputs(dsp->getNumOutputs(), std::vector<FAUSTFLOAT>(count, FAUSTFLOAT(0)));
+    std::vector<FAUSTFLOAT*> in, out;
+    for (size_t chan = 0; chan < inputs.size(); chan++) in.push_back(const_cast<FAUSTFLOAT*>(inputs[chan].data()));
+    for (size_t chan = 0; chan < outputs.size(); chan++) out.push_back(outputs[chan].data());
+    dsp->init(44100);
+    dsp->compute(count, in.data(), out.data());
+    dsp_binary_combiner* combiner = dynamic_cast<dsp_binary_combiner*>(dsp);
+    allocated = (combiner) ? combiner->getAllocatedChannels() : 0;
+    return outputs;
+}
+
+static bool same(const signals& s1, const signals& s2)
+{
+    if (s1.size() != s2.size()) return false;
+    for (size_t chan = 0; chan < s1.size(); chan++) {
+        for (size_t frame = 0; frame < s1[chan].size(); frame++) {
+            if (fabs(s1[chan][frame] - s2[chan][frame]) > 1e-5 * (1 + fabs(s2[chan][frame]))) return false;
+        }
+    }
+    return true;
+}
+
+static int gErrors = 0;
+
+static void check(const std::string& name, bool ok)
+{
+    std::cout << ((ok) ? "OK: " : "ERROR: ") << name << std::endl;
+    gErrors += !ok;
+}
+
+#define COUNT 1000
+
+// Chunked outputs compared with the ones computed directly (or with a single chunk, for recursions)
+static void test(const std::string& name, graph* g, int allocated_max = -1)
+{
+    signals inputs = makeInputs(g->fInputs, COUNT);
+    int allocated = 0;
+    dsp* reference_dsp = g->build(COUNT);
+    signals reference = (strchr(name.c_str(), '~')) ? compute(reference_dsp, inputs, COUNT, allocated) : g->eval(inputs, COUNT);
+    delete reference_dsp;
+
+    int buffer_sizes[] = { 1, 7, 64, COUNT };
+    for (int i = 0; i < 4; i++) {
+        gAliased = false;
+        dsp* dsp = g->build(buffer_sizes[i]);
+        signals outputs = compute(dsp, inputs, COUNT, allocated);
+        delete dsp;
+        std::stringstream label;
+        label << name << " buffer_size " << buffer_sizes[i];
+        check(label.str(), same(outputs, reference) && !gAliased);
+    }
+    if (allocated_max >= 0) {
+        std::stringstream label;
+        label << name << " allocated channels " << allocated << " <= " << allocated_max;
+        check(label.str(), allocated <= allocated_max);
+    }
+    delete g;
+}
+
+int main(int argc, char* argv[])
+{
+    // Chains of sequencers only use two sets of channels, whatever their nesting
+    test("d:d:d:d:d (right nested)", S(D(2, 2), S(D(2, 2), S(D(2, 2), S(D(2, 2), D(2, 2))))), 4);
+    test("d:d:d:d:d (left nested)", S(S(S(S(D(2, 2), D(2, 2)), D(2, 2)), D(2, 2)), D(2, 2)), 4);
+    test("d:d:d:d (balanced)", S(S(D(1, 3), D(3, 2)), S(D(2, 4), D(4, 1))), 6);
+
+    test("d,d", P(D(1, 2), D(2, 1)));
+    test("(d:d),(d:d:d)", P(S(D(1, 2), D(2, 1)), S(D(2, 3), S(D(3, 3), D(3, 2)))));
+    test("d<:d:d", SP(D(1, 2), S(D(4, 3), D(3, 1))));
+    test("d:>d:d", M(S(D(1, 6), D(6, 4)), S(D(2, 2), D(2, 1))));
+    test("d<:(d,d):>d", M(SP(D(2, 2), P(S(D(2, 2), D(2, 3)), D(2, 1))), D(2, 2)));
+    test("d:(d<:d):(d:>d)", S(D(1, 2), S(SP(D(2, 1), D(2, 2)), M(D(2, 4), D(2, 1)))));
+    test("d~d", R(D(2, 2), D(2, 1)));
+    test("(d:d)~(d:d)", S(D(1, 1), R(S(D(2, 3), D(3, 2)), S(D(2, 2), D(2, 1)))));
+
+    // A legacy combiner in a tree of chunked combiners
+    {
+        graph* g = S(D(1, 2), S(D(2, 2), S(D(2, 3), D(3, 1))));
+        signals inputs = makeInputs(1, COUNT);
+        signals reference = g->eval(inputs, COUNT);
+        int allocated = 0;
+        dsp* dsp = new dsp_sequencer(g->fG1->build(7), new legacy_sequencer(g->fG2->fG1->build(7), g->fG2->fG2->build(7)), 7);
+        check("d:legacy(d, d:d) buffer_size 7", same(compute(dsp, inputs, COUNT, allocated), reference));
+        delete dsp;
+        delete g;
+    }
+
+    return (gErrors == 0) ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+declare name 		"bulk";
+declare version 	"1.0";
+declare author 		"Grame";
+declare license 	"BSD";
+declare copyright 	"(c)GRAME 2019";
+
+
+gain 			= hslider("[1]gain", 0.25, 0, 1, 0.01);
+freq 			= hslider("[2]freq", 440, 20, 20000, 1);
+process 		= gain * freq; 
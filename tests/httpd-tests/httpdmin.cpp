@@ -0,0 +1,104 @@
+/************************************************************************
+
+	IMPORTANT NOTE : this file contains two clearly delimited sections :
+	the ARCHITECTURE section (in two parts) and the USER section. Each section
+	is governed by its own copyright and license. Please check individually
+	each section for license and copyright information.
+*************************************************************************/
+
+/*******************BEGIN ARCHITECTURE SECTION (part 1/2)****************/
+
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2019 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************
+ ************************************************************************/
+
+/*
+    A minimal application running the httpd UI without audio:
+    the controls are changed and read by the 'httpdtest' script using curl.
+*/
+
+#include <libgen.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+
+#include "faust/dsp/dsp.h"
+#include "faust/gui/meta.h"
+#include "faust/gui/httpdUI.h"
+#include "faust/misc.h"
+
+/**************************BEGIN USER SECTION **************************/
+
+/******************************************************************************
+*******************************************************************************
+
+							       VECTOR INTRINSICS
+
+*******************************************************************************
+*******************************************************************************/
+<<includeIntrinsic>>
+
+<<includeclass>>
+
+/***************************END USER SECTION ***************************/
+
+/*******************BEGIN ARCHITECTURE SECTION (part 2/2)***************/
+
+mydsp DSP;
+
+std::list<GUI*> GUI::fGuiList;
+ztimedmap GUI::gTimedZoneMap;
+
+static volatile bool gRunning = true;
+
+static void stop(int sig) { gRunning = false; }
+
+/******************************************************************************
+*******************************************************************************
+
+                                MAIN THREAD
+
+*******************************************************************************
+*******************************************************************************/
+int main(int argc, char *argv[])
+{
+	const char* name = basename(argv[0]);
+
+	DSP.init(44100);
+	httpdUI httpdinterface(name, DSP.getNumInputs(), DSP.getNumOutputs(), argc, argv);
+	DSP.buildUserInterface(&httpdinterface);
+	httpdinterface.run();
+
+	signal(SIGINT, stop);
+	signal(SIGTERM, stop);
+	while (gRunning) {
+		usleep(10000);
+	}
+
+	return 0;
+}
+
+/********************END ARCHITECTURE SECTION (part 2/2)****************/
+
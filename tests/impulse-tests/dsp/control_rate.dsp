@@ -0,0 +1,17 @@
+declare name 		"control_rate";
+declare version 	"1.0";
+declare author 		"Grame";
+declare license 	"BSD";
+declare copyright 	"(c)GRAME 2019";
+
+//-----------------------------------------------
+// 		Smoothed controls driving math functions
+//		(computed at control rate with the -cr option)
+//-----------------------------------------------
+
+smooth(c) = *(1-c) : + ~ *(c);
+
+level = hslider("level", 0.8, 0, 1, 0.01) : smooth(0.999);
+rate = hslider("rate", 0.3, 0, 1, 0.01) : smooth(0.99);
+
+process = sin(level * 3), exp(rate) * level, sqrt(level + rate);
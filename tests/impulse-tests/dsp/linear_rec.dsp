@@ -0,0 +1,12 @@
+// Test of first and second-order linear recursions (see the -rla option)
+
+pole   = hslider("pole", 0.99, 0, 0.999, 0.001);
+radius = hslider("radius", 0.995, 0, 0.999, 0.001);
+freq   = hslider("freq", 0.1, 0, 3.14, 0.01);
+
+onepole = *(1-pole) : + ~ *(pole);
+twopole = + ~ (_ <: *(2*radius*cos(freq)), (mem : *(0-radius*radius)) :> _);
+divpole = (+ : /(1+pole)) ~ *(pole);
+evenpole = + ~ (mem : *(0.5));
+
+process = _ <: onepole, 0.01*twopole, divpole, evenpole, (twopole : onepole);
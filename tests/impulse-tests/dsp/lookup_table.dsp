@@ -0,0 +1,16 @@
+declare name 		"lookup_table";
+declare version 	"1.0";
+declare author 		"Grame";
+declare license 	"BSD";
+declare copyright 	"(c)GRAME 2019";
+
+//-----------------------------------------------
+// 		Math functions of clipped signals
+//		(replaced by interpolated tables with the -lut option)
+//-----------------------------------------------
+
+wrap(y) = y - 2 * (y > 1);
+ramp = +(0.000731) ~ wrap;
+x = max(-1, min(1, ramp)) * 3;
+
+process = sin(x), cos(x * 0.5), exp(x * 0.5);